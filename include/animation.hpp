@@ -0,0 +1,67 @@
+/**
+ * @file        animation.hpp
+ *
+ * @brief       Keyframed zoom animations rendered without the interactive window.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fractal.hpp>
+#include <frame_sink.hpp>
+
+
+/**
+ * @brief       A keyframe of the animation. The view is centered in (CenterX, CenterY) and its
+ *              height is 2 * 10^LogScale. The width follows from the aspect ratio of the frames.
+ */
+struct Keyframe
+{
+    double Time;
+    double CenterX;
+    double CenterY;
+    double LogScale;
+    int NIters;
+    double Angle;
+};
+
+struct AnimationOptions
+{
+    std::string KeyframeFile;
+    long long NFrames       = 0;
+    std::string FramePrefix = "Frame";
+    int Width               = 0;
+    int Height              = 0;
+};
+
+
+/**
+ * @brief       Reads the keyframes from a text file.
+ *
+ * @details     Every non-empty line not starting with # holds a keyframe, given as
+ *              TIME CENTERX CENTERY LOGSCALE NITERS ANGLE. Times must be strictly increasing.
+ */
+bool load_keyframes(const std::string& Path, std::vector<Keyframe>& Keyframes);
+
+/**
+ * @brief       Interpolates the keyframes at the given time and returns the view for a
+ *              Width x Height frame. The center, the log-scale and the angle are interpolated
+ *              linearly, so the zoom proceeds at constant speed; the number of iterations is
+ *              rounded to the nearest integer.
+ */
+ParamsStruct interpolate_keyframes(const std::vector<Keyframe>& Keyframes, double Time,
+                                   const ParamsStruct& Base, int Width, int Height);
+
+/**
+ * @brief       Renders NFrames frames evenly spaced between the first and the last keyframe and
+ *              hands them to the sink. Frames are pipelined, so the rendering of a frame overlaps
+ *              with the readback and the encoding of the previous ones. Requires a current
+ *              OpenGL context.
+ */
+bool render_animation(FractalType Type, const ParamsStruct& Params, const AnimationOptions& Options,
+                      FrameSink& Sink);
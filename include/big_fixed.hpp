@@ -0,0 +1,115 @@
+/**
+ * @file        big_fixed.hpp
+ *
+ * @brief       Fixed-point numbers with any number of 64-bit limbs, for the reference orbits of
+ *              zooms deeper than any hardware precision.
+ *
+ * @details     A number with N limbs is a two's complement integer of 64 * N bits, scaled by
+ *              2^(-64 * (N - 1)): the most significant limb holds the integer part, the others the
+ *              fraction. The points of the fractals never grow past a few units, so there is no
+ *              exponent to track and additions are plain carry chains. Products are built from
+ *              64 x 64 -> 128 bit limb products (unsigned __int128, or the MSVC intrinsics). Up to
+ *              ShortProductThreshold limbs they skip the lower half, which is truncated anyway;
+ *              above, they are computed in full by Karatsuba's algorithm. Squares, which dominate
+ *              z^2 + c, have their own routines computing every cross product once.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+
+// Below this many limbs products are short: the lower half, which is truncated, is skipped.
+// From this many limbs on, they are computed in full by Karatsuba's algorithm, recursively down to
+// KaratsubaThreshold limbs
+const int ShortProductThreshold = 192;
+const int KaratsubaThreshold = 48;
+
+
+/**
+ * @brief       Buffers reused by the products, so that iterating does not allocate.
+ */
+struct BigWorkspace
+{
+    std::vector<uint64_t> A;
+    std::vector<uint64_t> B;
+    std::vector<uint64_t> Product;
+    std::vector<uint64_t> Scratch;
+};
+
+
+class BigFixed
+{
+public:
+    explicit BigFixed(int Limbs = 2);
+
+    int limbs() const { return (int)m_Limbs.size(); }
+    bool negative() const { return (int64_t)m_Limbs.back() < 0; }
+
+    void set(double Value);
+
+    /**
+     * @brief   Parses a decimal number, such as -1.7490812690237950000000000000000000000001, or
+     *          with an exponent, such as 3.5e-40, exactly up to the precision of the limbs.
+     *          The integer part must fit in 63 bits.
+     */
+    bool parse(const char* Str);
+
+    double to_double() const;
+
+    void negate();
+
+    /**
+     * @brief   The operations store their result in this number. The operands must have as many
+     *          limbs as this number, and can be this number itself.
+     */
+    void add(const BigFixed& a, const BigFixed& b);
+    void sub(const BigFixed& a, const BigFixed& b);
+    void mul(const BigFixed& a, const BigFixed& b, BigWorkspace& W);
+    void square(const BigFixed& a, BigWorkspace& W);
+
+private:
+    std::vector<uint64_t> m_Limbs;          // Least significant first
+};
+
+
+/**
+ * @brief       A complex number of BigFixed, with the step of the quadratic fractals.
+ */
+class BigComplex
+{
+public:
+    explicit BigComplex(int Limbs = 2);
+
+    /**
+     * @brief   z = z^2 + c, with three squares instead of three products: x^2, y^2 and
+     *          (x + y)^2, whose difference is 2xy.
+     */
+    void square_add(const BigComplex& c, BigWorkspace& W);
+
+    /**
+     * @brief   |z|^2, in double precision.
+     */
+    double norm() const;
+
+    BigFixed Re;
+    BigFixed Im;
+
+private:
+    BigFixed m_X2;
+    BigFixed m_Y2;
+    BigFixed m_S;
+};
+
+
+/**
+ * @brief       Limbs needed by the points of a view whose pixels are 10^Log10Scale apart: the
+ *              integer limb, the bits of the scale and 64 guard bits against the rounding of the
+ *              iterations.
+ */
+int big_fixed_limbs(double Log10Scale);
@@ -0,0 +1,126 @@
+/**
+ * @file        compute_renderer.hpp
+ *
+ * @brief       Renders a fractal into a texture of fixed size by means of the compute shaders.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <glad/glad.h>
+#include <fractal.hpp>
+#include <stdint.h>
+
+
+enum ComputeArithmetic
+{
+    COMPUTE_AUTO,       // The faster of the two on this device, measured once
+    COMPUTE_FP64,       // double
+    COMPUTE_INT64       // Q4.60 fixed point on GL_ARB_gpu_shader_int64, Mandelbrot's and Julia's sets
+};
+
+
+struct ComputeRenderer
+{
+    FractalType Type    = FractalType::INVALID;
+    GLuint Program      = 0;            // double kernel, 0 if the driver has no doubles but FixedProgram is set
+    GLuint FixedProgram = 0;            // Q4.60 kernel, used for the views within its range
+    GLuint ParamsBuf    = 0;
+    GLuint RootsBuf     = 0;
+    bool OwnsRootsBuf   = false;
+    NewtonStep Step     = NewtonStep::NEWTON_STEP_ROOTS;
+    GLuint Texture      = 0;
+    GLenum Format       = GL_RGBA32F;   // GL_R32UI for iteration fields
+    int Width           = 0;
+    int Height          = 0;
+    size_t Bytes        = 0;            // Accounted for in the memory tracker
+};
+
+
+const char* compute_arithmetic_name(ComputeArithmetic Arithmetic);
+
+/**
+ * @brief       Whether the driver supports the 64-bit integers of the fixed-point kernels.
+ */
+bool compute_int64_supported();
+
+/**
+ * @brief       Sets the arithmetic of the renderers created with COMPUTE_AUTO.
+ */
+void set_compute_arithmetic(ComputeArithmetic Arithmetic);
+
+/**
+ * @brief       The arithmetic of the renderers of Type created with COMPUTE_AUTO. Many GPUs run
+ *              doubles at a small fraction of the rate of floats, or emulate them, so unless set
+ *              otherwise, the first call renders a small Mandelbrot field with both kernels and
+ *              keeps the faster one. Newton's fractal, which needs divisions, always uses doubles.
+ */
+ComputeArithmetic compute_arithmetic(FractalType Type);
+
+/**
+ * @brief       Creates the buffer with the roots of z^n - 1 used by Newton's fractal, followed by
+ *              the NRoots + 1 coefficients of the polynomial, lowest degree first.
+ */
+GLuint create_roots_buffer(int NRoots);
+
+/**
+ * @brief       The form of Newton's step for the polynomial of create_roots_buffer.
+ */
+NewtonStep roots_buffer_step(int NRoots);
+
+/**
+ * @brief       Compiles the compute shader for the given fractal and allocates a Width x Height
+ *              GL_RGBA32F texture to render into.
+ *
+ * @param       RootsBuf    Buffer with the roots of the polynomial. If 0, the renderer creates its
+ *                          own buffer when Type is NEWTON.
+ * @param       Arithmetic  COMPUTE_INT64 fails if the driver does not support it. Either way, the
+ *                          views reaching past |x|, |y| < 7 are rendered in double, and skipped
+ *                          if the driver has no doubles.
+ */
+bool create_compute_renderer(ComputeRenderer& Renderer, FractalType Type, const ParamsStruct& Params,
+                             int Width, int Height, GLuint RootsBuf = 0,
+                             ComputeArithmetic Arithmetic = ComputeArithmetic::COMPUTE_AUTO);
+
+/**
+ * @brief       Like create_compute_renderer, but renders the raw iteration field into a GL_R32UI
+ *              texture: the escape iteration for Mandelbrot's and Julia's sets, 0 for points that
+ *              do not escape, and the index of the root reached for Newton's fractal.
+ */
+bool create_field_renderer(ComputeRenderer& Renderer, FractalType Type, const ParamsStruct& Params,
+                           int Width, int Height, GLuint RootsBuf = 0,
+                           ComputeArithmetic Arithmetic = ComputeArithmetic::COMPUTE_AUTO);
+
+// Flag of the iteration costs of the points that never escape or converge
+const uint32_t CostUnfinished = 0x80000000u;
+
+/**
+ * @brief       Like create_field_renderer, but stores the iterations executed for every point,
+ *              with CostUnfinished set for the points that never escape (Mandelbrot's and Julia's
+ *              sets) or do not converge to a root (Newton's fractal).
+ */
+bool create_cost_renderer(ComputeRenderer& Renderer, FractalType Type, const ParamsStruct& Params,
+                          int Width, int Height, GLuint RootsBuf = 0,
+                          ComputeArithmetic Arithmetic = ComputeArithmetic::COMPUTE_AUTO);
+
+/**
+ * @brief       Renders the view described by Params into the texture of the renderer.
+ */
+void compute_render(ComputeRenderer& Renderer, const ParamsStruct& Params);
+
+/**
+ * @brief       Reads the texture back as 8-bit RGB. Rows are tightly packed and stored bottom-up,
+ *              as in the texture. RGB must hold at least 3 * Width * Height bytes.
+ */
+void compute_readback_rgb(ComputeRenderer& Renderer, unsigned char* RGB);
+
+/**
+ * @brief       Reads back the iteration field of a renderer created by create_field_renderer.
+ *              Rows are stored bottom-up. Values must hold at least Width * Height values.
+ */
+void compute_readback_field(ComputeRenderer& Renderer, uint32_t* Values);
+
+void destroy_compute_renderer(ComputeRenderer& Renderer);
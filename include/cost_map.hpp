@@ -0,0 +1,52 @@
+/**
+ * @file        cost_map.hpp
+ *
+ * @brief       Records where the work of a view goes: the iterations executed by every pixel and
+ *              the GPU time of every tile.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <string>
+#include <fractal.hpp>
+
+
+enum CostMapFormat
+{
+    COST_NPY,       // OUTPUT.npy, a Height x Width array of uint32
+    COST_CSV        // OUTPUT.csv, one line x,y,iterations,unfinished per pixel
+};
+
+struct CostMapOptions
+{
+    std::string Output;
+    long long Width         = 0;
+    long long Height        = 0;
+    int TileSize            = 64;
+    CostMapFormat Format    = CostMapFormat::COST_NPY;
+};
+
+
+/**
+ * @brief       Renders the iterations executed by every pixel of a Width x Height image of the view
+ *              and writes them along with their heatmap and the time of every tile.
+ *
+ * @details     The image is rendered one TileSize x TileSize tile at a time, every dispatch timed
+ *              on the GPU with a pair of timestamp queries. Border tiles are rendered whole, so their
+ *              time includes the pixels outside the image. The outputs are:
+ *
+ *                  OUTPUT.png          The heatmap, on a logarithmic scale, with the pixels that
+ *                                      never escape or converge in black
+ *                  OUTPUT.npy/.csv     The iterations of every pixel, rows top-down
+ *                  OUTPUT_tiles.csv    Position, GPU time, iterations and unfinished pixels of
+ *                                      every tile
+ *
+ *              The mean and maximum iterations per pixel, the fraction of unfinished pixels and
+ *              the share of the time taken by the hottest tiles are printed at the end.
+ *              Requires a current OpenGL context.
+ */
+bool cost_map_export(FractalType Type, const ParamsStruct& Params, const CostMapOptions& Options);
@@ -0,0 +1,76 @@
+/**
+ * @file        cpu_renderer.hpp
+ *
+ * @brief       Renders fractals on the CPU, with the same results as the compute shaders.
+ *
+ * @details     The kernels iterate one cache line of pixels of a row at a time, with every lane
+ *              doing the same operations and finished lanes masked out, so that the compiler can
+ *              keep them in vector registers. Rows are handed out dynamically to a pool of threads,
+ *              since the cost of the rows of escape-time fractals varies wildly.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <fractal.hpp>
+#include <view_model.hpp>
+#include <perf_counters.hpp>
+#include <stdint.h>
+#include <vector>
+
+
+enum CPUPrecision
+{
+    CPU_FP32,
+    CPU_FP64,                       // As the compute shaders
+    CPU_DOUBLE_DOUBLE,              // About 106 bits, as a reference for the other precisions
+    CPU_QUAD_DOUBLE,                // About 212 bits, for views narrower than double-double resolves
+    CPU_AUTO                        // The cheapest of double and the above that resolves the view
+};
+
+struct CPURenderOptions
+{
+    int Threads             = 0;            // All the hardware threads if 0
+    bool Counters           = false;        // Collect the hardware counters of every phase and thread
+    CPUPrecision Precision  = CPUPrecision::CPU_AUTO;
+};
+
+
+const char* cpu_precision_name(CPUPrecision Precision);
+
+/**
+ * @brief       Chooses the cheapest precision, starting from double, that resolves the Width x
+ *              Height pixels of the view, as select_view_precision does for the shaders.
+ */
+CPUPrecision select_cpu_precision(const ViewModel& View, int Width, int Height);
+
+/**
+ * @brief       Renders the iteration field of the view, with the same values as the renderers
+ *              created by create_field_renderer. Rows are stored bottom-up. The coordinates of the
+ *              pixels are computed in double in every precision, as in the shaders, so that the
+ *              fields only differ by the precision of the iterations.
+ *
+ * @param       Phases      If not NULL, the timing and the counters of the rendering are appended.
+ */
+bool cpu_render_field(FractalType Type, const ParamsStruct& Params, int Width, int Height, uint32_t* Field,
+                      const CPURenderOptions& Options, std::vector<PerfPhase>* Phases = NULL);
+
+/**
+ * @brief       Like the above, for a view narrower than its limits in double can describe. The
+ *              pixels are placed as offsets from the double-double center of View, already fitted
+ *              to the image, so that the double-double and quad-double precisions resolve zooms
+ *              far past the limits of double. Params only gives the iterations and the parameters
+ *              of the fractal.
+ */
+bool cpu_render_field(FractalType Type, const ParamsStruct& Params, const ViewModel& View, int Width, int Height,
+                      uint32_t* Field, const CPURenderOptions& Options, std::vector<PerfPhase>* Phases = NULL);
+
+/**
+ * @brief       Colours an iteration field with the colormaps of the shaders, into tightly packed
+ *              8-bit RGB with rows bottom-up, as compute_readback_rgb.
+ */
+void cpu_colorize(FractalType Type, const ParamsStruct& Params, const uint32_t* Field, int Width, int Height,
+                  unsigned char* RGB, const CPURenderOptions& Options, std::vector<PerfPhase>* Phases = NULL);
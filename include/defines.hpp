@@ -0,0 +1,22 @@
+/**
+ * @file        defines.hpp
+ * 
+ * @brief       This file is configured via CMake and provides to the application all the macros' values.
+ * 
+ * @author      Filippo Maggioli\n 
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n 
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2021-10-18
+ */
+#pragma once
+
+#define TEX_SIZE                            4096
+#define SHADERS_DIR                         "/root/repo/_gate_build/shaders"
+#define NEWTON_COMPUTE_SHADER               SHADERS_DIR "/newton.compute"
+#define MANDELBROT_COMPUTE_SHADER           SHADERS_DIR "/mandelbrot.compute"
+#define JULIA_COMPUTE_SHADER                SHADERS_DIR "/julia.compute"
+#define NEWTON_FRAGMENT_SHADER              SHADERS_DIR "/newton.frag"
+#define MANDELBROT_FRAGMENT_SHADER          SHADERS_DIR "/mandelbrot.frag"
+#define JULIA_FRAGMENT_SHADER               SHADERS_DIR "/julia.frag"
+#define EXPMAP_RESAMPLE_SHADER              SHADERS_DIR "/expmap_resample.compute"
+#define HUD_FRAGMENT_SHADER                 SHADERS_DIR "/hud.frag"
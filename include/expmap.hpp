@@ -0,0 +1,42 @@
+/**
+ * @file        expmap.hpp
+ *
+ * @brief       Zoom videos rendered through the exponential map of the plane.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <fractal.hpp>
+#include <frame_sink.hpp>
+
+
+struct ExpMapOptions
+{
+    double CenterX      = 0.0;
+    double CenterY      = 0.0;
+    double LogScaleFrom = 0.0;      // log10 of the half height of the first frame
+    double LogScaleTo   = 0.0;      // log10 of the half height of the last frame
+    long long NFrames   = 0;
+    int Width           = 0;
+    int Height          = 0;
+};
+
+
+/**
+ * @brief       Renders a zoom into (CenterX, CenterY) by resampling a log-polar strip.
+ *
+ * @details     Columns of the strip sample the angle around the center and rows sample the
+ *              logarithm of the distance from it, with the same spacing, so that the whole zoom
+ *              range is rendered once at the resolution of the frames. Every frame is then a
+ *              resampling of the strip. The strip is rendered in chunks of rows, on demand, and
+ *              only the chunks spanned by the current frame are kept on the GPU. Frames whose
+ *              center would be undersampled by the innermost rows of the strip, i.e. those in the
+ *              last halving of the zoom, are rendered directly instead. Only Mandelbrot's and
+ *              Julia's sets are supported. Requires a current OpenGL context.
+ */
+bool render_expmap_zoom(FractalType Type, const ParamsStruct& Params, const ExpMapOptions& Options,
+                        FrameSink& Sink);
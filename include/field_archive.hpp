@@ -0,0 +1,106 @@
+/**
+ * @file        field_archive.hpp
+ *
+ * @brief       A tiled, compressed archive of raw iteration fields, with random access to the tiles.
+ *
+ * @details     The archive is made by a fixed-size header, the compressed tiles and an index of the
+ *              tiles in the footer:
+ *
+ *                  Header      128 bytes, see FieldArchiveHeader
+ *                  Tiles       One payload per tile, each one starting at a multiple of 8 bytes
+ *                  Index       For each tile, in row-major order: u64 offset, u64 size (0 if missing)
+ *                  Trailer     u64 offset of the index, u64 number of tiles, 8 bytes "ITERIDX1"
+ *
+ *              All the integers are little endian. Tiles are TileSize x TileSize values, cropped
+ *              at the right and bottom borders, with rows stored top-down. Every value is predicted
+ *              from its left, top and top-left neighbours with the median edge detector of
+ *              LOCO-I, and the residuals are zigzag-encoded as varints, with runs of zeros
+ *              collapsed into a single token. The resulting bytes are compressed with a canonical
+ *              Huffman code built for each tile, unless it does not pay off. A tile can thus be
+ *              decoded by looking only at the trailer, its index entry and its payload.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <fractal.hpp>
+
+
+struct FieldArchiveHeader
+{
+    uint32_t TileSize   = 256;
+    uint64_t Width      = 0;
+    uint64_t Height     = 0;
+    int32_t Type        = FractalType::INVALID;
+    ParamsStruct Params;
+};
+
+
+struct FieldArchiveWriter
+{
+    FILE* Handle = NULL;
+    std::string Path;
+    FieldArchiveHeader Header;
+    uint64_t NTilesX = 0;
+    uint64_t NTilesY = 0;
+    uint64_t Offset = 0;
+    std::vector<uint64_t> Index;             // Offset and size of every tile
+    std::vector<unsigned char> Tokens;
+    std::vector<unsigned char> Payload;
+    uint64_t RawBytes = 0;                   // Size of the tiles written so far, uncompressed
+};
+
+
+/**
+ * @brief       A read-only archive, mapped in memory.
+ */
+struct FieldArchiveReader
+{
+    const unsigned char* Data = NULL;
+    uint64_t Size = 0;
+    FieldArchiveHeader Header;
+    uint64_t NTilesX = 0;
+    uint64_t NTilesY = 0;
+    const unsigned char* Index = NULL;
+    std::vector<unsigned char> Tokens;
+#ifdef _WIN32
+    void* File = NULL;
+    void* Mapping = NULL;
+#else
+    int File = -1;
+#endif
+};
+
+
+bool field_archive_create(FieldArchiveWriter& Writer, const std::string& Path, const FieldArchiveHeader& Header);
+
+/**
+ * @brief       Compresses and appends the tile (TX, TY). Tiles can be written in any order.
+ *
+ * @param       Values      The values of the tile, rows top-down, Stride values apart.
+ */
+bool field_archive_write_tile(FieldArchiveWriter& Writer, uint64_t TX, uint64_t TY,
+                              const uint32_t* Values, long long Stride);
+
+/**
+ * @brief       Writes the index and closes the archive.
+ */
+bool field_archive_close(FieldArchiveWriter& Writer);
+
+
+bool field_archive_open(FieldArchiveReader& Reader, const std::string& Path);
+
+/**
+ * @brief       Decodes the tile (TX, TY) into Values, with rows top-down and tightly packed. Only
+ *              the tile itself is read.
+ */
+bool field_archive_read_tile(FieldArchiveReader& Reader, uint64_t TX, uint64_t TY, uint32_t* Values);
+
+void field_archive_close(FieldArchiveReader& Reader);
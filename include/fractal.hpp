@@ -0,0 +1,117 @@
+/**
+ * @file        fractal.hpp
+ *
+ * @brief       Parameters shared between the host application and the shaders, and helpers for
+ *              manipulating the view they describe.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#ifndef _USE_MATH_DEFINES
+#define _USE_MATH_DEFINES
+#endif
+#include <math.h>
+
+
+/**
+ * @brief       Parameters of the fractal. The layout must match the ParamsStruct declared in
+ *              the compute shaders, since the struct is copied as-is into a std430 buffer.
+ */
+struct ParamsStruct
+{
+    int niters      = 40;
+    int nroots      = 3;
+    double angle    = M_PI / 2.0;
+    double xlim[2]  = { -1.0, 1.0 };
+    double ylim[2]  = { -1.0, 1.0 };
+};
+
+enum FractalType
+{
+    NEWTON,
+    JULIA,
+    MANDELBROT,
+    INVALID
+};
+
+/**
+ * @brief       Forms of the polynomial used to compute Newton's step p(z) / p'(z).
+ */
+enum NewtonStep
+{
+    NEWTON_STEP_AUTO,
+    NEWTON_STEP_UNITY,              // p = z^n - 1, p' = n z^(n - 1), the power computed by squaring
+    NEWTON_STEP_COEFFICIENTS,       // Horner's scheme on the expanded polynomial, for p and p' at once
+    NEWTON_STEP_ROOTS               // p / p' = 1 / sum_k 1 / (z - r_k)
+};
+
+// Most roots for which the coefficient form is chosen. The coefficients of polynomials with more
+// roots in the unit disk grow like binomials, and Horner's scheme loses their digits to cancellation
+const int NewtonCoefficientRoots = 8;
+
+
+/**
+ * @brief       Enlarges the view along one axis, keeping it centered, so that its aspect ratio
+ *              matches the one of a Width x Height image and pixels are square.
+ */
+void fit_aspect(ParamsStruct& Params, long long Width, long long Height);
+
+/**
+ * @brief       Computes the parameters for rendering a single tile of an image.
+ *
+ * @details     The image has size Width x Height and covers the view described by Params.
+ *              The tile has size TileSize x TileSize and its top-left pixel is (X0, Y0), with
+ *              Y growing downward. The returned view always covers the full tile, even when the
+ *              tile falls partially outside the image, so that the pixel spacing is preserved.
+ */
+ParamsStruct tile_params(const ParamsStruct& Params, long long Width, long long Height,
+                         long long X0, long long Y0, int TileSize);
+
+/**
+ * @brief       Stores the roots of z^n - 1 used by Newton's fractal into Roots, as NRoots pairs of
+ *              real and imaginary parts.
+ */
+void newton_roots(int NRoots, double* Roots);
+
+/**
+ * @brief       Stores the NRoots + 1 coefficients of the polynomial with the given roots into
+ *              Coeffs, lowest degree first, as pairs of real and imaginary parts.
+ */
+void newton_coefficients(int NRoots, const double* Roots, double* Coeffs);
+
+const char* newton_step_name(NewtonStep Step);
+
+/**
+ * @brief       Forces the form of Newton's step chosen by newton_step, or lets it choose with
+ *              NEWTON_STEP_AUTO.
+ */
+void set_newton_step(NewtonStep Step);
+
+/**
+ * @brief       The cheapest form of Newton's step for the polynomial with the given roots: the
+ *              closed form for the roots of z^n - 1, whose cost grows with log(n), Horner's scheme
+ *              up to NewtonCoefficientRoots roots, and the sum over the roots above. The last two
+ *              take O(n) operations, but the sum needs a division per root.
+ */
+NewtonStep newton_step(int NRoots, const double* Roots);
+
+/**
+ * @brief       Whether the shaders darken the colours of Newton's fractal with the iterations taken
+ *              to converge, and paint black the points that never do.
+ */
+void set_newton_shading(bool Shading);
+bool newton_shading();
+
+/**
+ * @brief       Computes the constant 0.7885 * exp(i * Angle) of Julia's set, rounded as the shaders do.
+ */
+void julia_constant(double Angle, double& Re, double& Im);
+
+/**
+ * @brief       The colormap of the shaders, with Theta in [0, 1], as 8-bit RGB.
+ */
+void colormap(double Theta, unsigned char* RGB);
@@ -0,0 +1,52 @@
+/**
+ * @file        fragment_renderer.hpp
+ *
+ * @brief       Renders fractals with the fragment shaders, drawing a quad over the framebuffer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <glad/glad.h>
+#include <fractal.hpp>
+#include <view_model.hpp>
+
+
+struct FragmentRenderer
+{
+    FractalType Type    = FractalType::INVALID;
+    GLuint Programs[VIEW_AUTO] = { 0, 0, 0 };       // One kernel per precision, no DD for Newton
+    GLuint VAO          = 0;
+    GLuint VBO          = 0;
+    GLuint RootsBuf     = 0;
+    ViewPrecision Precision     = ViewPrecision::VIEW_AUTO;     // Forced kernel, or VIEW_AUTO
+    ViewPrecision LastPrecision = ViewPrecision::VIEW_FP64;     // Kernel of the last frame
+};
+
+
+/**
+ * @brief       Compiles the fragment shaders for the given fractal, one per precision, and creates
+ *              the quad covering the viewport.
+ *
+ * @param       RootsBuf    Buffer with the roots of the polynomial, required when Type is NEWTON.
+ *                          It is not owned by the renderer.
+ */
+bool create_fragment_renderer(FragmentRenderer& Renderer, FractalType Type, GLuint RootsBuf);
+
+/**
+ * @brief       Draws View into the current framebuffer, whose viewport is Width x Height pixels,
+ *              with the iterations and the other parameters of Params. The view is fitted to the
+ *              aspect ratio of the viewport, and drawn with the kernel chosen by the precision of
+ *              the renderer, by default the cheapest one that resolves the pixels.
+ */
+void fragment_render(FragmentRenderer& Renderer, const ParamsStruct& Params, const ViewModel& View, int Width, int Height);
+
+/**
+ * @brief       Like the above, with the view described by the limits in Params.
+ */
+void fragment_render(FragmentRenderer& Renderer, const ParamsStruct& Params, int Width, int Height);
+
+void destroy_fragment_renderer(FragmentRenderer& Renderer);
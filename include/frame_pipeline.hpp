@@ -0,0 +1,96 @@
+/**
+ * @file        frame_pipeline.hpp
+ *
+ * @brief       Asynchronous readback and encoding of rendered frames.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <glad/glad.h>
+#include <frame_sink.hpp>
+#include <memory_tracker.hpp>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+/**
+ * @brief       Overlaps the rendering of a frame with the readback and the encoding of the
+ *              previous ones.
+ *
+ * @details     Every pushed texture is copied into a pixel buffer object guarded by a fence, so
+ *              the copy is queued on the GPU right after the dispatch that produced the frame.
+ *              The host only waits for a frame when all the pixel buffers are in flight, then
+ *              copies it into one of a fixed set of host buffers and hands it to an encoder
+ *              thread that feeds the sink. While frame k+1 is computed, frame k is read back and
+ *              frame k-1 is encoded. No memory is allocated after create().
+ */
+class FramePipeline
+{
+public:
+    FramePipeline();
+    ~FramePipeline();
+
+    /**
+     * @brief   Allocates Depth pixel buffers and two host buffers of Width x Height RGBA pixels.
+     *          Under a memory budget, fewer pixel buffers are used if needed, down to one.
+     */
+    bool create(int Width, int Height, FrameSink* Sink, int Depth = 2);
+
+    /**
+     * @brief   Queues the readback of the next frame from a Width x Height texture.
+     */
+    bool push(GLuint Texture);
+
+    /**
+     * @brief   Waits for all the queued frames to be encoded and closes the sink.
+     */
+    bool finish();
+
+    long long frames() const { return m_Frames; }
+    double wait_time() const { return m_WaitTime; }
+    double copy_time() const { return m_CopyTime; }
+    double stall_time() const { return m_StallTime; }
+    double encode_time() const { return m_EncodeTime; }
+
+private:
+    bool retire_oldest();
+    void encoder_loop();
+    void destroy();
+
+    int m_Width;
+    int m_Height;
+    size_t m_FrameBytes;
+    FrameSink* m_Sink;
+
+    // GPU side: ring of pixel buffers, each one guarded by a fence
+    std::vector<GLuint> m_PBOs;
+    std::vector<GLsync> m_Fences;
+    int m_Head;
+    int m_InFlight;
+    long long m_Pushed;
+
+    // Host side: fixed pool of buffers shared with the encoder thread
+    std::vector<std::vector<unsigned char>> m_Buffers;
+    std::vector<int> m_FreeBuffers;
+    MemoryReservation m_PBOBytes;
+    MemoryReservation m_HostBytes;
+    std::deque<std::pair<int, long long>> m_Queue;
+    std::mutex m_Mutex;
+    std::condition_variable m_Signal;
+    std::thread m_Encoder;
+    bool m_Stop;
+    bool m_Failed;
+
+    long long m_Frames;
+    double m_WaitTime;
+    double m_CopyTime;
+    double m_StallTime;
+    double m_EncodeTime;
+};
@@ -0,0 +1,50 @@
+/**
+ * @file        frame_sink.hpp
+ *
+ * @brief       Destinations for the frames of an animation.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief       Receives the frames of an animation, in order. Frames are given as 8-bit RGBA with
+ *              rows stored bottom-up, as read back from the textures. Sinks are driven by a single
+ *              encoder thread and never touch the OpenGL context.
+ */
+class FrameSink
+{
+public:
+    virtual ~FrameSink() { }
+
+    virtual bool open(int Width, int Height) = 0;
+    virtual bool write_frame(const unsigned char* RGBA, long long Index) = 0;
+    virtual bool close() = 0;
+};
+
+
+/**
+ * @brief       Writes every frame to a numbered PNG file, Prefix00000.png, Prefix00001.png, ...
+ */
+class PNGSequenceSink : public FrameSink
+{
+public:
+    PNGSequenceSink(const std::string& Prefix);
+
+    bool open(int Width, int Height) override;
+    bool write_frame(const unsigned char* RGBA, long long Index) override;
+    bool close() override;
+
+private:
+    std::string m_Prefix;
+    int m_Width;
+    int m_Height;
+    std::vector<unsigned char> m_RGB;
+};
@@ -0,0 +1,57 @@
+/**
+ * @file        gl_utils.hpp
+ *
+ * @brief       Utilities for loading and compiling the shaders of the application.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <glad/glad.h>
+#include <string>
+#include <fractal.hpp>
+
+
+/**
+ * @brief       Checks the compilation status of a shader, or the link status of a program if
+ *              Type is GL_PROGRAM. Prints the info log on failure.
+ */
+bool check_compile_errors(GLuint Shader, GLenum Type);
+
+/**
+ * @brief       Reads a whole text file into Content. Returns false if the file cannot be opened.
+ */
+bool read_text_file(const char* Path, std::string& Content);
+
+/**
+ * @brief       Paths of the compute and fragment shaders implementing the given fractal.
+ */
+const char* compute_shader_path(FractalType Type);
+const char* fragment_shader_path(FractalType Type);
+
+/**
+ * @brief       Inserts the given block of #define directives right after the #version line.
+ */
+std::string inject_defines(const std::string& Source, const std::string& Defines);
+
+/**
+ * @brief       Compiles and links the compute shader at the given path.
+ *
+ * @param       Defines     Block of #define directives enabling optional features of the shader.
+ *
+ * @return      The program, or 0 if the shader cannot be read or compiled.
+ */
+GLuint build_compute_program(const char* Path, const std::string& Defines = "");
+
+/**
+ * @brief       Compiles and links the program made by the given vertex shader source and the
+ *              fragment shader at the given path.
+ *
+ * @param       Defines     Block of #define directives inserted into the fragment shader.
+ *
+ * @return      The program, or 0 if the shaders cannot be read or compiled.
+ */
+GLuint build_render_program(const char* VSource, const char* FragmentPath, const std::string& Defines = "");
@@ -0,0 +1,43 @@
+/**
+ * @file        hud.hpp
+ *
+ * @brief       A text overlay drawn on top of the window, used to show the statistics.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+
+struct Hud
+{
+    GLuint Program      = 0;
+    GLuint VAO          = 0;
+    GLuint Texture      = 0;
+    int Width           = 0;    // Size of the texture holding the text
+    int Height          = 0;
+    std::vector<unsigned char> Pixels;
+    bool Visible        = false;
+};
+
+
+bool create_hud(Hud& H);
+
+/**
+ * @brief       Rasterizes the text, made by lines separated by '\n', with a built-in 5x7 font.
+ *              Lowercase letters are drawn in uppercase, unsupported characters as blanks.
+ */
+void hud_set_text(Hud& H, const std::string& Text);
+
+/**
+ * @brief       Draws the text in the top-left corner of a Width x Height framebuffer, if visible.
+ */
+void hud_draw(Hud& H, int Width, int Height);
+
+void destroy_hud(Hud& H);
@@ -0,0 +1,98 @@
+/**
+ * @file        latency_tracker.hpp
+ *
+ * @brief       Measures the time from the input to the frames that show its effect.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+
+/**
+ * @brief       Follows every input event to the first frame that reflects it.
+ *
+ * @details     The arrival of every input event is timestamped by the window callbacks. The oldest
+ *              event not yet shown is handed to the first frame whose view changes, which is timed
+ *              until glfwSwapBuffers returns and until the GPU is done with it. The completion on
+ *              the GPU is measured with a GL_TIMESTAMP query issued after the swap, whose result is
+ *              collected without stalling a few frames later and converted to the host clock.
+ *              Times are in seconds since the creation of the tracker.
+ */
+class LatencyTracker
+{
+public:
+    LatencyTracker();
+
+    double now() const;
+
+    /**
+     * @brief   Records the arrival of an input event. Thread-safe.
+     */
+    void input_arrived(double Time);
+
+    /**
+     * @brief   Returns the arrival of the oldest event not yet shown and forgets it, or a negative
+     *          number if there is none. Called once per frame, when the input is sampled.
+     */
+    double take_pending();
+
+    /**
+     * @brief   Records a frame that reflects the input arrived at InputTime, right after
+     *          glfwSwapBuffers returned. Must be called from the thread owning the context.
+     */
+    void frame_presented(double InputTime);
+
+    /**
+     * @brief   Collects the available GPU results, or all of them if Wait is true.
+     */
+    void poll(bool Wait);
+
+    /**
+     * @brief   Median and 99th percentile to display of the last frames, in milliseconds. Returns
+     *          false if no frame was measured yet.
+     */
+    bool recent(double& P50, double& P99, size_t LastFrames = 256);
+
+    /**
+     * @brief   Waits for the pending results and prints the percentiles of all the frames.
+     */
+    void report(std::ostream& Stream);
+
+    /**
+     * @brief   Deletes the queries. Must be called before the context is destroyed.
+     */
+    void destroy();
+
+private:
+    struct PendingFrame
+    {
+        GLuint Query;
+        double InputTime;
+        double SwapMs;
+        double ClockOffset;     // Host time minus GPU time, in seconds
+    };
+
+    std::chrono::steady_clock::time_point m_Epoch;
+    std::mutex m_Mutex;
+    double m_Pending;
+    std::deque<PendingFrame> m_Frames;
+    std::vector<GLuint> m_FreeQueries;
+    std::vector<double> m_SwapMs;
+    std::vector<double> m_DisplayMs;
+};
+
+
+/**
+ * @brief       The tracker shared by the whole application.
+ */
+LatencyTracker& latency_tracker();
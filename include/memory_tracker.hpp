@@ -0,0 +1,111 @@
+/**
+ * @file        memory_tracker.hpp
+ *
+ * @brief       Accounts for the memory of textures, buffers and host images, within a budget.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <stddef.h>
+#include <mutex>
+#include <ostream>
+
+
+enum MemoryCategory
+{
+    MEM_TEXTURES,       // GPU, textures of the renderers
+    MEM_BUFFERS,        // GPU, storage and pixel buffers
+    MEM_STAGING,        // Host, readback and encoding buffers
+    MEM_IMAGES,         // Host, whole images and fields
+    MEM_COUNT
+};
+
+
+const char* memory_category_name(MemoryCategory Category);
+
+
+/**
+ * @brief       Keeps the current and peak size of every category of allocations. With a budget,
+ *              reservations that would take the total over it are refused, so that callers can
+ *              shrink their allocations or fail before allocating anything. Thread-safe.
+ */
+class MemoryTracker
+{
+public:
+    MemoryTracker();
+
+    /**
+     * @brief   Sets the budget for all the categories together, in bytes. 0 means no budget.
+     */
+    void set_budget(size_t Bytes);
+    size_t budget() const { return m_Budget; }
+
+    /**
+     * @brief   Accounts for Bytes more in Category. Returns false, accounting for nothing, if
+     *          that would exceed the budget.
+     */
+    bool reserve(MemoryCategory Category, size_t Bytes);
+    void release(MemoryCategory Category, size_t Bytes);
+
+    size_t current(MemoryCategory Category);
+    size_t peak(MemoryCategory Category);
+    size_t total();
+    size_t total_peak();
+
+    /**
+     * @brief   Bytes that can still be reserved, or SIZE_MAX without a budget.
+     */
+    size_t available();
+
+    void report(std::ostream& Stream);
+
+private:
+    std::mutex m_Mutex;
+    size_t m_Budget;
+    size_t m_Current[MEM_COUNT];
+    size_t m_Peak[MEM_COUNT];
+    size_t m_Total;
+    size_t m_TotalPeak;
+};
+
+
+/**
+ * @brief       The tracker shared by the whole application.
+ */
+MemoryTracker& memory_tracker();
+
+
+/**
+ * @brief       Holds a reservation until destroyed or released.
+ */
+class MemoryReservation
+{
+public:
+    MemoryReservation() : m_Category(MEM_STAGING), m_Bytes(0) { }
+    ~MemoryReservation() { release(); }
+    MemoryReservation(const MemoryReservation&) = delete;
+    MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+    /**
+     * @brief   Reserves Bytes in Category, releasing the previous reservation first. Prints an
+     *          error naming What if the budget does not allow it.
+     */
+    bool reserve(MemoryCategory Category, size_t Bytes, const char* What);
+    void release();
+
+private:
+    MemoryCategory m_Category;
+    size_t m_Bytes;
+};
+
+
+/**
+ * @brief       Halves TileSize until TileSize x TileSize pixels of BytesPerPixel bytes fit in the
+ *              memory still available, never going below MinTileSize. Returns 0 if not even
+ *              MinTileSize fits.
+ */
+int fit_tile_size(int TileSize, size_t BytesPerPixel, int MinTileSize = 32);
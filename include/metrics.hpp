@@ -0,0 +1,109 @@
+/**
+ * @file        metrics.hpp
+ *
+ * @brief       Counters, gauges and histograms of the batch jobs, exported in the text format of
+ *              Prometheus for the textfile collector of the node exporter.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <stage_timer.hpp>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <string>
+#include <ostream>
+
+
+enum MetricCounter
+{
+    METRIC_FRAMES,          // Frames handed to the sinks
+    METRIC_TILES,           // Tiles rendered by the exports, the cost maps and the pyramids
+    METRIC_TILES_RESUMED,   // Tiles of the tiled exports found complete in the journal
+    METRIC_PIXELS,          // Pixels computed by the compute shaders
+    METRIC_ITERATIONS,      // Iteration budget of those pixels
+    METRIC_EXPORT_BYTES,    // Bytes written to images, archives, tiles and streams
+    METRIC_COUNTER_COUNT
+};
+
+enum MetricGauge
+{
+    METRIC_TILE_QUEUE,      // Tiles being written
+    METRIC_FRAME_QUEUE,     // Frames being read back
+    METRIC_GAUGE_COUNT
+};
+
+
+/**
+ * @brief       Collects the metrics and periodically rewrites them into a file.
+ *
+ * @details     The counters are totals since the start of the process, so pixels/s and
+ *              iterations/s come from rate() on the dashboards. The time of every stage recorded
+ *              by the stage timer goes into a histogram. The file is written next to its final
+ *              path and renamed over it, so the collector never reads half a file. Nothing is
+ *              collected until the metrics are enabled. Thread-safe.
+ */
+class Metrics
+{
+public:
+    Metrics();
+    ~Metrics();
+
+    void set_enabled(bool Enabled);
+    bool enabled() const { return m_Enabled.load(std::memory_order_relaxed); }
+
+    void add(MetricCounter Counter, double Value = 1.0);
+    void set(MetricGauge Gauge, double Value);
+    void observe(StageType Stage, double Seconds);
+
+    /**
+     * @brief   Writes all the metrics in the text exposition format.
+     */
+    void write_text(std::ostream& Stream);
+
+    /**
+     * @brief   Replaces Path with the current metrics.
+     */
+    bool write_file(const std::string& Path);
+
+    /**
+     * @brief   Enables the metrics and rewrites Path every Interval seconds in the background.
+     */
+    bool start(const std::string& Path, double Interval);
+
+    /**
+     * @brief   Stops the background writes and writes the final values.
+     */
+    bool stop();
+
+private:
+    static const int NBuckets = 12;
+
+    void writer_loop();
+
+    std::atomic<bool> m_Enabled;
+    std::mutex m_Mutex;
+    double m_Counters[METRIC_COUNTER_COUNT];
+    double m_Gauges[METRIC_GAUGE_COUNT];
+    long long m_Buckets[STAGE_COUNT][NBuckets];     // Not cumulative, summed when written
+    long long m_Count[STAGE_COUNT];
+    double m_Sum[STAGE_COUNT];
+
+    std::string m_Path;
+    double m_Interval;
+    std::thread m_Writer;
+    std::mutex m_WriterMutex;
+    std::condition_variable m_WriterSignal;
+    bool m_Stop;
+};
+
+
+/**
+ * @brief       The metrics shared by the whole application.
+ */
+Metrics& metrics();
@@ -0,0 +1,27 @@
+/**
+ * @file        npy_file.hpp
+ *
+ * @brief       Writes arrays in the NumPy .npy format, so that they can be loaded with numpy.load.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief       Creates a .npy file and writes its header. The caller writes the values in C order
+ *              and closes the file.
+ *
+ * @param       Descr       The NumPy type of the values, such as <u4 or <f8. Only little endian
+ *                          hosts write the little endian types correctly, as the field archives.
+ * @param       Shape       The size of every dimension, the outermost first.
+ * @return      The file, positioned at the start of the data, or NULL if it cannot be written.
+ */
+FILE* npy_create(const std::string& Path, const char* Descr, const std::vector<long long>& Shape);
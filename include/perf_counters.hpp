@@ -0,0 +1,87 @@
+/**
+ * @file        perf_counters.hpp
+ *
+ * @brief       Hardware performance counters of the calling thread, through perf_event_open on Linux.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+enum PerfCounterType
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_BRANCH_MISSES,
+    PERF_LLC_MISSES,        // Last level cache read misses
+    PERF_COUNTER_COUNT
+};
+
+
+struct PerfSample
+{
+    double Values[PERF_COUNTER_COUNT] = { };    // Scaled up if the counter was multiplexed
+    bool Valid[PERF_COUNTER_COUNT] = { };
+
+    void add(const PerfSample& Other);
+};
+
+
+/**
+ * @brief       The counters of the thread that opens them, in user space only. Counters that the
+ *              CPU or the kernel settings do not allow are left out, and nothing is counted on
+ *              other platforms.
+ */
+class PerfCounters
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    /**
+     * @brief   Opens the counters. Returns false if none of them is available.
+     */
+    bool open();
+    void start();
+    PerfSample stop();
+    void close();
+
+private:
+    int m_Fds[PERF_COUNTER_COUNT];
+};
+
+
+/**
+ * @brief       Counters and timing of a phase of a parallel computation, for each worker thread.
+ */
+struct PerfPhase
+{
+    std::string Name;
+    double Seconds = 0.0;
+    long long Pixels = 0;
+    std::vector<PerfSample> Threads;
+    std::vector<double> ThreadSeconds;
+    std::vector<long long> ThreadPixels;
+
+    PerfSample total() const;
+};
+
+
+/**
+ * @brief       Adds the phases to the ones in Into with the same name, thread by thread, appending
+ *              the new ones. Useful to sum up the phases of many frames.
+ */
+void perf_merge(std::vector<PerfPhase>& Into, const std::vector<PerfPhase>& Phases);
+
+/**
+ * @brief       Prints the time, the instructions per cycle and the misses per pixel of every phase,
+ *              for all the threads together and then for each one.
+ */
+void perf_report(std::ostream& Stream, const std::vector<PerfPhase>& Phases);
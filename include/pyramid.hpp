@@ -0,0 +1,48 @@
+/**
+ * @file        pyramid.hpp
+ *
+ * @brief       Renders a fractal straight into a multi-level pyramid of tiles, ready to be served
+ *              by Deep Zoom or slippy-map viewers.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <string>
+#include <fractal.hpp>
+
+
+enum PyramidLayout
+{
+    DEEP_ZOOM,      // OUTPUT.dzi and OUTPUT_files/<level>/<col>_<row>.png
+    XYZ_TILES       // OUTPUT/<z>/<x>/<y>.png
+};
+
+struct PyramidOptions
+{
+    std::string Output;
+    int Levels              = 0;
+    int TileSize            = 256;
+    PyramidLayout Layout    = PyramidLayout::DEEP_ZOOM;
+    bool Downsample         = true;
+    int MaxPendingWrites    = 64;       // Tiles being written at the same time
+    bool ThreadedWrites     = false;    // Write with a thread pool even if io_uring is available
+};
+
+
+/**
+ * @brief       Renders the view described by Params into a pyramid with the given number of levels.
+ *
+ * @details     Level 0 is a single TileSize x TileSize tile covering the whole view, and every
+ *              level doubles the resolution of the previous one. If Downsample is true, only the
+ *              deepest level is rendered: it is walked depth-first in GPU-sized blocks and every
+ *              coarser level is produced by 2x downsampling of the level below, so that at most
+ *              one block and four tiles per level are held in memory. Otherwise, every level is
+ *              rendered at its native resolution. Tiles are encoded as soon as they are ready
+ *              and written in the background by a TileWriter.
+ *              Requires a current OpenGL context.
+ */
+bool build_pyramid(FractalType Type, const ParamsStruct& Params, const PyramidOptions& Options);
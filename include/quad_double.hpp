@@ -0,0 +1,169 @@
+/**
+ * @file        quad_double.hpp
+ *
+ * @brief       Quad-double arithmetic: unevaluated sums of four doubles with about 212 bits of
+ *              mantissa, built on the error-free transforms of double_double.hpp.
+ *
+ * @details     The operators follow the sloppy algorithms of Hida, Li and Bailey (QD library),
+ *              except for the renormalization, which always runs both of its passes instead of
+ *              branching on zero components. A few bits are lost when components cancel, in
+ *              exchange for code that the compiler can vectorize across pixels. As for the
+ *              double-doubles, FMA must be available for the products to be fast.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <double_double.hpp>
+
+
+struct QuadDouble
+{
+    double X[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+    QuadDouble() = default;
+    QuadDouble(double Value) : X{ Value, 0.0, 0.0, 0.0 } { }
+    QuadDouble(const DoubleDouble& Value) : X{ Value.Hi, Value.Lo, 0.0, 0.0 } { }
+    QuadDouble(double X0, double X1, double X2, double X3) : X{ X0, X1, X2, X3 } { }
+
+    explicit operator double() const { return X[0] + (X[1] + (X[2] + X[3])); }
+    explicit operator float() const { return (float)(double)*this; }
+};
+
+
+namespace qd
+{
+
+/**
+ * @brief       a + b + c = a + b + c, with a the rounded sum and b, c the errors, in order.
+ */
+inline void three_sum(double& a, double& b, double& c)
+{
+    DoubleDouble T1 = two_sum(a, b);
+    DoubleDouble T3 = two_sum(c, T1.Hi);
+    DoubleDouble T2 = two_sum(T1.Lo, T3.Lo);
+    a = T3.Hi;
+    b = T2.Hi;
+    c = T2.Lo;
+}
+
+/**
+ * @brief       Like three_sum, keeping only the rounded sum of the errors in b.
+ */
+inline void three_sum2(double& a, double& b, double c)
+{
+    DoubleDouble T1 = two_sum(a, b);
+    DoubleDouble T3 = two_sum(c, T1.Hi);
+    a = T3.Hi;
+    b = T1.Lo + T3.Lo;
+}
+
+/**
+ * @brief       Turns five overlapping components, by decreasing magnitude, into four that do not
+ *              overlap.
+ */
+inline QuadDouble renorm(double c0, double c1, double c2, double c3, double c4)
+{
+    // Bottom-up, the tail is gathered into the leading components
+    DoubleDouble S = quick_two_sum(c3, c4);
+    c3 = S.Hi; c4 = S.Lo;
+    S = quick_two_sum(c2, c3);
+    c2 = S.Hi; c3 = S.Lo;
+    S = quick_two_sum(c1, c2);
+    c1 = S.Hi; c2 = S.Lo;
+    S = quick_two_sum(c0, c1);
+    c0 = S.Hi; c1 = S.Lo;
+    // Top-down, every component is pushed below the precision of the previous one
+    S = quick_two_sum(c1, c2);
+    c1 = S.Hi; c2 = S.Lo;
+    S = quick_two_sum(c2, c3);
+    c2 = S.Hi; c3 = S.Lo;
+    return QuadDouble(c0, c1, c2, c3 + c4);
+}
+
+}
+
+
+inline QuadDouble operator+(const QuadDouble& a, const QuadDouble& b)
+{
+    DoubleDouble S0 = two_sum(a.X[0], b.X[0]);
+    DoubleDouble S1 = two_sum(a.X[1], b.X[1]);
+    DoubleDouble S2 = two_sum(a.X[2], b.X[2]);
+    DoubleDouble S3 = two_sum(a.X[3], b.X[3]);
+    double t0 = S0.Lo, t1 = S1.Lo, t2 = S2.Lo;
+
+    DoubleDouble S = two_sum(S1.Hi, t0);
+    double s1 = S.Hi, s2 = S2.Hi, s3 = S3.Hi;
+    t0 = S.Lo;
+    qd::three_sum(s2, t0, t1);
+    qd::three_sum2(s3, t0, t2);
+    t0 = t0 + t1 + S3.Lo;
+    return qd::renorm(S0.Hi, s1, s2, s3, t0);
+}
+
+inline QuadDouble operator-(const QuadDouble& a)
+{
+    return QuadDouble(-a.X[0], -a.X[1], -a.X[2], -a.X[3]);
+}
+
+inline QuadDouble operator-(const QuadDouble& a, const QuadDouble& b)
+{
+    return a + (-b);
+}
+
+inline QuadDouble operator*(const QuadDouble& a, const QuadDouble& b)
+{
+    // Products of order eps, exact, and of order eps^2, exact up to their errors
+    DoubleDouble P0 = two_prod(a.X[0], b.X[0]);
+    DoubleDouble P1 = two_prod(a.X[0], b.X[1]);
+    DoubleDouble P2 = two_prod(a.X[1], b.X[0]);
+    DoubleDouble P3 = two_prod(a.X[0], b.X[2]);
+    DoubleDouble P4 = two_prod(a.X[1], b.X[1]);
+    DoubleDouble P5 = two_prod(a.X[2], b.X[0]);
+
+    double p1 = P1.Hi, p2 = P2.Hi, q0 = P0.Lo;
+    qd::three_sum(p1, p2, q0);
+
+    // Six-three sum of p2, q1, q2, p3, p4, p5
+    double q1 = P1.Lo, q2 = P2.Lo;
+    double p3 = P3.Hi, p4 = P4.Hi, p5 = P5.Hi;
+    qd::three_sum(p2, q1, q2);
+    qd::three_sum(p3, p4, p5);
+    DoubleDouble S0 = two_sum(p2, p3);
+    DoubleDouble S1 = two_sum(q1, p4);
+    double s2 = q2 + p5;
+    DoubleDouble S = two_sum(S1.Hi, S0.Lo);
+    s2 += S.Lo + S1.Lo;
+
+    // Terms of order eps^3
+    double s1 = S.Hi + (a.X[0] * b.X[3] + a.X[1] * b.X[2] + a.X[2] * b.X[1] + a.X[3] * b.X[0] +
+                        q0 + P3.Lo + P4.Lo + P5.Lo);
+    return qd::renorm(P0.Hi, p1, S0.Hi, s1, s2);
+}
+
+inline QuadDouble operator/(const QuadDouble& a, const QuadDouble& b)
+{
+    // Long division, as for the double-doubles
+    double Q0 = a.X[0] / b.X[0];
+    QuadDouble R = a - b * QuadDouble(Q0);
+    double Q1 = R.X[0] / b.X[0];
+    R = R - b * QuadDouble(Q1);
+    double Q2 = R.X[0] / b.X[0];
+    R = R - b * QuadDouble(Q2);
+    double Q3 = R.X[0] / b.X[0];
+    return qd::renorm(Q0, Q1, Q2, Q3, 0.0);
+}
+
+/**
+ * @brief       a * b, exact when b is a power of two.
+ */
+inline QuadDouble mul_pwr2(const QuadDouble& a, double b)
+{
+    return QuadDouble(a.X[0] * b, a.X[1] * b, a.X[2] * b, a.X[3] * b);
+}
+
+inline QuadDouble& operator+=(QuadDouble& a, const QuadDouble& b) { return a = a + b; }
+inline QuadDouble& operator-=(QuadDouble& a, const QuadDouble& b) { return a = a - b; }
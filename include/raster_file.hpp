@@ -0,0 +1,62 @@
+/**
+ * @file        raster_file.hpp
+ *
+ * @brief       An on-disk RGB image that can be written in arbitrary order, one block of rows at
+ *              a time. The image is stored as a binary PPM, whose uncompressed layout allows to
+ *              write images of any size without holding them in memory.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string>
+
+
+struct RasterFile
+{
+    FILE* Handle        = NULL;
+    long long Width     = 0;
+    long long Height    = 0;
+    long long DataStart = 0;
+};
+
+
+/**
+ * @brief       Creates a Width x Height image at the given path. The file is sized upfront, so
+ *              blocks can be written in any order.
+ */
+bool raster_create(RasterFile& Raster, const std::string& Path, long long Width, long long Height);
+
+/**
+ * @brief       Opens for writing an image previously created by raster_create with the same size,
+ *              keeping its content. Fails if the file does not exist or has a different size.
+ */
+bool raster_open(RasterFile& Raster, const std::string& Path, long long Width, long long Height);
+
+/**
+ * @brief       Writes a block of Cols x Rows pixels whose top-left corner is (X0, Y0).
+ *
+ * @param       RGB         Pixels of the block, 3 bytes per pixel.
+ * @param       Stride      Distance in bytes between two consecutive rows of RGB. A negative
+ *                          stride allows writing blocks stored bottom-up.
+ */
+bool raster_write_block(RasterFile& Raster, long long X0, long long Y0, int Cols, int Rows,
+                        const unsigned char* RGB, long long Stride);
+
+/**
+ * @brief       Flushes the blocks written so far to the storage device, so that they survive a
+ *              crash of the whole machine.
+ */
+bool raster_sync(RasterFile& Raster);
+
+void raster_close(RasterFile& Raster);
+
+
+/**
+ * @brief       Flushes a stream and waits until its data reaches the storage device.
+ */
+bool sync_file(FILE* Handle);
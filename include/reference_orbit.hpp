@@ -0,0 +1,42 @@
+/**
+ * @file        reference_orbit.hpp
+ *
+ * @brief       Computes the orbit of a single point of Mandelbrot's or Julia's set in arbitrary
+ *              precision, the reference of the perturbation methods for deep zooms.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fractal.hpp>
+
+
+struct ReferenceOrbitOptions
+{
+    std::string Output;                 // .npy file, empty to keep the orbit in memory only
+    std::string CenterX;                // Decimal, with as many digits as the zoom needs
+    std::string CenterY;
+    double Log10Scale       = -1000.0;  // The pixels are 10^Log10Scale apart
+    long long Iterations    = 1000000;
+};
+
+
+/**
+ * @brief       Iterates z^2 + c from the center, with as many limbs as the scale needs, and stores
+ *              every point of the orbit rounded to double.
+ *
+ * @details     For Mandelbrot's set z starts at 0 and c is the center, for Julia's set z starts
+ *              at the center and c is the constant of Params.angle. The iterations stop when the
+ *              orbit escapes |z| > 2, so the orbit can be shorter than requested. The orbit is
+ *              written as a N x 2 array of float64 to Output, if given, and the iterations per
+ *              second are printed at the end.
+ *
+ * @param       Orbit       Receives the points, real and imaginary part interleaved.
+ */
+bool reference_orbit(FractalType Type, const ParamsStruct& Params, const ReferenceOrbitOptions& Options,
+                     std::vector<double>& Orbit);
@@ -0,0 +1,109 @@
+/**
+ * @file        session.hpp
+ *
+ * @brief       Records the input of an interactive session, so that it can be replayed exactly.
+ *
+ * @details     A session file is a text file made by a header and one line per frame:
+ *
+ *                  GPUFractalsSession 2
+ *                  TYPE NITERS NROOTS ANGLE XMIN XMAX YMIN YMAX WINWIDTH WINHEIGHT MOUSEX MOUSEY
+ *                      CXHI CXLO CYHI CYLO HALFWIDTH HALFHEIGHT
+ *                  TIME MOUSEX MOUSEY BUTTONS KEYS NITERS XMIN XMAX YMIN YMAX
+ *                  ...
+ *
+ *              The header holds the view and the window at the start, and the position of the
+ *              cursor before the first frame. The view is stored both as its limits and as its
+ *              double-double center with the half extents, so that deep zooms are replayed at the
+ *              same precision; version 1 files only have the limits. Every frame holds the input
+ *              sampled at the start of the frame, with its time in seconds since the start of the
+ *              session, and the view that resulted from it. Lines starting with # are ignored.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <fractal.hpp>
+#include <view_model.hpp>
+
+
+enum InputButton
+{
+    INPUT_LEFT          = 1,
+    INPUT_RIGHT         = 2
+};
+
+enum InputKey
+{
+    INPUT_KEY_ADD       = 1,
+    INPUT_KEY_SUBTRACT  = 2,
+    INPUT_KEY_SHIFT     = 4,
+    INPUT_KEY_EXPORT    = 8,
+    INPUT_KEY_STATS     = 16,
+    INPUT_KEY_ESCAPE    = 32
+};
+
+
+/**
+ * @brief       The state of the input at the start of a frame.
+ */
+struct InputSample
+{
+    double Time     = 0.0;      // Seconds since the start of the session
+    double MouseX   = 0.0;
+    double MouseY   = 0.0;
+    int Buttons     = 0;        // InputButton flags
+    int Keys        = 0;        // InputKey flags
+};
+
+
+struct SessionHeader
+{
+    FractalType Type    = FractalType::INVALID;
+    ParamsStruct Params;
+    ViewModel View;             // The view at the start, more precise than the limits in Params
+    int WinWidth        = 0;
+    int WinHeight       = 0;
+    double MouseX       = 0.0;  // Cursor before the first frame
+    double MouseY       = 0.0;
+};
+
+
+struct SessionFrame
+{
+    InputSample Input;
+    ParamsStruct Params;        // The view after the input was applied
+};
+
+
+struct SessionWriter
+{
+    FILE* Handle = NULL;
+    std::string Path;
+};
+
+
+bool session_create(SessionWriter& Writer, const std::string& Path, const SessionHeader& Header);
+bool session_write_frame(SessionWriter& Writer, const SessionFrame& Frame);
+bool session_close(SessionWriter& Writer);
+
+/**
+ * @brief       Reads a whole session file.
+ */
+bool session_read(const std::string& Path, SessionHeader& Header, std::vector<SessionFrame>& Frames);
+
+/**
+ * @brief       Checks whether two views are the same, bit by bit.
+ */
+bool session_same_view(const ParamsStruct& P1, const ParamsStruct& P2);
+
+/**
+ * @brief       Prints the mean, the percentiles and the maximum of the frame times, in milliseconds.
+ */
+void frame_time_report(std::ostream& Stream, std::vector<double> FrameMs);
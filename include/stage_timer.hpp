@@ -0,0 +1,152 @@
+/**
+ * @file        stage_timer.hpp
+ *
+ * @brief       Measures the time spent in each stage of the rendering, on the GPU and on the host.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <glad/glad.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+
+enum StageType
+{
+    STAGE_FRAGMENT,     // GPU, drawing the view in the window
+    STAGE_COMPUTE,      // GPU, dispatch of the compute shaders
+    STAGE_READBACK,     // Host, copying the textures to the host memory
+    STAGE_ENCODE,       // Host, compressing images and fields
+    STAGE_COUNT
+};
+
+
+const char* stage_name(StageType Stage);
+
+/**
+ * @brief       Nearest-rank percentile of the sorted samples.
+ */
+double percentile(const std::vector<double>& Sorted, double P);
+
+
+struct StageStats
+{
+    double LastMs       = 0.0;
+    double AverageMs    = 0.0;      // Exponential moving average
+    double TotalMs      = 0.0;
+    long long Count     = 0;
+    double Iterations   = 0.0;      // Iteration budget of the measured work, for the GPU stages
+};
+
+
+/**
+ * @brief       Collects the timings of the stages.
+ *
+ * @details     The GPU stages are measured with GL_TIME_ELAPSED queries. Every stage alternates
+ *              between two queries and their results are only read once available, so measuring
+ *              never stalls the pipeline: the numbers lag one or two frames behind. If both
+ *              queries of a stage are still pending, the new measurement is skipped. The host
+ *              stages are measured with a steady clock and can be recorded from any thread. The
+ *              GPU stages must be measured from the thread owning the context. Nothing is measured
+ *              until the timer is enabled.
+ */
+class StageTimer
+{
+public:
+    StageTimer();
+
+    void set_enabled(bool Enabled);
+    bool enabled() const { return m_Enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief   Starts measuring a GPU stage. Only one GPU stage can be measured at a time.
+     *
+     * @param   Iterations  Iteration budget of the work submitted within the stage.
+     */
+    void begin_gpu(StageType Stage, double Iterations = 0.0);
+    void end_gpu(StageType Stage);
+
+    /**
+     * @brief   Records Ms milliseconds spent in a stage. Thread-safe.
+     */
+    void record(StageType Stage, double Ms, double Iterations = 0.0);
+
+    /**
+     * @brief   Collects the available GPU results and measures the time since the previous call.
+     */
+    void end_frame();
+
+    StageStats stats(StageType Stage);
+    double frame_ms() const { return m_FrameMs; }
+
+    /**
+     * @brief   Waits for the pending GPU results and prints the totals of every measured stage.
+     */
+    void report(std::ostream& Stream);
+
+    /**
+     * @brief   Deletes the queries. Must be called before the context is destroyed.
+     */
+    void destroy();
+
+private:
+    struct GPUQuery
+    {
+        GLuint Id           = 0;
+        bool Pending        = false;
+        double Iterations   = 0.0;
+    };
+
+    void poll(StageType Stage, bool Wait);
+
+    std::atomic<bool> m_Enabled;
+    std::mutex m_Mutex;
+    StageStats m_Stats[STAGE_COUNT];
+
+    GPUQuery m_Queries[STAGE_COUNT][2];
+    int m_Next[STAGE_COUNT];
+    int m_Open;
+    double m_OpenIterations;
+
+    std::chrono::steady_clock::time_point m_LastFrame;
+    double m_FrameMs;
+};
+
+
+/**
+ * @brief       The timer shared by the whole application.
+ */
+StageTimer& stage_timer();
+
+
+/**
+ * @brief       Records the time spent in a host stage between its construction and destruction.
+ */
+class CPUStageScope
+{
+public:
+    explicit CPUStageScope(StageType Stage)
+        : m_Stage(Stage), m_Active(stage_timer().enabled())
+    {
+        if (m_Active)
+            m_Start = std::chrono::steady_clock::now();
+    }
+
+    ~CPUStageScope()
+    {
+        if (m_Active)
+            stage_timer().record(m_Stage, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count());
+    }
+
+private:
+    StageType m_Stage;
+    bool m_Active;
+    std::chrono::steady_clock::time_point m_Start;
+};
@@ -0,0 +1,63 @@
+/**
+ * @file        tile_journal.hpp
+ *
+ * @brief       A journal of the completed tiles of a long render, used to resume it after a crash.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+
+/**
+ * @brief       The journal is a text file whose first line identifies the render, followed by the
+ *              indices of the completed tiles, one per line. Lines are appended as tiles are
+ *              committed, and the journal is rewritten without its torn last line, if any, when
+ *              it is opened again.
+ */
+struct TileJournal
+{
+    FILE* Handle = NULL;
+    std::string Path;
+    std::vector<bool> Done;
+    std::vector<long long> Pending;     // Completed tiles not recorded yet
+    long long DoneCount = 0;
+};
+
+
+/**
+ * @brief       Opens the journal at Path for a render made of NTiles tiles. If the journal exists
+ *              and was written by the same render, the tiles it records are marked as done and
+ *              Resumed is set. A journal of a different render is an error.
+ *
+ * @param       Header      A single line describing the render, without the newline.
+ */
+bool journal_open(TileJournal& Journal, const std::string& Path, const std::string& Header,
+                  long long NTiles, bool& Resumed);
+
+/**
+ * @brief       Discards the tiles recorded so far and starts the journal over.
+ */
+bool journal_reset(TileJournal& Journal, const std::string& Header);
+
+/**
+ * @brief       Marks a tile as complete. The tile is recorded on disk by the next journal_commit.
+ */
+void journal_mark(TileJournal& Journal, long long Tile);
+
+/**
+ * @brief       Records the pending tiles and syncs the journal. The data of the tiles must be
+ *              synced before, otherwise a crash could leave tiles recorded but never written.
+ */
+bool journal_commit(TileJournal& Journal);
+
+/**
+ * @brief       Closes the journal, and deletes it if the render is finished.
+ */
+void journal_close(TileJournal& Journal, bool Remove);
@@ -0,0 +1,83 @@
+/**
+ * @file        tile_writer.hpp
+ *
+ * @brief       Writes many small files asynchronously, keeping file I/O off the rendering thread.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+struct IOUring;
+
+
+/**
+ * @brief       Queues whole files to be written in the background, with a bounded number of files
+ *              in flight.
+ *
+ * @details     On Linux, files are opened, written and closed through an io_uring, so the thread
+ *              queueing the files only pays for the submissions. Where io_uring is unavailable,
+ *              the files are written by a small pool of threads. In both cases, queueing a file
+ *              blocks only when MaxInFlight files are already being written, and the buffers of
+ *              the files are recycled, so no memory is allocated once all of them are in use.
+ */
+class TileWriter
+{
+public:
+    TileWriter();
+    ~TileWriter();
+
+    /**
+     * @brief   Starts the writer. io_uring is used when the kernel supports it, unless
+     *          ForceThreads is true.
+     */
+    bool create(int MaxInFlight = 64, bool ForceThreads = false);
+
+    /**
+     * @brief   Queues the content of Data to be written to Path. Data is taken over by the writer
+     *          and replaced by an empty recycled buffer.
+     */
+    bool write(const std::string& Path, std::vector<unsigned char>& Data);
+
+    /**
+     * @brief   Waits for all the queued files and stops the writer. Returns false if any of the
+     *          files could not be written.
+     */
+    bool finish();
+
+    const char* backend() const;
+
+private:
+    void worker_loop();
+    void recycle(std::vector<unsigned char>& Data);
+
+    int m_MaxInFlight;
+    bool m_Failed;
+
+    // io_uring backend, NULL when the thread pool is used
+    IOUring* m_Ring;
+
+    // Thread pool backend
+    struct Job
+    {
+        std::string Path;
+        std::vector<unsigned char> Data;
+    };
+    std::vector<std::thread> m_Workers;
+    std::deque<Job> m_Queue;
+    std::vector<std::vector<unsigned char>> m_Spare;
+    std::mutex m_Mutex;
+    std::condition_variable m_Signal;
+    int m_InFlight;
+    bool m_Stop;
+};
@@ -0,0 +1,48 @@
+/**
+ * @file        tiled_export.hpp
+ *
+ * @brief       Exports images larger than a single texture by rendering them tile by tile.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <string>
+#include <fractal.hpp>
+
+
+struct TiledExportOptions
+{
+    std::string OutputFile;
+    long long Width     = 0;
+    long long Height    = 0;
+    int TileSize        = 2048;
+    double CheckpointInterval = 60.0;   // Seconds between two checkpoints
+};
+
+
+/**
+ * @brief       Renders the view described by Params into a Width x Height binary PPM.
+ *
+ * @details     The image is walked in tiles of TileSize x TileSize pixels, clamped to
+ *              GL_MAX_TEXTURE_SIZE. Each tile is rendered with the compute shader, read back and
+ *              written in place into the output file, so both GPU and host memory only depend on
+ *              the size of the tiles. Every CheckpointInterval seconds, the output file is synced
+ *              and the completed tiles are recorded in the journal OutputFile.journal. If the
+ *              journal of the same render is found, the export resumes from the tiles it records.
+ *              The journal is deleted once the image is complete. Requires a current OpenGL
+ *              context.
+ */
+bool tiled_export(FractalType Type, const ParamsStruct& Params, const TiledExportOptions& Options);
+
+/**
+ * @brief       Renders the raw iteration field of the view into a Width x Height field archive.
+ *
+ * @details     The field is rendered in tiles of TileSize pixels, rounded down to a multiple of
+ *              the 256 x 256 tiles of the archive, each one compressed as soon as it is read back.
+ *              Requires a current OpenGL context.
+ */
+bool tiled_field_export(FractalType Type, const ParamsStruct& Params, const TiledExportOptions& Options);
@@ -0,0 +1,89 @@
+/**
+ * @file        tracer.hpp
+ *
+ * @brief       Records timelines of scoped events and writes them in the Chrome trace format, which
+ *              can be loaded in Perfetto or chrome://tracing.
+ *
+ * @details     Events are appended to a buffer owned by the thread that records them, so threads
+ *              never contend while tracing. When tracing is off, a scope costs a single relaxed
+ *              load. Defining NO_TRACING removes the scopes altogether.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <atomic>
+#include <string>
+
+
+extern std::atomic<bool> TraceEnabled;
+
+inline bool trace_enabled()
+{
+    return TraceEnabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief       Starts recording the events.
+ */
+void trace_start();
+
+/**
+ * @brief       Stops recording and writes all the events recorded so far to Path. The threads
+ *              recording events must be idle.
+ */
+bool trace_write(const std::string& Path);
+
+/**
+ * @brief       Names the calling thread in the timeline.
+ */
+void trace_thread_name(const char* Name);
+
+/**
+ * @brief       Nanoseconds since the tracer was started.
+ */
+long long trace_now();
+
+/**
+ * @brief       Records an event of the calling thread. Name must be a string literal. Arg is shown
+ *              as the index of the event, unless negative.
+ */
+void trace_event(const char* Name, long long Arg, long long Start, long long End);
+
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* Name, long long Arg = -1)
+        : m_Name(NULL), m_Arg(Arg), m_Start(0)
+    {
+        if (trace_enabled())
+        {
+            m_Name = Name;
+            m_Start = trace_now();
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (m_Name != NULL)
+            trace_event(m_Name, m_Arg, m_Start, trace_now());
+    }
+
+private:
+    const char* m_Name;
+    long long m_Arg;
+    long long m_Start;
+};
+
+
+#ifdef NO_TRACING
+#define TRACE_SCOPE(...)            ((void)0)
+#else
+#define TRACE_CONCAT_(A, B)         A##B
+#define TRACE_CONCAT(A, B)          TRACE_CONCAT_(A, B)
+#define TRACE_SCOPE(...)            TraceScope TRACE_CONCAT(TraceScope_, __LINE__)(__VA_ARGS__)
+#endif
@@ -0,0 +1,59 @@
+/**
+ * @file        video_stream.hpp
+ *
+ * @brief       Streams the frames of an animation as raw video, to be piped into an encoder.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <frame_sink.hpp>
+#include <stdio.h>
+
+
+enum VideoStreamFormat
+{
+    Y4M,        // YUV4MPEG2, 4:2:0, BT.601 limited range
+    RAW_RGBA    // Headerless 8-bit RGBA, rows top-down
+};
+
+
+/**
+ * @brief       Writes the frames to the standard output, if Path is "-", or to a file or a
+ *              named pipe. Every frame is converted into a buffer allocated by open() and
+ *              written with a single call, so streaming never allocates memory.
+ */
+class VideoStreamSink : public FrameSink
+{
+public:
+    VideoStreamSink(const std::string& Path, VideoStreamFormat Format, int FPS);
+
+    bool open(int Width, int Height) override;
+    bool write_frame(const unsigned char* RGBA, long long Index) override;
+    bool close() override;
+
+private:
+    std::string m_Path;
+    VideoStreamFormat m_Format;
+    int m_FPS;
+    int m_Width;
+    int m_Height;
+    FILE* m_Stream;
+    std::vector<unsigned char> m_Frame;
+};
+
+
+/**
+ * @brief       Converts a Width x Height RGBA image into planar YUV 4:2:0 with BT.601 limited range
+ *              coefficients. Chroma is averaged over 2x2 blocks. The image has rows stored
+ *              bottom-up, while the planes are written top-down. Uses SSE2 when available.
+ *
+ * @param       Y           Luma plane, Width x Height bytes.
+ * @param       U           Blue-difference plane, ((Width + 1) / 2) x ((Height + 1) / 2) bytes.
+ * @param       V           Red-difference plane, same size of U.
+ */
+void rgba_to_yuv420(const unsigned char* RGBA, int Width, int Height,
+                    unsigned char* Y, unsigned char* U, unsigned char* V);
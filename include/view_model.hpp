@@ -0,0 +1,74 @@
+/**
+ * @file        view_model.hpp
+ *
+ * @brief       The view as a center in double-double precision and a scale, and the choice of the
+ *              cheapest shader kernel that can resolve it.
+ *
+ * @details     A view stored as its limits loses the position of the center as soon as the width
+ *              nears the precision of the limits, and the pixels computed from them collapse long
+ *              before the double math runs out. Keeping the center in double-double precision and
+ *              the half extents as plain doubles, the position of every pixel is the center plus
+ *              a small offset that doubles hold exactly enough.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <fractal.hpp>
+#include <double_double.hpp>
+
+
+struct ViewModel
+{
+    DoubleDouble CenterX;
+    DoubleDouble CenterY;
+    double HalfWidth    = 1.0;
+    double HalfHeight   = 1.0;
+};
+
+
+enum ViewPrecision
+{
+    VIEW_FP32,
+    VIEW_FP64,
+    VIEW_DOUBLE_DOUBLE,
+    VIEW_AUTO               // The cheapest of the above that resolves the view
+};
+
+
+const char* view_precision_name(ViewPrecision Precision);
+
+ViewModel view_from_params(const ParamsStruct& Params);
+
+/**
+ * @brief       Parses a decimal number, such as -0.74364388703715870475219150611477, into a
+ *              double-double, keeping about 31 significant digits.
+ */
+bool parse_view_coordinate(const char* Str, DoubleDouble& Value);
+
+/**
+ * @brief       Stores the limits of the view into Params, rounded to double.
+ */
+void view_to_params(const ViewModel& View, ParamsStruct& Params);
+
+/**
+ * @brief       Enlarges the view along one axis so that pixels are square, as fit_aspect.
+ */
+void view_fit_aspect(ViewModel& View, long long Width, long long Height);
+
+/**
+ * @brief       Whether an arithmetic with the given relative Epsilon, at the largest coordinate of
+ *              the view, is still finer than the spacing of the Width x Height pixels by a safe
+ *              margin.
+ */
+bool view_resolves(const ViewModel& View, int Width, int Height, double Epsilon);
+
+/**
+ * @brief       Chooses the cheapest kernel whose precision, at the largest coordinate of the view,
+ *              is still finer than the spacing of the Width x Height pixels by a safe margin.
+ *              Newton's fractal has no double-double kernel, so it stops at VIEW_FP64.
+ */
+ViewPrecision select_view_precision(FractalType Type, const ViewModel& View, int Width, int Height);
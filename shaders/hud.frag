@@ -0,0 +1,16 @@
+#version 440 core
+
+in vec2 fUV;
+
+out vec4 FragColor;
+
+
+uniform sampler2D Text;
+
+
+void main()
+{
+    // The text is white over a translucent black panel
+    float Glyph = texture(Text, fUV).r;
+    FragColor = mix(vec4(0.0, 0.0, 0.0, 0.6), vec4(1.0, 1.0, 1.0, 1.0), Glyph);
+}
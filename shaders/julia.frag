@@ -1,20 +1,18 @@
 #version 440 core
 
-in vec2 fPos;
+// One of KERNEL_FP32, KERNEL_FP64 and KERNEL_DD is defined by the renderer, according to the
+// precision needed by the spacing of the pixels
 
 out vec4 FragColor;
 
 
 uniform int NumIters;
-uniform dvec2 XLim;
-uniform dvec2 YLim;
+uniform dvec2 CenterX;          // Double-double: high and low part
+uniform dvec2 CenterY;
+uniform dvec2 PixelSize;
+uniform vec2 ViewportCenter;
 uniform double Angle;
 
-dvec2 csquare(dvec2 z)
-{
-    return dvec2(z.x * z.x - z.y * z.y, 2 * z.x * z.y);
-}
-
 dvec2 cmul(dvec2 z1, dvec2 z2)
 {
     return dvec2(z1.x * z2.x - z1.y * z2.y,
@@ -27,21 +25,100 @@ dvec2 cexp(dvec2 z)
     return ex * dvec2(cos(float(z.y)), sin(float(z.y)));
 }
 
+dvec2 JuliaConstant()
+{
+    dvec2 c = dvec2(0.7885, 0.0);
+    return cmul(c, cexp(dvec2(0.0, Angle)));
+}
+
 
-dvec2 UV2Cart(vec2 UV)
+// Offset of the pixel from the center of the view, exact up to a single rounding
+dvec2 PixelOffset()
 {
-    double XLen = XLim.y - XLim.x;
-    double YLen = YLim.y - YLim.x;
-    return dvec2(double(UV.x) * XLen + XLim.x,
-                 double(UV.y) * YLen + YLim.x);
+    return (dvec2(gl_FragCoord.xy) - dvec2(ViewportCenter)) * PixelSize;
 }
 
 
-int EscapeTime(vec2 UV)
+#if defined(KERNEL_FP32)
+
+int EscapeTime()
 {
-    dvec2 z = UV2Cart(UV);
-    dvec2 c = dvec2(0.7885, 0.0);
-    c = cmul(c, cexp(dvec2(0.0, Angle)));
+    vec2 z = vec2(dvec2(CenterX.x, CenterY.x) + PixelOffset());
+    vec2 c = vec2(JuliaConstant());
+    for (int i = 0; i < NumIters; ++i)
+    {
+        z = vec2(z.x * z.x - z.y * z.y, 2 * z.x * z.y) + c;
+        if (length(z) > 2)
+            return NumIters - i;
+    }
+    return 0;
+}
+
+#elif defined(KERNEL_DD)
+
+// Double-double arithmetic as in double_double.hpp, precise keeps the error-free transforms intact
+dvec2 dd_two_sum(double a, double b)
+{
+    precise double s = a + b;
+    precise double v = s - a;
+    precise double e = (a - (s - v)) + (b - v);
+    return dvec2(s, e);
+}
+
+dvec2 dd_quick_two_sum(double a, double b)
+{
+    precise double s = a + b;
+    precise double e = b - (s - a);
+    return dvec2(s, e);
+}
+
+dvec2 dd_add(dvec2 a, dvec2 b)
+{
+    precise dvec2 s = dd_two_sum(a.x, b.x);
+    precise dvec2 t = dd_two_sum(a.y, b.y);
+    s.y += t.x;
+    s = dd_quick_two_sum(s.x, s.y);
+    s.y += t.y;
+    return dd_quick_two_sum(s.x, s.y);
+}
+
+dvec2 dd_mul(dvec2 a, dvec2 b)
+{
+    precise double p = a.x * b.x;
+    precise double e = fma(a.x, b.x, -p);
+    e += a.x * b.y + a.y * b.x;
+    return dd_quick_two_sum(p, e);
+}
+
+int EscapeTime()
+{
+    dvec2 Offset = PixelOffset();
+    dvec2 zr = dd_add(CenterX, dvec2(Offset.x, 0.0));
+    dvec2 zi = dd_add(CenterY, dvec2(Offset.y, 0.0));
+    dvec2 c = JuliaConstant();
+    for (int i = 0; i < NumIters; ++i)
+    {
+        dvec2 zri = dd_mul(zr, zi);
+        zr = dd_add(dd_add(dd_mul(zr, zr), -dd_mul(zi, zi)), dvec2(c.x, 0.0));
+        zi = dd_add(2.0 * zri, dvec2(c.y, 0.0));
+        if (zr.x * zr.x + zi.x * zi.x > 4.0)
+            return NumIters - i;
+    }
+    return 0;
+}
+
+#else
+
+dvec2 csquare(dvec2 z)
+{
+    return dvec2(z.x * z.x - z.y * z.y, 2 * z.x * z.y);
+}
+
+int EscapeTime()
+{
+    // The low part of the center is added to the offset first, so that it survives
+    dvec2 z = dvec2(CenterX.x, CenterY.x) + (PixelOffset() + dvec2(CenterX.y, CenterY.y));
+    dvec2 c = JuliaConstant();
     for (int i = 0; i < NumIters; ++i)
     {
         z = csquare(z) + c;
@@ -51,12 +128,14 @@ int EscapeTime(vec2 UV)
     return 0;
 }
 
+#endif
+
 
 
 void main()
 {
-    int k = EscapeTime(fPos);
+    int k = EscapeTime();
 
     float theta = float(k) / float(NumIters);
     FragColor = vec4(theta, theta, theta, 1.0f);
-}
\ No newline at end of file
+}
@@ -1,32 +1,105 @@
 #version 440 core
 
-in vec2 fPos;
+// One of KERNEL_FP32, KERNEL_FP64 and KERNEL_DD is defined by the renderer, according to the
+// precision needed by the spacing of the pixels
 
 out vec4 FragColor;
 
 
 uniform int NumIters;
-uniform dvec2 XLim;
-uniform dvec2 YLim;
+uniform dvec2 CenterX;          // Double-double: high and low part
+uniform dvec2 CenterY;
+uniform dvec2 PixelSize;
+uniform vec2 ViewportCenter;
 
-dvec2 csquare(dvec2 z)
+
+// Offset of the pixel from the center of the view, exact up to a single rounding
+dvec2 PixelOffset()
 {
-    return dvec2(z.x * z.x - z.y * z.y, 2 * z.x * z.y);
+    return (dvec2(gl_FragCoord.xy) - dvec2(ViewportCenter)) * PixelSize;
+}
+
+
+#if defined(KERNEL_FP32)
+
+int EscapeTime()
+{
+    vec2 c = vec2(dvec2(CenterX.x, CenterY.x) + PixelOffset());
+    vec2 z = c;
+    for (int i = 0; i < NumIters; ++i)
+    {
+        z = vec2(z.x * z.x - z.y * z.y, 2 * z.x * z.y) + c;
+        if (length(z) > 2)
+            return NumIters - i;
+    }
+    return 0;
+}
+
+#elif defined(KERNEL_DD)
+
+// Double-double arithmetic as in double_double.hpp, precise keeps the error-free transforms intact
+dvec2 dd_two_sum(double a, double b)
+{
+    precise double s = a + b;
+    precise double v = s - a;
+    precise double e = (a - (s - v)) + (b - v);
+    return dvec2(s, e);
+}
+
+dvec2 dd_quick_two_sum(double a, double b)
+{
+    precise double s = a + b;
+    precise double e = b - (s - a);
+    return dvec2(s, e);
 }
 
+dvec2 dd_add(dvec2 a, dvec2 b)
+{
+    precise dvec2 s = dd_two_sum(a.x, b.x);
+    precise dvec2 t = dd_two_sum(a.y, b.y);
+    s.y += t.x;
+    s = dd_quick_two_sum(s.x, s.y);
+    s.y += t.y;
+    return dd_quick_two_sum(s.x, s.y);
+}
 
-dvec2 UV2Cart(vec2 UV)
+dvec2 dd_mul(dvec2 a, dvec2 b)
 {
-    double XLen = XLim.y - XLim.x;
-    double YLen = YLim.y - YLim.x;
-    return dvec2(double(UV.x) * XLen + XLim.x,
-                 double(UV.y) * YLen + YLim.x);
+    precise double p = a.x * b.x;
+    precise double e = fma(a.x, b.x, -p);
+    e += a.x * b.y + a.y * b.x;
+    return dd_quick_two_sum(p, e);
 }
 
+int EscapeTime()
+{
+    dvec2 Offset = PixelOffset();
+    dvec2 cr = dd_add(CenterX, dvec2(Offset.x, 0.0));
+    dvec2 ci = dd_add(CenterY, dvec2(Offset.y, 0.0));
+    dvec2 zr = cr;
+    dvec2 zi = ci;
+    for (int i = 0; i < NumIters; ++i)
+    {
+        dvec2 zri = dd_mul(zr, zi);
+        zr = dd_add(dd_add(dd_mul(zr, zr), -dd_mul(zi, zi)), cr);
+        zi = dd_add(2.0 * zri, ci);
+        if (zr.x * zr.x + zi.x * zi.x > 4.0)
+            return NumIters - i;
+    }
+    return 0;
+}
+
+#else
 
-int EscapeTime(vec2 UV)
+dvec2 csquare(dvec2 z)
 {
-    dvec2 z = UV2Cart(UV);
+    return dvec2(z.x * z.x - z.y * z.y, 2 * z.x * z.y);
+}
+
+int EscapeTime()
+{
+    // The low part of the center is added to the offset first, so that it survives
+    dvec2 z = dvec2(CenterX.x, CenterY.x) + (PixelOffset() + dvec2(CenterX.y, CenterY.y));
     dvec2 c = z;
     for (int i = 0; i < NumIters; ++i)
     {
@@ -37,12 +110,14 @@ int EscapeTime(vec2 UV)
     return 0;
 }
 
+#endif
+
 
 
 void main()
 {
-    int k = EscapeTime(fPos);
+    int k = EscapeTime();
 
     float theta = float(k) / float(NumIters);
     FragColor = vec4(theta, theta, theta, 1.0f);
-}
\ No newline at end of file
+}
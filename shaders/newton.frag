@@ -1,88 +1,147 @@
 #version 440 core
 
+// KERNEL_FP32 or KERNEL_FP64 is defined by the renderer, according to the precision needed by the
+// spacing of the pixels. The iterations converge to the roots, so double-double is never needed
 #define MAX_NUM_ROOTS 100
 
-in vec2 fPos;
+// Steps shorter than Tolerance end the iterations, as do points this close to a root or to a point
+// visited before. Single precision stops short of the digits it cannot resolve
+#if defined(KERNEL_FP32)
+#define real float
+#define cvec vec2
+const float Tolerance = 1e-4;
+#else
+#define real double
+#define cvec dvec2
+const double Tolerance = 1e-6;
+#endif
 
 out vec4 FragColor;
 
 
 uniform int NumRoots;
+// The roots of the polynomial, followed by its coefficients, lowest degree first
 layout(std140, binding = 2) uniform RootsBuf
 {
-    dvec2 Roots[MAX_NUM_ROOTS];
+    dvec2 Roots[2 * MAX_NUM_ROOTS + 1];
 };
+// Form of the polynomial used for Newton's step, as in the NewtonStep enum of fractal.hpp
+const int STEP_UNITY = 1;
+const int STEP_COEFFICIENTS = 2;
+uniform int StepForm;
 uniform int NumIters;
-uniform dvec2 XLim;
-uniform dvec2 YLim;
+uniform dvec2 CenterX;          // Double-double: high and low part
+uniform dvec2 CenterY;
+uniform dvec2 PixelSize;
+uniform vec2 ViewportCenter;
 
-dvec2 csquare(dvec2 z)
+cvec csquare(cvec z)
 {
-    return dvec2(z.x * z.x - z.y * z.y, 2 * z.x * z.y);
+    return cvec(z.x * z.x - z.y * z.y, 2 * z.x * z.y);
 }
 
-dvec2 cmul(dvec2 z1, dvec2 z2)
+cvec cmul(cvec z1, cvec z2)
 {
-    return dvec2(z1.x * z2.x - z1.y * z2.y,
-                 z1.x * z2.y + z1.y * z2.x);
+    return cvec(z1.x * z2.x - z1.y * z2.y,
+                z1.x * z2.y + z1.y * z2.x);
 }
 
-dvec2 cdiv(dvec2 z1, dvec2 z2)
+cvec cdiv(cvec z1, cvec z2)
 {
-    double den = z2.x * z2.x + z2.y * z2.y;
-    return dvec2(z1.x * z2.x + z1.y * z2.y, z1.y * z2.x - z1.x * z2.y) / den;
+    real den = z2.x * z2.x + z2.y * z2.y;
+    return cvec(z1.x * z2.x + z1.y * z2.y, z1.y * z2.x - z1.x * z2.y) / den;
 }
 
-dvec2 peval(dvec2 z)
+// p(z) / p'(z) for p = z^n - 1, with z^(n - 1) computed by squaring
+cvec unity_step(cvec z)
 {
-    dvec2 p = z - Roots[0];
-    for (int i = 1; i < NumRoots; ++i)
-        p = cmul(p, z - Roots[i]);
-    return p;
+    cvec w = cvec(1.0, 0.0);
+    cvec b = z;
+    for (int e = NumRoots - 1; e > 0; e >>= 1)
+    {
+        if ((e & 1) != 0)
+            w = cmul(w, b);
+        b = csquare(b);
+    }
+    return cdiv(cmul(w, z) - cvec(1.0, 0.0), real(NumRoots) * w);
 }
 
-dvec2 dpeval(dvec2 z)
+// p(z) / p'(z) by Horner's scheme on the coefficients, p' accumulated along with p
+cvec coefficient_step(cvec z)
 {
-    dvec2 dp = dvec2(0.0);
+    cvec p = cvec(Roots[2 * NumRoots]);
+    cvec dp = cvec(0.0);
+    for (int i = NumRoots - 1; i >= 0; --i)
+    {
+        dp = cmul(dp, z) + p;
+        p = cmul(p, z) + cvec(Roots[NumRoots + i]);
+    }
+    return cdiv(p, dp);
+}
+
+// p(z) / p'(z) = 1 / sum_i 1 / (z - r_i), or z - r_i when z is within Tolerance of r_i
+cvec root_step(cvec z)
+{
+    cvec s = cvec(0.0);
     for (int i = 0; i < NumRoots; ++i)
     {
-        dvec2 p = dvec2(1.0, 0.0);
-        for (int j = 0; j < NumRoots; ++j)
-        {
-            if (i == j) continue;
-            p = cmul(p, z - Roots[j]);
-        }
-        dp += p;
+        cvec d = z - cvec(Roots[i]);
+        real den = dot(d, d);
+        if (den < Tolerance * Tolerance)
+            return d;
+        s += cvec(d.x, -d.y) / den;
     }
-    return dp;
+    return cvec(s.x, -s.y) / dot(s, s);
 }
 
-dvec2 newton(dvec2 z)
+// Iterates until the step falls below Tolerance, or until z comes back to a point it visited, in a
+// cycle that never reaches a root. As in Brent's algorithm, the points visited are sampled at the
+// powers of two. Executed receives the iterations run
+cvec newton(cvec z, out int Executed, out bool Converged)
 {
+    cvec Saved = z;
+    Converged = false;
     for (int i = 0; i < NumIters; ++i)
-        z = z - cdiv(peval(z), dpeval(z));
+    {
+        cvec Step;
+        if (StepForm == STEP_UNITY)
+            Step = unity_step(z);
+        else if (StepForm == STEP_COEFFICIENTS)
+            Step = coefficient_step(z);
+        else
+            Step = root_step(z);
+        z -= Step;
+
+        Executed = i + 1;
+        Converged = dot(Step, Step) < Tolerance * Tolerance;
+        if (Converged || dot(z - Saved, z - Saved) < Tolerance * Tolerance)
+            return z;
+        if ((Executed & i) == 0)
+            Saved = z;
+    }
+    Executed = NumIters;
     return z;
 }
 
 
-dvec2 UV2Cart(vec2 UV)
+// The center of the view plus the offset of the pixel, the low part of the center added to the
+// offset first so that it survives
+dvec2 PixelPoint()
 {
-    double XLen = XLim.y - XLim.x;
-    double YLen = YLim.y - YLim.x;
-    return dvec2(double(UV.x) * XLen + XLim.x,
-                 double(UV.y) * YLen + YLim.x);
+    dvec2 Offset = (dvec2(gl_FragCoord.xy) - dvec2(ViewportCenter)) * PixelSize;
+    return dvec2(CenterX.x, CenterY.x) + (Offset + dvec2(CenterX.y, CenterY.y));
 }
 
 
-int FindRoot(vec2 UV)
+int FindRoot(out int Executed, out bool Converged)
 {
-    dvec2 z = UV2Cart(UV);
-    z = newton(z);
+    cvec z = cvec(PixelPoint());
+    z = newton(z, Executed, Converged);
     int n = 0;
-    double dmin = length(z - Roots[0]);
+    real dmin = length(z - cvec(Roots[0]));
     for (int i = 1; i < NumRoots; ++i)
     {
-        double d = length(z - Roots[i]);
+        real d = length(z - cvec(Roots[i]));
         if (d < dmin)
         {
             n = i;
@@ -120,10 +179,26 @@ vec4 colormap(int k)
 
 
 
+// Brightness of a point reached in Executed iterations, fading on a logarithmic scale, and black
+// for the points that never converge
+float convergence_shade(int Executed, bool Converged)
+{
+    if (!Converged)
+        return 0.0f;
+    return 1.0f - 0.8f * log(float(Executed)) / log(float(NumIters + 1));
+}
+
+
+
 void main()
 {
-    int k = FindRoot(fPos);
+    int Executed;
+    bool Converged;
+    int k = FindRoot(Executed, Converged);
     float theta = float(k) / float(NumRoots);
+#if defined(CONVERGENCE_SHADING)
+    theta *= convergence_shade(Executed, Converged);
+#endif
     FragColor = vec4(theta, theta, theta, 1.0f);
     // FragColor = colormap(k);
 }
\ No newline at end of file
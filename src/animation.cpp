@@ -0,0 +1,155 @@
+/**
+ * @file        animation.cpp
+ *
+ * @brief       Implementation of the keyframed animations.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <animation.hpp>
+#include <compute_renderer.hpp>
+#include <frame_pipeline.hpp>
+#include <tracer.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+
+
+bool load_keyframes(const std::string& Path, std::vector<Keyframe>& Keyframes)
+{
+    std::ifstream Stream(Path, std::ios::in);
+    if (!Stream.is_open())
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        return false;
+    }
+
+    Keyframes.clear();
+    std::string Line;
+    int LineNo = 0;
+    while (std::getline(Stream, Line))
+    {
+        ++LineNo;
+        size_t First = Line.find_first_not_of(" \t\r");
+        if (First == std::string::npos || Line[First] == '#')
+            continue;
+        std::stringstream ss(Line);
+        Keyframe K;
+        if (!(ss >> K.Time >> K.CenterX >> K.CenterY >> K.LogScale >> K.NIters >> K.Angle))
+        {
+            std::cerr << Path << ":" << LineNo << ": expected TIME CENTERX CENTERY LOGSCALE NITERS ANGLE." << std::endl;
+            return false;
+        }
+        if (!Keyframes.empty() && K.Time <= Keyframes.back().Time)
+        {
+            std::cerr << Path << ":" << LineNo << ": keyframe times must be increasing." << std::endl;
+            return false;
+        }
+        Keyframes.push_back(K);
+    }
+
+    if (Keyframes.empty())
+    {
+        std::cerr << Path << " does not contain any keyframe." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+ParamsStruct interpolate_keyframes(const std::vector<Keyframe>& Keyframes, double Time,
+                                   const ParamsStruct& Base, int Width, int Height)
+{
+    // Find the segment containing Time, clamping at the ends
+    size_t i = 0;
+    while (i + 2 < Keyframes.size() && Time > Keyframes[i + 1].Time)
+        ++i;
+    const Keyframe& K0 = Keyframes[i];
+    const Keyframe& K1 = Keyframes[std::min(i + 1, Keyframes.size() - 1)];
+    double t = 0.0;
+    if (K1.Time > K0.Time)
+        t = std::min(1.0, std::max(0.0, (Time - K0.Time) / (K1.Time - K0.Time)));
+
+    double CX = K0.CenterX + t * (K1.CenterX - K0.CenterX);
+    double CY = K0.CenterY + t * (K1.CenterY - K0.CenterY);
+    double HalfHeight = pow(10.0, K0.LogScale + t * (K1.LogScale - K0.LogScale));
+    double HalfWidth = HalfHeight * (double)Width / (double)Height;
+
+    ParamsStruct Params = Base;
+    Params.niters = (int)floor(K0.NIters + t * (K1.NIters - K0.NIters) + 0.5);
+    Params.angle = K0.Angle + t * (K1.Angle - K0.Angle);
+    Params.xlim[0] = CX - HalfWidth;
+    Params.xlim[1] = CX + HalfWidth;
+    Params.ylim[0] = CY - HalfHeight;
+    Params.ylim[1] = CY + HalfHeight;
+    return Params;
+}
+
+
+bool render_animation(FractalType Type, const ParamsStruct& Params, const AnimationOptions& Options,
+                      FrameSink& Sink)
+{
+    std::vector<Keyframe> Keyframes;
+    if (!load_keyframes(Options.KeyframeFile, Keyframes))
+        return false;
+    if (Options.NFrames < 1)
+    {
+        std::cerr << "The animation needs at least one frame." << std::endl;
+        return false;
+    }
+
+    ComputeRenderer Renderer;
+    if (!create_compute_renderer(Renderer, Type, Params, Options.Width, Options.Height))
+        return false;
+    FramePipeline Pipeline;
+    if (!Pipeline.create(Options.Width, Options.Height, &Sink))
+    {
+        destroy_compute_renderer(Renderer);
+        return false;
+    }
+
+    std::cout << "Rendering " << Options.NFrames << " frames of " << Options.Width << "x" << Options.Height <<
+                 " from " << Keyframes.size() << " keyframes." << std::endl;
+
+    double T0 = Keyframes.front().Time;
+    double T1 = Keyframes.back().Time;
+    bool Success = true;
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point LastReport = Start;
+    for (long long k = 0; k < Options.NFrames && Success; ++k)
+    {
+        TRACE_SCOPE("frame", k);
+        double Time = T0;
+        if (Options.NFrames > 1)
+            Time += (T1 - T0) * (double)k / (double)(Options.NFrames - 1);
+        compute_render(Renderer, interpolate_keyframes(Keyframes, Time, Params, Options.Width, Options.Height));
+        Success = Pipeline.push(Renderer.Texture);
+
+        std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<double>(Now - LastReport).count() >= 1.0)
+        {
+            double Elapsed = std::chrono::duration<double>(Now - Start).count();
+            std::cout << "Frame " << k + 1 << "/" << Options.NFrames << ", " << (k + 1) / Elapsed << " fps." << std::endl;
+            LastReport = Now;
+        }
+    }
+    Success = Pipeline.finish() && Success;
+    double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    if (Success)
+    {
+        double MPixels = (double)Options.Width * Options.Height * 1.0e-6;
+        std::cout << "Rendered " << Pipeline.frames() << " frames in " << Elapsed << " seconds: " <<
+                     Pipeline.frames() / Elapsed << " fps, " << MPixels * Pipeline.frames() / Elapsed << " MPixels/s." << std::endl;
+        std::cout << "Time spent waiting for the GPU " << Pipeline.wait_time() << " s, copying " <<
+                     Pipeline.copy_time() << " s, waiting for the encoder " << Pipeline.stall_time() <<
+                     " s, encoding " << Pipeline.encode_time() << " s." << std::endl;
+    }
+
+    destroy_compute_renderer(Renderer);
+    return Success;
+}
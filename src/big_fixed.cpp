@@ -0,0 +1,522 @@
+/**
+ * @file        big_fixed.cpp
+ *
+ * @brief       Implementation of the multi-limb fixed-point numbers.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <big_fixed.hpp>
+#include <algorithm>
+#include <ctype.h>
+#include <stdlib.h>
+#include <math.h>
+#if !defined(__SIZEOF_INT128__) && defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+
+namespace
+{
+
+/**
+ * @brief       a * b + c + d = Hi * 2^64 + the returned limb, which never overflows.
+ */
+inline uint64_t mul_add(uint64_t a, uint64_t b, uint64_t c, uint64_t d, uint64_t& Hi)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 T = (unsigned __int128)a * b + c + d;
+    Hi = (uint64_t)(T >> 64);
+    return (uint64_t)T;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t H;
+    uint64_t L = _umul128(a, b, &H);
+    H += _addcarry_u64(0, L, c, &L);
+    H += _addcarry_u64(0, L, d, &L);
+    Hi = H;
+    return L;
+#else
+    // Four 32 x 32 -> 64 bit products
+    uint64_t a0 = (uint32_t)a, a1 = a >> 32, b0 = (uint32_t)b, b1 = b >> 32;
+    uint64_t P00 = a0 * b0, P01 = a0 * b1, P10 = a1 * b0, P11 = a1 * b1;
+    uint64_t Mid = (P00 >> 32) + (uint32_t)P01 + (uint32_t)P10;
+    uint64_t L = (Mid << 32) | (uint32_t)P00;
+    uint64_t H = P11 + (P01 >> 32) + (P10 >> 32) + (Mid >> 32);
+    L += c;
+    H += L < c;
+    L += d;
+    H += L < d;
+    Hi = H;
+    return L;
+#endif
+}
+
+
+/**
+ * @brief       Out[0..n) = a + b, returning the carry out.
+ */
+inline uint64_t add_limbs(const uint64_t* a, const uint64_t* b, uint64_t* Out, int n)
+{
+    uint64_t Carry = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t S = a[i] + Carry;
+        Carry = S < Carry;
+        Out[i] = S + b[i];
+        Carry += Out[i] < S;
+    }
+    return Carry;
+}
+
+/**
+ * @brief       Out[0..n) = a - b, returning the borrow out.
+ */
+inline uint64_t sub_limbs(const uint64_t* a, const uint64_t* b, uint64_t* Out, int n)
+{
+    uint64_t Borrow = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t D = a[i] - b[i];
+        uint64_t Under = a[i] < b[i];
+        Out[i] = D - Borrow;
+        Borrow = Under | (D < Borrow);
+    }
+    return Borrow;
+}
+
+/**
+ * @brief       a[0..m) += b[0..n), with m >= n, carrying into the high limbs of a.
+ */
+inline void add_into(uint64_t* a, int m, const uint64_t* b, int n)
+{
+    uint64_t Carry = add_limbs(a, b, a, n);
+    for (int i = n; i < m && Carry != 0; ++i)
+        Carry = ++a[i] == 0;
+}
+
+/**
+ * @brief       a[0..m) -= b[0..n), with m >= n, borrowing from the high limbs of a.
+ */
+inline void sub_into(uint64_t* a, int m, const uint64_t* b, int n)
+{
+    uint64_t Borrow = sub_limbs(a, b, a, n);
+    for (int i = n; i < m && Borrow != 0; ++i)
+        Borrow = a[i]-- == 0;
+}
+
+inline void negate_limbs(uint64_t* a, int n)
+{
+    uint64_t Carry = 1;
+    for (int i = 0; i < n; ++i)
+    {
+        a[i] = ~a[i] + Carry;
+        Carry = Carry & (a[i] == 0);
+    }
+}
+
+
+/**
+ * @brief       Out[0..2n) = a * b.
+ */
+void schoolbook_mul(const uint64_t* a, const uint64_t* b, int n, uint64_t* Out)
+{
+    std::fill(Out, Out + 2 * n, 0);
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t Carry = 0;
+        for (int j = 0; j < n; ++j)
+            Out[i + j] = mul_add(a[i], b[j], Out[i + j], Carry, Carry);
+        Out[i + n] = Carry;
+    }
+}
+
+/**
+ * @brief       Out[0..2n) = a^2, from the n (n - 1) / 2 cross products, doubled, and the n
+ *              squares on the diagonal.
+ */
+void schoolbook_square(const uint64_t* a, int n, uint64_t* Out)
+{
+    std::fill(Out, Out + 2 * n, 0);
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t Carry = 0;
+        for (int j = i + 1; j < n; ++j)
+            Out[i + j] = mul_add(a[i], a[j], Out[i + j], Carry, Carry);
+        Out[i + n] = Carry;
+    }
+
+    uint64_t Top = 0;
+    for (int i = 0; i < 2 * n; ++i)
+    {
+        uint64_t Next = Out[i] >> 63;
+        Out[i] = (Out[i] << 1) | Top;
+        Top = Next;
+    }
+
+    uint64_t Carry = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t Hi;
+        Out[2 * i] = mul_add(a[i], a[i], Out[2 * i], Carry, Hi);
+        Out[2 * i + 1] += Hi;
+        Carry = Out[2 * i + 1] < Hi;
+    }
+}
+
+
+/**
+ * @brief       The limbs from n - 1 up of a * b, as schoolbook_mul but skipping the products that
+ *              only reach the lower limbs: short of the carries they would have produced, the
+ *              result is off by less than n units of limb n - 1, and costs half the products.
+ */
+void short_mul(const uint64_t* a, const uint64_t* b, int n, uint64_t* Out)
+{
+    std::fill(Out, Out + 2 * n, 0);
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t Carry = 0;
+        for (int j = std::max(n - 2 - i, 0); j < n; ++j)
+            Out[i + j] = mul_add(a[i], b[j], Out[i + j], Carry, Carry);
+        Out[i + n] = Carry;
+    }
+}
+
+/**
+ * @brief       The limbs from n - 1 up of a^2, as short_mul for schoolbook_square.
+ */
+void short_square(const uint64_t* a, int n, uint64_t* Out)
+{
+    std::fill(Out, Out + 2 * n, 0);
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t Carry = 0;
+        for (int j = std::max(n - 2 - i, i + 1); j < n; ++j)
+            Out[i + j] = mul_add(a[i], a[j], Out[i + j], Carry, Carry);
+        Out[i + n] = Carry;
+    }
+
+    uint64_t Top = 0;
+    for (int i = 0; i < 2 * n; ++i)
+    {
+        uint64_t Next = Out[i] >> 63;
+        Out[i] = (Out[i] << 1) | Top;
+        Top = Next;
+    }
+
+    uint64_t Carry = 0;
+    for (int i = std::max((n - 3) / 2, 0); i < n; ++i)
+    {
+        uint64_t Hi;
+        Out[2 * i] = mul_add(a[i], a[i], Out[2 * i], Carry, Hi);
+        Out[2 * i + 1] += Hi;
+        Carry = Out[2 * i + 1] < Hi;
+    }
+}
+
+
+/**
+ * @brief       Limbs of scratch needed by the Karatsuba products of n limbs.
+ */
+size_t karatsuba_scratch(int n)
+{
+    if (n < KaratsubaThreshold)
+        return 0;
+    int h = n - n / 2;
+    return 4 * (size_t)(h + 1) + karatsuba_scratch(h + 1);
+}
+
+/**
+ * @brief       Out[0..2n) = a * b. With the halves a = a1 B + a0 and b = b1 B + b0, the middle
+ *              term a1 b0 + a0 b1 is (a0 + a1)(b0 + b1) - a0 b0 - a1 b1: three products of half
+ *              the size instead of four.
+ */
+void karatsuba_mul(const uint64_t* a, const uint64_t* b, int n, uint64_t* Out, uint64_t* Scratch)
+{
+    if (n < KaratsubaThreshold)
+    {
+        schoolbook_mul(a, b, n, Out);
+        return;
+    }
+    int m = n / 2;
+    int h = n - m;
+    uint64_t* SA = Scratch;
+    uint64_t* SB = SA + (h + 1);
+    uint64_t* Mid = SB + (h + 1);
+    uint64_t* Next = Mid + 2 * (h + 1);
+
+    // The sums of the halves take one limb more
+    std::copy(a + m, a + n, SA);
+    SA[h] = 0;
+    add_into(SA, h + 1, a, m);
+    std::copy(b + m, b + n, SB);
+    SB[h] = 0;
+    add_into(SB, h + 1, b, m);
+    karatsuba_mul(SA, SB, h + 1, Mid, Next);
+
+    karatsuba_mul(a, b, m, Out, Next);
+    karatsuba_mul(a + m, b + m, h, Out + 2 * m, Next);
+    sub_into(Mid, 2 * (h + 1), Out, 2 * m);
+    sub_into(Mid, 2 * (h + 1), Out + 2 * m, 2 * h);
+    add_into(Out + m, 2 * n - m, Mid, 2 * (h + 1));
+}
+
+/**
+ * @brief       Out[0..2n) = a^2, as karatsuba_mul with a single operand.
+ */
+void karatsuba_square(const uint64_t* a, int n, uint64_t* Out, uint64_t* Scratch)
+{
+    if (n < KaratsubaThreshold)
+    {
+        schoolbook_square(a, n, Out);
+        return;
+    }
+    int m = n / 2;
+    int h = n - m;
+    uint64_t* SA = Scratch;
+    uint64_t* Mid = SA + (h + 1);
+    uint64_t* Next = Mid + 2 * (h + 1);
+
+    std::copy(a + m, a + n, SA);
+    SA[h] = 0;
+    add_into(SA, h + 1, a, m);
+    karatsuba_square(SA, h + 1, Mid, Next);
+
+    karatsuba_square(a, m, Out, Next);
+    karatsuba_square(a + m, h, Out + 2 * m, Next);
+    sub_into(Mid, 2 * (h + 1), Out, 2 * m);
+    sub_into(Mid, 2 * (h + 1), Out + 2 * m, 2 * h);
+    add_into(Out + m, 2 * n - m, Mid, 2 * (h + 1));
+}
+
+
+/**
+ * @brief       Copies the magnitude of a to Out, returning whether a was negative.
+ */
+bool magnitude(const std::vector<uint64_t>& a, std::vector<uint64_t>& Out)
+{
+    Out.assign(a.begin(), a.end());
+    bool Negative = (int64_t)a.back() < 0;
+    if (Negative)
+        negate_limbs(Out.data(), (int)Out.size());
+    return Negative;
+}
+
+void prepare(BigWorkspace& W, int n)
+{
+    W.Product.resize(2 * (size_t)n);
+    W.Scratch.resize(karatsuba_scratch(n));
+}
+
+}
+
+
+BigFixed::BigFixed(int Limbs)
+    : m_Limbs(std::max(Limbs, 2), 0)
+{ }
+
+
+void BigFixed::set(double Value)
+{
+    double Abs = fabs(Value);
+    double Int = floor(Abs);
+    double Frac = Abs - Int;
+    int n = limbs();
+    m_Limbs[n - 1] = (uint64_t)Int;
+    for (int i = n - 2; i >= 0; --i)
+    {
+        // Exact: Frac has at most 53 significant bits, which run out after a couple of limbs
+        Frac = ldexp(Frac, 64);
+        double Limb = floor(Frac);
+        m_Limbs[i] = (uint64_t)Limb;
+        Frac -= Limb;
+    }
+    if (Value < 0.0)
+        negate();
+}
+
+
+bool BigFixed::parse(const char* Str)
+{
+    const char* c = Str;
+    while (isspace((unsigned char)*c))
+        ++c;
+    bool Negative = *c == '-';
+    if (*c == '-' || *c == '+')
+        ++c;
+
+    // The digits, without the point, and the position of the point among them
+    std::vector<char> Digits;
+    long Point = -1;
+    for (; isdigit((unsigned char)*c) || (*c == '.' && Point < 0); ++c)
+    {
+        if (*c == '.')
+            Point = (long)Digits.size();
+        else
+            Digits.push_back(*c - '0');
+    }
+    if (Digits.empty())
+        return false;
+    if (Point < 0)
+        Point = (long)Digits.size();
+    if (*c == 'e' || *c == 'E')
+    {
+        char* End;
+        long Exponent = strtol(c + 1, &End, 10);
+        if (End == c + 1)
+            return false;
+        Point += Exponent;
+        c = End;
+    }
+    if (*c != '\0')
+        return false;
+
+    // Integer part
+    uint64_t Int = 0;
+    for (long i = 0; i < Point; ++i)
+    {
+        int d = i < (long)Digits.size() ? Digits[i] : 0;
+        if (Int > (uint64_t)(INT64_MAX - d) / 10)
+            return false;
+        Int = 10 * Int + d;
+    }
+
+    // Fractional part in base 10^9, most significant first, multiplied by 2^32 twice per limb:
+    // what overflows the point are the next bits
+    std::vector<char> Fraction(std::max(-Point, 0L), 0);
+    Fraction.insert(Fraction.end(), Digits.begin() + std::min(std::max(Point, 0L), (long)Digits.size()), Digits.end());
+    Fraction.resize((Fraction.size() + 8) / 9 * 9, 0);
+    std::vector<uint32_t> Chunks(Fraction.size() / 9, 0);
+    for (size_t i = 0; i < Fraction.size(); ++i)
+        Chunks[i / 9] = 10 * Chunks[i / 9] + Fraction[i];
+
+    int n = limbs();
+    m_Limbs[n - 1] = Int;
+    for (int l = n - 2; l >= 0; --l)
+    {
+        uint64_t Limb = 0;
+        for (int Half = 0; Half < 2; ++Half)
+        {
+            uint64_t Carry = 0;
+            for (size_t k = Chunks.size(); k-- > 0; )
+            {
+                uint64_t T = ((uint64_t)Chunks[k] << 32) + Carry;
+                Chunks[k] = (uint32_t)(T % 1000000000);
+                Carry = T / 1000000000;
+            }
+            Limb = (Limb << 32) | Carry;
+        }
+        m_Limbs[l] = Limb;
+    }
+    if (Negative)
+        negate();
+    return true;
+}
+
+
+double BigFixed::to_double() const
+{
+    // The magnitude is rounded once from its 64 most significant bits, with the bits below them
+    // folded into the last one, far below the 53 kept, so that the ties round correctly
+    std::vector<uint64_t> Mag;
+    bool Negative = magnitude(m_Limbs, Mag);
+    int n = limbs();
+    int i = n - 1;
+    while (i >= 0 && Mag[i] == 0)
+        --i;
+    if (i < 0)
+        return 0.0;
+    int Shift = 0;
+    while ((Mag[i] << Shift) >> 63 == 0)
+        ++Shift;
+    uint64_t Next = i > 0 ? Mag[i - 1] : 0;
+    uint64_t Top = Shift == 0 ? Mag[i] : (Mag[i] << Shift) | (Next >> (64 - Shift));
+    bool Sticky = (Next << Shift) != 0;
+    for (int j = i - 2; j >= 0 && !Sticky; --j)
+        Sticky = Mag[j] != 0;
+    double Value = ldexp((double)(Top | (Sticky ? 1 : 0)), 64 * (i - (n - 1)) - Shift);
+    return Negative ? -Value : Value;
+}
+
+
+void BigFixed::negate()
+{
+    negate_limbs(m_Limbs.data(), limbs());
+}
+
+
+void BigFixed::add(const BigFixed& a, const BigFixed& b)
+{
+    add_limbs(a.m_Limbs.data(), b.m_Limbs.data(), m_Limbs.data(), limbs());
+}
+
+
+void BigFixed::sub(const BigFixed& a, const BigFixed& b)
+{
+    sub_limbs(a.m_Limbs.data(), b.m_Limbs.data(), m_Limbs.data(), limbs());
+}
+
+
+void BigFixed::mul(const BigFixed& a, const BigFixed& b, BigWorkspace& W)
+{
+    int n = limbs();
+    prepare(W, n);
+    bool Negative = magnitude(a.m_Limbs, W.A) != magnitude(b.m_Limbs, W.B);
+    if (n < ShortProductThreshold)
+        short_mul(W.A.data(), W.B.data(), n, W.Product.data());
+    else
+        karatsuba_mul(W.A.data(), W.B.data(), n, W.Product.data(), W.Scratch.data());
+    // The product has 2 (n - 1) fractional limbs, the n - 1 lowest are truncated
+    std::copy(W.Product.begin() + (n - 1), W.Product.begin() + (2 * n - 1), m_Limbs.begin());
+    if (Negative)
+        negate();
+}
+
+
+void BigFixed::square(const BigFixed& a, BigWorkspace& W)
+{
+    int n = limbs();
+    prepare(W, n);
+    magnitude(a.m_Limbs, W.A);
+    if (n < ShortProductThreshold)
+        short_square(W.A.data(), n, W.Product.data());
+    else
+        karatsuba_square(W.A.data(), n, W.Product.data(), W.Scratch.data());
+    std::copy(W.Product.begin() + (n - 1), W.Product.begin() + (2 * n - 1), m_Limbs.begin());
+}
+
+
+BigComplex::BigComplex(int Limbs)
+    : Re(Limbs), Im(Limbs), m_X2(Limbs), m_Y2(Limbs), m_S(Limbs)
+{ }
+
+
+void BigComplex::square_add(const BigComplex& c, BigWorkspace& W)
+{
+    m_X2.square(Re, W);
+    m_Y2.square(Im, W);
+    m_S.add(Re, Im);
+    m_S.square(m_S, W);
+
+    Re.sub(m_X2, m_Y2);
+    Re.add(Re, c.Re);
+    Im.sub(m_S, m_X2);
+    Im.sub(Im, m_Y2);
+    Im.add(Im, c.Im);
+}
+
+
+double BigComplex::norm() const
+{
+    double x = Re.to_double();
+    double y = Im.to_double();
+    return x * x + y * y;
+}
+
+
+int big_fixed_limbs(double Log10Scale)
+{
+    double Bits = -Log10Scale * log2(10.0) + 64.0;
+    return 1 + std::max(1, (int)ceil(Bits / 64.0));
+}
@@ -0,0 +1,363 @@
+/**
+ * @file        compute_renderer.cpp
+ *
+ * @brief       Implementation of the compute shader renderer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <compute_renderer.hpp>
+#include <stage_timer.hpp>
+#include <tracer.hpp>
+#include <gl_utils.hpp>
+#include <memory_tracker.hpp>
+#include <metrics.hpp>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+// Views within |x|, |y| < FixedRange are rendered by the fixed-point kernels, whose range is [-8, 8)
+const double FixedRange = 7.0;
+// Size and iterations of the field rendered to compare the arithmetics
+const int MeasureSize = 256;
+const int MeasureIters = 256;
+
+static const char* ComputeArithmeticNames[] = { "auto", "fp64", "int64" };
+
+// The arithmetic set by the user, and the faster one on this device, once measured
+static ComputeArithmetic PreferredArithmetic = ComputeArithmetic::COMPUTE_AUTO;
+static ComputeArithmetic MeasuredArithmetic = ComputeArithmetic::COMPUTE_AUTO;
+
+
+const char* compute_arithmetic_name(ComputeArithmetic Arithmetic)
+{
+    return ComputeArithmeticNames[Arithmetic];
+}
+
+
+bool compute_int64_supported()
+{
+    GLint Count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &Count);
+    for (GLint i = 0; i < Count; ++i)
+    {
+        const char* Name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (Name != NULL && strcmp(Name, "GL_ARB_gpu_shader_int64") == 0)
+            return true;
+    }
+    return false;
+}
+
+
+void set_compute_arithmetic(ComputeArithmetic Arithmetic)
+{
+    PreferredArithmetic = Arithmetic;
+}
+
+
+GLuint create_roots_buffer(int NRoots)
+{
+    double* Roots = (double*)malloc((2 * NRoots + 1) * 2 * sizeof(double));
+    if (Roots == NULL)
+        return 0;
+    newton_roots(NRoots, Roots);
+    newton_coefficients(NRoots, Roots, Roots + 2 * NRoots);
+    GLuint RootsBuf;
+    glGenBuffers(1, &RootsBuf);
+    glBindBuffer(GL_UNIFORM_BUFFER, RootsBuf);
+    glBufferData(GL_UNIFORM_BUFFER, (2 * NRoots + 1) * 2 * sizeof(double), Roots, GL_STATIC_READ);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    free(Roots);
+    return RootsBuf;
+}
+
+
+NewtonStep roots_buffer_step(int NRoots)
+{
+    std::vector<double> Roots(2 * (size_t)std::max(NRoots, 1));
+    newton_roots(NRoots, Roots.data());
+    return newton_step(NRoots, Roots.data());
+}
+
+
+static bool create_renderer(ComputeRenderer& Renderer, FractalType Type, const ParamsStruct& Params,
+                            int Width, int Height, GLuint RootsBuf, GLenum Format, const std::string& Defines,
+                            ComputeArithmetic Arithmetic)
+{
+    if (Arithmetic == ComputeArithmetic::COMPUTE_AUTO)
+        Arithmetic = compute_arithmetic(Type);
+    Renderer.Type = Type;
+    Renderer.Width = Width;
+    Renderer.Height = Height;
+    Renderer.Format = Format;
+
+    // Compile the fixed-point shader for the views it can render, and the double one for the others
+    if (Arithmetic == ComputeArithmetic::COMPUTE_INT64 && Type != FractalType::NEWTON)
+    {
+        if (!compute_int64_supported())
+        {
+            std::cerr << "The fixed-point kernels need GL_ARB_gpu_shader_int64, which the driver does not support." << std::endl;
+            return false;
+        }
+        Renderer.FixedProgram = build_compute_program(compute_shader_path(Type), Defines + "#define KERNEL_INT64\n");
+        if (Renderer.FixedProgram == 0)
+        {
+            destroy_compute_renderer(Renderer);
+            return false;
+        }
+    }
+    Renderer.Program = build_compute_program(compute_shader_path(Type), Defines);
+    if (Renderer.Program == 0)
+    {
+        if (Renderer.FixedProgram == 0)
+        {
+            destroy_compute_renderer(Renderer);
+            return false;
+        }
+        // A driver without doubles still renders the views within the fixed-point range
+        std::cerr << "The double kernel is not available, views reaching past |x|, |y| < " << FixedRange <<
+                     " will not be rendered." << std::endl;
+    }
+
+    // Account for the texture and the parameters before allocating them
+    size_t Bytes = (size_t)Width * Height * (Format == GL_R32UI ? 4 : 16) + sizeof(Params);
+    if (!memory_tracker().reserve(MEM_TEXTURES, Bytes))
+    {
+        std::cerr << "A " << Width << "x" << Height << " texture would exceed the memory budget." << std::endl;
+        destroy_compute_renderer(Renderer);
+        return false;
+    }
+    Renderer.Bytes = Bytes;
+
+    // Create the texture
+    glGenTextures(1, &Renderer.Texture);
+    glBindTexture(GL_TEXTURE_2D, Renderer.Texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    if (Format == GL_R32UI)
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, Width, Height, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+    else
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, Width, Height, 0, GL_RGBA, GL_FLOAT, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    if (glGetError() != GL_NO_ERROR)
+    {
+        std::cerr << "Cannot allocate a " << Width << "x" << Height << " texture." << std::endl;
+        destroy_compute_renderer(Renderer);
+        return false;
+    }
+
+    // Send the compute buffers
+    glGenBuffers(1, &Renderer.ParamsBuf);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, Renderer.ParamsBuf);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Params), &Params, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    if (Type == FractalType::NEWTON)
+    {
+        Renderer.RootsBuf = RootsBuf;
+        if (Renderer.RootsBuf == 0)
+        {
+            Renderer.RootsBuf = create_roots_buffer(Params.nroots);
+            Renderer.OwnsRootsBuf = true;
+        }
+        Renderer.Step = roots_buffer_step(Params.nroots);
+    }
+
+    return true;
+}
+
+
+bool create_compute_renderer(ComputeRenderer& Renderer, FractalType Type, const ParamsStruct& Params,
+                             int Width, int Height, GLuint RootsBuf, ComputeArithmetic Arithmetic)
+{
+    const char* Defines = Type == FractalType::NEWTON && newton_shading() ? "#define CONVERGENCE_SHADING\n" : "";
+    return create_renderer(Renderer, Type, Params, Width, Height, RootsBuf, GL_RGBA32F, Defines, Arithmetic);
+}
+
+
+bool create_field_renderer(ComputeRenderer& Renderer, FractalType Type, const ParamsStruct& Params,
+                           int Width, int Height, GLuint RootsBuf, ComputeArithmetic Arithmetic)
+{
+    return create_renderer(Renderer, Type, Params, Width, Height, RootsBuf, GL_R32UI, "#define ITERATION_FIELD\n",
+                           Arithmetic);
+}
+
+
+bool create_cost_renderer(ComputeRenderer& Renderer, FractalType Type, const ParamsStruct& Params,
+                          int Width, int Height, GLuint RootsBuf, ComputeArithmetic Arithmetic)
+{
+    return create_renderer(Renderer, Type, Params, Width, Height, RootsBuf, GL_R32UI,
+                           "#define ITERATION_FIELD\n#define ITERATION_COST\n", Arithmetic);
+}
+
+
+static int64_t to_fixed(double Value)
+{
+    return (int64_t)llround(ldexp(Value, 60));
+}
+
+/**
+ * @brief       Sets a uvec4 uniform to the Q4.60 pair (X, Y), as the low and high half of each.
+ */
+static void set_fixed_uniform(GLuint Program, const char* Name, double X, double Y)
+{
+    uint64_t FX = (uint64_t)to_fixed(X);
+    uint64_t FY = (uint64_t)to_fixed(Y);
+    glUniform4ui(glGetUniformLocation(Program, Name), (GLuint)(FX & 0xFFFFFFFFu), (GLuint)(FX >> 32),
+                 (GLuint)(FY & 0xFFFFFFFFu), (GLuint)(FY >> 32));
+}
+
+/**
+ * @brief       Sends the parameters and dispatches the kernel, the fixed-point one if the renderer
+ *              has it and the view is within its range. Without the double kernel, the views out
+ *              of range are skipped.
+ */
+static void dispatch(ComputeRenderer& Renderer, const ParamsStruct& Params)
+{
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, Renderer.ParamsBuf);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(Params), &Params);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    double Extent = std::max(std::max(fabs(Params.xlim[0]), fabs(Params.xlim[1])),
+                             std::max(fabs(Params.ylim[0]), fabs(Params.ylim[1])));
+    bool Fixed = Renderer.FixedProgram != 0 && Extent < FixedRange;
+    if (!Fixed && Renderer.Program == 0)
+        return;
+    if (Fixed)
+    {
+        glUseProgram(Renderer.FixedProgram);
+        set_fixed_uniform(Renderer.FixedProgram, "FixedOrigin", Params.xlim[0], Params.ylim[0]);
+        set_fixed_uniform(Renderer.FixedProgram, "FixedStep", (Params.xlim[1] - Params.xlim[0]) / Renderer.Width,
+                          (Params.ylim[1] - Params.ylim[0]) / Renderer.Height);
+        if (Renderer.Type == FractalType::JULIA)
+        {
+            double Re, Im;
+            julia_constant(Params.angle, Re, Im);
+            set_fixed_uniform(Renderer.FixedProgram, "FixedC", Re, Im);
+        }
+    }
+    else
+        glUseProgram(Renderer.Program);
+    if (Renderer.Type == FractalType::NEWTON)
+        glUniform1i(glGetUniformLocation(Renderer.Program, "StepForm"), (GLint)Renderer.Step);
+    glBindImageTexture(0, Renderer.Texture, 0, GL_FALSE, 0, GL_READ_WRITE, Renderer.Format);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, Renderer.ParamsBuf);
+    if (Renderer.RootsBuf != 0)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, Renderer.RootsBuf);
+    glDispatchCompute((Renderer.Width + 31) / 32, (Renderer.Height + 31) / 32, 1);
+}
+
+
+/**
+ * @brief       Times a field of Mandelbrot's set with both arithmetics and returns the faster.
+ */
+static ComputeArithmetic measure_arithmetic()
+{
+    if (!compute_int64_supported())
+        return ComputeArithmetic::COMPUTE_FP64;
+    ParamsStruct Params;
+    Params.niters = MeasureIters;
+    Params.xlim[0] = -2.0;
+    Params.xlim[1] = 1.0;
+    Params.ylim[0] = -1.5;
+    Params.ylim[1] = 1.5;
+
+    const ComputeArithmetic Candidates[2] = { ComputeArithmetic::COMPUTE_FP64, ComputeArithmetic::COMPUTE_INT64 };
+    double Ms[2];
+    for (int c = 0; c < 2; ++c)
+    {
+        // Either kernel failing leaves the other one
+        ComputeRenderer Renderer;
+        if (!create_renderer(Renderer, FractalType::MANDELBROT, Params, MeasureSize, MeasureSize, 0, GL_R32UI,
+                             "#define ITERATION_FIELD\n", Candidates[c]))
+            return Candidates[1 - c];
+        // The first dispatch pays for the lazy work of the driver. Timed on the host, as software
+        // renderers have no GPU timer
+        dispatch(Renderer, Params);
+        glFinish();
+        std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+        dispatch(Renderer, Params);
+        glFinish();
+        Ms[c] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+        destroy_compute_renderer(Renderer);
+    }
+
+    ComputeArithmetic Faster = Ms[1] < Ms[0] ? ComputeArithmetic::COMPUTE_INT64 : ComputeArithmetic::COMPUTE_FP64;
+    // On the standard error, the standard output can carry the results of the benchmark
+    std::cerr << "Compute kernels in " << compute_arithmetic_name(Faster) << ": " << Ms[0] << " ms in fp64, "
+              << Ms[1] << " ms in int64." << std::endl;
+    return Faster;
+}
+
+
+ComputeArithmetic compute_arithmetic(FractalType Type)
+{
+    if (Type == FractalType::NEWTON)
+        return ComputeArithmetic::COMPUTE_FP64;
+    if (PreferredArithmetic != ComputeArithmetic::COMPUTE_AUTO)
+        return PreferredArithmetic;
+    if (MeasuredArithmetic == ComputeArithmetic::COMPUTE_AUTO)
+        MeasuredArithmetic = measure_arithmetic();
+    return MeasuredArithmetic;
+}
+
+
+void compute_render(ComputeRenderer& Renderer, const ParamsStruct& Params)
+{
+    TRACE_SCOPE("dispatch");
+    stage_timer().begin_gpu(STAGE_COMPUTE, (double)Renderer.Width * Renderer.Height * Params.niters);
+    dispatch(Renderer, Params);
+    stage_timer().end_gpu(STAGE_COMPUTE);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    metrics().add(METRIC_PIXELS, (double)Renderer.Width * Renderer.Height);
+    metrics().add(METRIC_ITERATIONS, (double)Renderer.Width * Renderer.Height * Params.niters);
+}
+
+
+void compute_readback_rgb(ComputeRenderer& Renderer, unsigned char* RGB)
+{
+    CPUStageScope Scope(STAGE_READBACK);
+    TRACE_SCOPE("readback");
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, Renderer.Texture);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, RGB);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+void compute_readback_field(ComputeRenderer& Renderer, uint32_t* Values)
+{
+    CPUStageScope Scope(STAGE_READBACK);
+    TRACE_SCOPE("readback");
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, Renderer.Texture);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, Values);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+void destroy_compute_renderer(ComputeRenderer& Renderer)
+{
+    if (Renderer.Bytes > 0)
+        memory_tracker().release(MEM_TEXTURES, Renderer.Bytes);
+    if (Renderer.Program != 0)
+        glDeleteProgram(Renderer.Program);
+    if (Renderer.FixedProgram != 0)
+        glDeleteProgram(Renderer.FixedProgram);
+    if (Renderer.Texture != 0)
+        glDeleteTextures(1, &Renderer.Texture);
+    if (Renderer.ParamsBuf != 0)
+        glDeleteBuffers(1, &Renderer.ParamsBuf);
+    if (Renderer.OwnsRootsBuf && Renderer.RootsBuf != 0)
+        glDeleteBuffers(1, &Renderer.RootsBuf);
+    Renderer = ComputeRenderer();
+}
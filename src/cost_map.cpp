@@ -0,0 +1,270 @@
+/**
+ * @file        cost_map.cpp
+ *
+ * @brief       Implementation of the iteration cost maps.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <cost_map.hpp>
+#include <compute_renderer.hpp>
+#include <memory_tracker.hpp>
+#include <metrics.hpp>
+#include <tracer.hpp>
+#include <npy_file.hpp>
+#include <stb_image_write.h>
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+
+struct TileCost
+{
+    long long X0, Y0;
+    int Width, Height;          // Clipped to the image
+    double GPUMs;
+    double Iterations;
+    long long Unfinished;
+};
+
+
+static bool write_npy(const std::string& Path, const std::vector<uint32_t>& Costs, long long Width, long long Height)
+{
+    FILE* Stream = npy_create(Path, "<u4", { Height, Width });
+    if (Stream == NULL)
+        return false;
+    bool Success = true;
+    for (uint32_t C : Costs)
+    {
+        if (!Success)
+            break;
+        uint32_t V = C & ~CostUnfinished;
+        Success = fwrite(&V, sizeof(V), 1, Stream) == 1;
+    }
+    Success = fclose(Stream) == 0 && Success;
+    if (!Success)
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+    return Success;
+}
+
+
+static bool write_pixels_csv(const std::string& Path, const std::vector<uint32_t>& Costs, long long Width, long long Height)
+{
+    FILE* Stream = fopen(Path.c_str(), "w");
+    if (Stream == NULL)
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        return false;
+    }
+    bool Success = fprintf(Stream, "x,y,iterations,unfinished\n") > 0;
+    for (long long y = 0; y < Height && Success; ++y)
+    {
+        for (long long x = 0; x < Width && Success; ++x)
+        {
+            uint32_t C = Costs[(size_t)(y * Width + x)];
+            Success = fprintf(Stream, "%lld,%lld,%u,%d\n", x, y, C & ~CostUnfinished, (C & CostUnfinished) ? 1 : 0) > 0;
+        }
+    }
+    Success = fclose(Stream) == 0 && Success;
+    if (!Success)
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+    return Success;
+}
+
+
+static bool write_tiles_csv(const std::string& Path, const std::vector<TileCost>& Tiles)
+{
+    FILE* Stream = fopen(Path.c_str(), "w");
+    if (Stream == NULL)
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        return false;
+    }
+    bool Success = fprintf(Stream, "x0,y0,width,height,gpu_ms,iterations,mean_iterations,unfinished_fraction\n") > 0;
+    for (const TileCost& T : Tiles)
+    {
+        if (!Success)
+            break;
+        double Pixels = (double)T.Width * T.Height;
+        Success = fprintf(Stream, "%lld,%lld,%d,%d,%.6f,%.0f,%.3f,%.6f\n", T.X0, T.Y0, T.Width, T.Height, T.GPUMs,
+                          T.Iterations, T.Iterations / Pixels, (double)T.Unfinished / Pixels) > 0;
+    }
+    Success = fclose(Stream) == 0 && Success;
+    if (!Success)
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+    return Success;
+}
+
+
+static bool write_heatmap(const std::string& Path, const std::vector<uint32_t>& Costs, long long Width, long long Height,
+                          uint32_t MaxCost)
+{
+    TRACE_SCOPE("encode_png");
+    MemoryReservation RGBBytes;
+    if (!RGBBytes.reserve(MEM_IMAGES, Costs.size() * 3, "the heatmap"))
+        return false;
+    std::vector<unsigned char> RGB(Costs.size() * 3);
+    double Scale = 1.0 / log1p((double)std::max(MaxCost, 1u));
+    for (size_t p = 0; p < Costs.size(); ++p)
+    {
+        if (Costs[p] & CostUnfinished)
+            RGB[3 * p] = RGB[3 * p + 1] = RGB[3 * p + 2] = 0;
+        else
+            colormap(log1p((double)Costs[p]) * Scale, &RGB[3 * p]);
+    }
+    if (!stbi_write_png(Path.c_str(), (int)Width, (int)Height, 3, RGB.data(), (int)(3 * Width)))
+    {
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool cost_map_export(FractalType Type, const ParamsStruct& Params, const CostMapOptions& Options)
+{
+    if (Options.Width < 1 || Options.Height < 1 || Options.Width > INT32_MAX || Options.Height > INT32_MAX)
+    {
+        std::cerr << "Invalid cost map size." << std::endl;
+        return false;
+    }
+    GLint MaxTexSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &MaxTexSize);
+    int TileSize = std::min(Options.TileSize, (int)MaxTexSize);
+
+    // The whole map is held in memory, the tiles shrink to fit in what is left of the budget
+    MemoryReservation CostBytes;
+    if (!CostBytes.reserve(MEM_IMAGES, (size_t)Options.Width * Options.Height * sizeof(uint32_t), "the cost map"))
+        return false;
+    TileSize = fit_tile_size(TileSize, 4 + 4);
+    if (TileSize == 0)
+    {
+        std::cerr << "Not even the smallest tile fits in the memory budget." << std::endl;
+        return false;
+    }
+    MemoryReservation TileBytes;
+    if (!TileBytes.reserve(MEM_STAGING, (size_t)TileSize * TileSize * sizeof(uint32_t), "the tile buffer"))
+        return false;
+
+    std::vector<uint32_t> Costs;
+    std::vector<uint32_t> Tile;
+    try
+    {
+        Costs.resize((size_t)Options.Width * Options.Height);
+        Tile.resize((size_t)TileSize * TileSize);
+    }
+    catch (const std::bad_alloc&)
+    {
+        std::cerr << "Cannot allocate the cost map." << std::endl;
+        return false;
+    }
+
+    ComputeRenderer Renderer;
+    if (!create_cost_renderer(Renderer, Type, Params, TileSize, TileSize))
+        return false;
+    GLuint Queries[2];
+    glGenQueries(2, Queries);
+
+    long long NTilesX = (Options.Width + TileSize - 1) / TileSize;
+    long long NTilesY = (Options.Height + TileSize - 1) / TileSize;
+    std::cout << "Measuring the cost of " << NTilesX * NTilesY << " tiles of " << TileSize << "x" << TileSize << "." << std::endl;
+
+    // The first dispatch also pays for the compilation of the shader by the driver
+    compute_render(Renderer, tile_params(Params, Options.Width, Options.Height, 0, 0, TileSize));
+    glFinish();
+
+    std::vector<TileCost> Tiles;
+    for (long long ty = 0; ty < NTilesY; ++ty)
+    {
+        for (long long tx = 0; tx < NTilesX; ++tx)
+        {
+            TRACE_SCOPE("tile", ty * NTilesX + tx);
+            TileCost T;
+            T.X0 = tx * TileSize;
+            T.Y0 = ty * TileSize;
+            T.Width = (int)std::min((long long)TileSize, Options.Width - T.X0);
+            T.Height = (int)std::min((long long)TileSize, Options.Height - T.Y0);
+
+            // Timestamps do not interfere with the GL_TIME_ELAPSED queries of the stage timer
+            glQueryCounter(Queries[0], GL_TIMESTAMP);
+            compute_render(Renderer, tile_params(Params, Options.Width, Options.Height, T.X0, T.Y0, TileSize));
+            glQueryCounter(Queries[1], GL_TIMESTAMP);
+            compute_readback_field(Renderer, Tile.data());
+            GLuint64 Begin, End;
+            glGetQueryObjectui64v(Queries[0], GL_QUERY_RESULT, &Begin);
+            glGetQueryObjectui64v(Queries[1], GL_QUERY_RESULT, &End);
+            T.GPUMs = (double)(End - Begin) * 1e-6;
+
+            // The texture is bottom-up, the tile starts TileSize rows above its bottom edge
+            T.Iterations = 0.0;
+            T.Unfinished = 0;
+            for (int i = 0; i < T.Height; ++i)
+            {
+                const uint32_t* Src = Tile.data() + (size_t)(TileSize - 1 - i) * TileSize;
+                uint32_t* Dst = Costs.data() + (size_t)(T.Y0 + i) * Options.Width + T.X0;
+                memcpy(Dst, Src, T.Width * sizeof(uint32_t));
+                for (int j = 0; j < T.Width; ++j)
+                {
+                    T.Iterations += (double)(Src[j] & ~CostUnfinished);
+                    T.Unfinished += (Src[j] & CostUnfinished) ? 1 : 0;
+                }
+            }
+            Tiles.push_back(T);
+            metrics().add(METRIC_TILES);
+        }
+    }
+    glDeleteQueries(2, Queries);
+    destroy_compute_renderer(Renderer);
+
+
+    // Summary
+    double Iterations = 0.0, GPUMs = 0.0;
+    long long Unfinished = 0;
+    for (const TileCost& T : Tiles)
+    {
+        Iterations += T.Iterations;
+        GPUMs += T.GPUMs;
+        Unfinished += T.Unfinished;
+    }
+    uint32_t MaxCost = 0;
+    for (uint32_t C : Costs)
+        MaxCost = std::max(MaxCost, C & ~CostUnfinished);
+    double Pixels = (double)Options.Width * Options.Height;
+
+    std::vector<size_t> Order(Tiles.size());
+    std::iota(Order.begin(), Order.end(), 0);
+    std::sort(Order.begin(), Order.end(), [&](size_t a, size_t b) { return Tiles[a].GPUMs > Tiles[b].GPUMs; });
+    size_t NHot = std::max(Tiles.size() / 10, (size_t)1);
+    double HotMs = 0.0;
+    for (size_t i = 0; i < NHot; ++i)
+        HotMs += Tiles[Order[i]].GPUMs;
+    const TileCost& Hottest = Tiles[Order[0]];
+    double Share = GPUMs > 0.0 ? 100.0 / GPUMs : 0.0;
+
+    std::cout << "Iterations per pixel: mean " << Iterations / Pixels << ", max " << MaxCost
+              << " of " << Params.niters << "." << std::endl;
+    std::cout << (Type == FractalType::NEWTON ? "Pixels not converging: " : "Interior pixels: ")
+              << 100.0 * Unfinished / Pixels << "%." << std::endl;
+    std::cout << "GPU time: " << GPUMs << " ms, " << Iterations / std::max(GPUMs * 1e6, 1e-9) << " Giter/s." << std::endl;
+    std::cout << "Hottest tile at (" << Hottest.X0 << ", " << Hottest.Y0 << "): " << Hottest.GPUMs << " ms, "
+              << Hottest.GPUMs * Share << "% of the time. The hottest " << NHot << " tiles take "
+              << HotMs * Share << "% of the time." << std::endl;
+
+
+    bool Success = write_heatmap(Options.Output + ".png", Costs, Options.Width, Options.Height, MaxCost);
+    if (Options.Format == CostMapFormat::COST_CSV)
+        Success = write_pixels_csv(Options.Output + ".csv", Costs, Options.Width, Options.Height) && Success;
+    else
+        Success = write_npy(Options.Output + ".npy", Costs, Options.Width, Options.Height) && Success;
+    Success = write_tiles_csv(Options.Output + "_tiles.csv", Tiles) && Success;
+    if (Success)
+        std::cout << "Cost map written to " << Options.Output << ".png." << std::endl;
+    return Success;
+}
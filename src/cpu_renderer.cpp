@@ -0,0 +1,546 @@
+/**
+ * @file        cpu_renderer.cpp
+ *
+ * @brief       Implementation of the CPU renderer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <cpu_renderer.hpp>
+#include <tracer.hpp>
+#include <double_double.hpp>
+#include <quad_double.hpp>
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <math.h>
+
+
+namespace
+{
+
+/**
+ * @brief       Calls Body on every row, from a pool of threads taking the rows one at a time.
+ *              If Phases is not NULL, records the time and the counters of every thread.
+ */
+void parallel_rows(const char* Name, int Width, int Height, const CPURenderOptions& Options,
+                   std::vector<PerfPhase>* Phases, const std::function<void(int)>& Body)
+{
+    int NThreads = Options.Threads > 0 ? Options.Threads : (int)std::thread::hardware_concurrency();
+    NThreads = std::max(1, std::min(NThreads, Height));
+
+    PerfPhase Phase;
+    Phase.Name = Name;
+    Phase.Pixels = (long long)Width * Height;
+    Phase.Threads.resize(NThreads);
+    Phase.ThreadSeconds.resize(NThreads);
+    Phase.ThreadPixels.resize(NThreads);
+
+    std::atomic<int> NextRow(0);
+    auto Worker = [&](int t) {
+        TRACE_SCOPE(Name, t);
+        PerfCounters Counters;
+        bool Counting = Phases != NULL && Options.Counters && Counters.open();
+        std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+        if (Counting)
+            Counters.start();
+        long long Rows = 0;
+        for (int Row = NextRow++; Row < Height; Row = NextRow++)
+        {
+            Body(Row);
+            ++Rows;
+        }
+        if (Counting)
+            Phase.Threads[t] = Counters.stop();
+        Phase.ThreadSeconds[t] = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+        Phase.ThreadPixels[t] = Rows * Width;
+    };
+
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    std::vector<std::thread> Workers;
+    for (int t = 1; t < NThreads; ++t)
+        Workers.emplace_back(Worker, t);
+    Worker(0);
+    for (std::thread& W : Workers)
+        W.join();
+    Phase.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    if (Phases != NULL)
+        Phases->push_back(Phase);
+}
+
+
+const char* const CPUPrecisionNames[] = { "fp32", "fp64", "dd", "qd", "auto" };
+
+// Units in the last place relative to the value, for every precision but CPU_AUTO
+const double CPUPrecisionEpsilon[] = { 0x1p-24, 0x1p-53, 0x1p-104, 0x1p-209 };
+
+
+/**
+ * @brief       Escape-time iterations of Mandelbrot's and Julia's sets over a row, whose points
+ *              have coordinates X and Y. Out receives the iteration at which every point escapes,
+ *              0 if it never does.
+ */
+template <typename Real>
+void escape_row(const ParamsStruct& Params, bool Julia, double CRe, double CIm, const DoubleDouble* X,
+                const DoubleDouble& Y, int Width, uint32_t* Out)
+{
+    constexpr int L = 64 / sizeof(Real);
+    const Real Bailout = (Real)4;
+    for (int j0 = 0; j0 < Width; j0 += L)
+    {
+        alignas(64) Real ZRe[L], ZIm[L], CR[L], CI[L];
+        alignas(64) uint32_t Escape[L];
+        for (int l = 0; l < L; ++l)
+        {
+            ZRe[l] = (Real)X[std::min(j0 + l, Width - 1)];
+            ZIm[l] = (Real)Y;
+            CR[l] = Julia ? (Real)CRe : ZRe[l];
+            CI[l] = Julia ? (Real)CIm : ZIm[l];
+            Escape[l] = 0;
+        }
+        // Lanes past the end of the row are masked out with an impossible iteration
+        for (int l = std::max(Width - j0, 0); l < L; ++l)
+            Escape[l] = UINT32_MAX;
+
+        for (int i = 0; i < Params.niters; ++i)
+        {
+            int Live = 0;
+            for (int l = 0; l < L; ++l)
+            {
+                Real Re = ZRe[l] * ZRe[l] - ZIm[l] * ZIm[l] + CR[l];
+                Real Im = (Real)2 * ZRe[l] * ZIm[l] + CI[l];
+                // Bitwise operators keep the loop free of branches
+                bool Alive = Escape[l] == 0;
+                bool Escaped = Alive & (Re * Re + Im * Im > Bailout);
+                ZRe[l] = Alive ? Re : ZRe[l];
+                ZIm[l] = Alive ? Im : ZIm[l];
+                Escape[l] = Escaped ? (uint32_t)(i + 1) : Escape[l];
+                Live += Alive & !Escaped;
+            }
+            if (Live == 0)
+                break;
+        }
+
+        for (int l = 0; l < L && j0 + l < Width; ++l)
+            Out[j0 + l] = Escape[l];
+    }
+}
+
+
+/**
+ * @brief       The components of the extended precisions, stored by the kernels in one array each.
+ */
+template <typename Real>
+struct Components;
+
+template <>
+struct Components<DoubleDouble>
+{
+    static constexpr int Count = 2;
+    static double& get(DoubleDouble& v, int k) { return k == 0 ? v.Hi : v.Lo; }
+};
+
+template <>
+struct Components<QuadDouble>
+{
+    static constexpr int Count = 4;
+    static double& get(QuadDouble& v, int k) { return v.X[k]; }
+};
+
+
+/**
+ * @brief       escape_row for the double-double and quad-double precisions. Every component of
+ *              the lanes has its own array, so that the compiler turns the error-free transforms
+ *              of the lanes into vector FMAs. The real part is computed as (x + y)(x - y), one
+ *              product less than x^2 - y^2, and the bailout only looks at the leading components.
+ *              Escaped lanes keep iterating into infinities and NaNs, harmless to the vectors:
+ *              freezing them would put branches around floating-point operations, which the
+ *              compiler does not turn into blends.
+ */
+template <typename Real>
+void escape_row_extended(const ParamsStruct& Params, bool Julia, double CRe, double CIm, const DoubleDouble* X,
+                         const DoubleDouble& Y, int Width, uint32_t* Out)
+{
+    typedef Components<Real> C;
+    constexpr int P = C::Count;
+    constexpr int L = 8;
+    for (int j0 = 0; j0 < Width; j0 += L)
+    {
+        alignas(64) double ZRe[P][L], ZIm[P][L], CR[P][L], CI[P][L];
+        alignas(64) uint32_t Escape[L];
+        for (int l = 0; l < L; ++l)
+        {
+            Real x = X[std::min(j0 + l, Width - 1)];
+            Real y = Y;
+            Real cx = Julia ? Real(CRe) : x;
+            Real cy = Julia ? Real(CIm) : y;
+            for (int k = 0; k < P; ++k)
+            {
+                ZRe[k][l] = C::get(x, k);
+                ZIm[k][l] = C::get(y, k);
+                CR[k][l] = C::get(cx, k);
+                CI[k][l] = C::get(cy, k);
+            }
+            // Lanes past the end of the row are masked out with an impossible iteration
+            Escape[l] = j0 + l < Width ? 0 : UINT32_MAX;
+        }
+
+        for (int i = 0; i < Params.niters; ++i)
+        {
+            int Live = 0;
+            for (int l = 0; l < L; ++l)
+            {
+                Real x, y, cx, cy;
+                for (int k = 0; k < P; ++k)
+                {
+                    C::get(x, k) = ZRe[k][l];
+                    C::get(y, k) = ZIm[k][l];
+                    C::get(cx, k) = CR[k][l];
+                    C::get(cy, k) = CI[k][l];
+                }
+                Real Re = (x + y) * (x - y) + cx;
+                Real Im = mul_pwr2(x * y, 2.0) + cy;
+                for (int k = 0; k < P; ++k)
+                {
+                    ZRe[k][l] = C::get(Re, k);
+                    ZIm[k][l] = C::get(Im, k);
+                }
+                double LRe = C::get(Re, 0);
+                double LIm = C::get(Im, 0);
+                bool Alive = Escape[l] == 0;
+                bool Escaped = Alive & (LRe * LRe + LIm * LIm > 4.0);
+                Escape[l] = Escaped ? (uint32_t)(i + 1) : Escape[l];
+                Live += Alive & !Escaped;
+            }
+            if (Live == 0)
+                break;
+        }
+
+        for (int l = 0; l < L && j0 + l < Width; ++l)
+            Out[j0 + l] = Escape[l];
+    }
+}
+
+
+/**
+ * @brief       Steps shorter than this end Newton's iterations, as do points this close to a root or
+ *              to a point visited before. As in the shaders, single precision stops earlier.
+ */
+template <typename Real>
+constexpr double newton_tolerance() { return 1e-6; }
+template <>
+constexpr double newton_tolerance<float>() { return 1e-4; }
+
+
+/**
+ * @brief       Newton's step p(z) / p'(z) at z = (ZRe, ZIm), in the given form of the polynomial with
+ *              N roots and N + 1 coefficients, as in the shaders.
+ */
+template <typename Real>
+void newton_delta(NewtonStep Step, int N, const double* Roots, const double* Coeffs, const Real& ZRe, const Real& ZIm,
+                  Real& SRe, Real& SIm)
+{
+    Real PRe, PIm, DRe, DIm;
+    if (Step == NewtonStep::NEWTON_STEP_UNITY)
+    {
+        // p = z^n - 1, p' = n z^(n - 1), with z^(n - 1) computed by squaring
+        Real WRe = (Real)1, WIm = (Real)0;
+        Real BRe = ZRe, BIm = ZIm;
+        for (int e = N - 1; e > 0; e >>= 1)
+        {
+            if (e & 1)
+            {
+                Real T = WRe * BRe - WIm * BIm;
+                WIm = WRe * BIm + WIm * BRe;
+                WRe = T;
+            }
+            Real T = (BRe + BIm) * (BRe - BIm);
+            Real U = BRe * BIm;
+            BIm = U + U;
+            BRe = T;
+        }
+        PRe = WRe * ZRe - WIm * ZIm - (Real)1;
+        PIm = WRe * ZIm + WIm * ZRe;
+        DRe = (Real)(double)N * WRe;
+        DIm = (Real)(double)N * WIm;
+    }
+    else if (Step == NewtonStep::NEWTON_STEP_COEFFICIENTS)
+    {
+        // Horner's scheme, p' accumulated along with p
+        PRe = (Real)Coeffs[2 * N];
+        PIm = (Real)Coeffs[2 * N + 1];
+        DRe = (Real)0;
+        DIm = (Real)0;
+        for (int k = N - 1; k >= 0; --k)
+        {
+            Real T = DRe * ZRe - DIm * ZIm + PRe;
+            DIm = DRe * ZIm + DIm * ZRe + PIm;
+            DRe = T;
+            T = PRe * ZRe - PIm * ZIm + (Real)Coeffs[2 * k];
+            PIm = PRe * ZIm + PIm * ZRe + (Real)Coeffs[2 * k + 1];
+            PRe = T;
+        }
+    }
+    else
+    {
+        // p / p' = 1 / sum_k 1 / (z - r_k), or z - r_k close enough to r_k
+        const double Tolerance = newton_tolerance<Real>();
+        Real RRe = (Real)0, RIm = (Real)0;
+        for (int k = 0; k < N; ++k)
+        {
+            Real FRe = ZRe - (Real)Roots[2 * k];
+            Real FIm = ZIm - (Real)Roots[2 * k + 1];
+            Real Den = FRe * FRe + FIm * FIm;
+            if ((double)Den < Tolerance * Tolerance)
+            {
+                SRe = FRe;
+                SIm = FIm;
+                return;
+            }
+            RRe += FRe / Den;
+            RIm -= FIm / Den;
+        }
+        Real Den = RRe * RRe + RIm * RIm;
+        SRe = RRe / Den;
+        SIm = -RIm / Den;
+        return;
+    }
+    Real Den = DRe * DRe + DIm * DIm;
+    SRe = (PRe * DRe + PIm * DIm) / Den;
+    SIm = (PIm * DRe - PRe * DIm) / Den;
+}
+
+
+/**
+ * @brief       Newton's iterations on the polynomial with the given roots over a row, whose points
+ *              have coordinates X and Y. Out receives the index of the root nearest to every point
+ *              once its iterations stop: when the steps become shorter than the tolerance, when the
+ *              point comes back to one it visited, or after Params.niters.
+ */
+template <typename Real>
+void newton_row(const ParamsStruct& Params, NewtonStep Step, const double* Roots, const double* Coeffs,
+                const DoubleDouble* X, const DoubleDouble& Y, int Width, uint32_t* Out)
+{
+    constexpr int L = 64 / sizeof(Real);
+    const int N = Params.nroots;
+    const double Tolerance2 = newton_tolerance<Real>() * newton_tolerance<Real>();
+    for (int j0 = 0; j0 < Width; j0 += L)
+    {
+        alignas(64) Real ZRe[L], ZIm[L];
+        alignas(64) Real SavedRe[L], SavedIm[L];
+        bool Done[L];
+        for (int l = 0; l < L; ++l)
+        {
+            ZRe[l] = (Real)X[std::min(j0 + l, Width - 1)];
+            ZIm[l] = (Real)Y;
+            SavedRe[l] = ZRe[l];
+            SavedIm[l] = ZIm[l];
+            Done[l] = false;
+        }
+
+        for (int i = 0; i < Params.niters; ++i)
+        {
+            // Every lane steps and the stopped ones keep their point, so the lanes vectorize
+            int Live = 0;
+            bool Sample = ((i + 1) & i) == 0;
+            for (int l = 0; l < L; ++l)
+            {
+                Real SRe, SIm;
+                newton_delta(Step, N, Roots, Coeffs, ZRe[l], ZIm[l], SRe, SIm);
+                Real NRe = ZRe[l] - SRe;
+                Real NIm = ZIm[l] - SIm;
+
+                // Cycles are caught against the points of the powers of two, as in Brent's algorithm
+                Real DRe = NRe - SavedRe[l];
+                Real DIm = NIm - SavedIm[l];
+                bool Alive = !Done[l];
+                bool Stopped = ((double)(SRe * SRe + SIm * SIm) < Tolerance2) |
+                               ((double)(DRe * DRe + DIm * DIm) < Tolerance2);
+                ZRe[l] = Alive ? NRe : ZRe[l];
+                ZIm[l] = Alive ? NIm : ZIm[l];
+                SavedRe[l] = Sample ? ZRe[l] : SavedRe[l];
+                SavedIm[l] = Sample ? ZIm[l] : SavedIm[l];
+                Done[l] = Done[l] | Stopped;
+                Live += Alive & !Stopped;
+            }
+            if (Live == 0)
+                break;
+        }
+
+        for (int l = 0; l < L && j0 + l < Width; ++l)
+        {
+            uint32_t Nearest = 0;
+            double Best = 0.0;
+            for (int k = 0; k < N; ++k)
+            {
+                double DX = (double)ZRe[l] - Roots[2 * k];
+                double DY = (double)ZIm[l] - Roots[2 * k + 1];
+                double D = DX * DX + DY * DY;
+                if (k == 0 || D < Best)
+                {
+                    Best = D;
+                    Nearest = (uint32_t)k;
+                }
+            }
+            Out[j0 + l] = Nearest;
+        }
+    }
+}
+
+
+/**
+ * @brief       Renders the field whose pixels have coordinates X[j] and Y[i].
+ */
+void iterate_field(FractalType Type, const ParamsStruct& Params, CPUPrecision Precision, const std::vector<DoubleDouble>& X,
+                   const std::vector<DoubleDouble>& Y, uint32_t* Field, const CPURenderOptions& Options,
+                   std::vector<PerfPhase>* Phases)
+{
+    const int Width = (int)X.size();
+    const int Height = (int)Y.size();
+    std::vector<double> Roots, Coeffs;
+    NewtonStep Step = NewtonStep::NEWTON_STEP_ROOTS;
+    double CRe = 0.0, CIm = 0.0;
+    if (Type == FractalType::NEWTON)
+    {
+        Roots.resize(2 * (size_t)std::max(Params.nroots, 1));
+        Coeffs.resize(2 * (size_t)Params.nroots + 2);
+        newton_roots(Params.nroots, Roots.data());
+        newton_coefficients(Params.nroots, Roots.data(), Coeffs.data());
+        Step = newton_step(Params.nroots, Roots.data());
+    }
+    else if (Type == FractalType::JULIA)
+        julia_constant(Params.angle, CRe, CIm);
+
+    parallel_rows("iterate", Width, Height, Options, Phases, [&](int Row) {
+        uint32_t* Out = Field + (size_t)Row * Width;
+        bool Julia = Type == FractalType::JULIA;
+        switch (Precision)
+        {
+        case CPUPrecision::CPU_FP32:
+            if (Type == FractalType::NEWTON)
+                newton_row<float>(Params, Step, Roots.data(), Coeffs.data(), X.data(), Y[Row], Width, Out);
+            else
+                escape_row<float>(Params, Julia, CRe, CIm, X.data(), Y[Row], Width, Out);
+            break;
+        case CPUPrecision::CPU_DOUBLE_DOUBLE:
+            if (Type == FractalType::NEWTON)
+                newton_row<DoubleDouble>(Params, Step, Roots.data(), Coeffs.data(), X.data(), Y[Row], Width, Out);
+            else
+                escape_row_extended<DoubleDouble>(Params, Julia, CRe, CIm, X.data(), Y[Row], Width, Out);
+            break;
+        case CPUPrecision::CPU_QUAD_DOUBLE:
+            if (Type == FractalType::NEWTON)
+                newton_row<QuadDouble>(Params, Step, Roots.data(), Coeffs.data(), X.data(), Y[Row], Width, Out);
+            else
+                escape_row_extended<QuadDouble>(Params, Julia, CRe, CIm, X.data(), Y[Row], Width, Out);
+            break;
+        default:
+            if (Type == FractalType::NEWTON)
+                newton_row<double>(Params, Step, Roots.data(), Coeffs.data(), X.data(), Y[Row], Width, Out);
+            else
+                escape_row<double>(Params, Julia, CRe, CIm, X.data(), Y[Row], Width, Out);
+            break;
+        }
+    });
+}
+
+}
+
+
+const char* cpu_precision_name(CPUPrecision Precision)
+{
+    return CPUPrecisionNames[Precision];
+}
+
+
+CPUPrecision select_cpu_precision(const ViewModel& View, int Width, int Height)
+{
+    // Single precision is only a reference on the CPU, it gains too little over double
+    for (int p = CPU_FP64; p < CPU_QUAD_DOUBLE; ++p)
+    {
+        if (view_resolves(View, Width, Height, CPUPrecisionEpsilon[p]))
+            return (CPUPrecision)p;
+    }
+    return CPUPrecision::CPU_QUAD_DOUBLE;
+}
+
+
+bool cpu_render_field(FractalType Type, const ParamsStruct& Params, int Width, int Height, uint32_t* Field,
+                      const CPURenderOptions& Options, std::vector<PerfPhase>* Phases)
+{
+    if (Type == FractalType::INVALID || Width <= 0 || Height <= 0)
+    {
+        std::cerr << "Cannot render the fractal on the CPU." << std::endl;
+        return false;
+    }
+
+    // Row i of the field is the i-th from the bottom, as in the textures
+    std::vector<DoubleDouble> X(Width), Y(Height);
+    const double XLen = Params.xlim[1] - Params.xlim[0];
+    const double YLen = Params.ylim[1] - Params.ylim[0];
+    for (int j = 0; j < Width; ++j)
+        X[j] = (double)j / (double)Width * XLen + Params.xlim[0];
+    for (int i = 0; i < Height; ++i)
+        Y[i] = (double)i / (double)Height * YLen + Params.ylim[0];
+
+    CPUPrecision Precision = Options.Precision;
+    if (Precision == CPUPrecision::CPU_AUTO)
+        Precision = select_cpu_precision(view_from_params(Params), Width, Height);
+    iterate_field(Type, Params, Precision, X, Y, Field, Options, Phases);
+    return true;
+}
+
+
+bool cpu_render_field(FractalType Type, const ParamsStruct& Params, const ViewModel& View, int Width, int Height,
+                      uint32_t* Field, const CPURenderOptions& Options, std::vector<PerfPhase>* Phases)
+{
+    if (Type == FractalType::INVALID || Width <= 0 || Height <= 0)
+    {
+        std::cerr << "Cannot render the fractal on the CPU." << std::endl;
+        return false;
+    }
+
+    // Offsets from the center are exact as double-doubles, so the points are as precise as the center
+    std::vector<DoubleDouble> X(Width), Y(Height);
+    const double XStep = 2.0 * View.HalfWidth / (double)Width;
+    const double YStep = 2.0 * View.HalfHeight / (double)Height;
+    for (int j = 0; j < Width; ++j)
+        X[j] = View.CenterX + two_prod(j - 0.5 * Width, XStep);
+    for (int i = 0; i < Height; ++i)
+        Y[i] = View.CenterY + two_prod(i - 0.5 * Height, YStep);
+
+    CPUPrecision Precision = Options.Precision;
+    if (Precision == CPUPrecision::CPU_AUTO)
+        Precision = select_cpu_precision(View, Width, Height);
+    iterate_field(Type, Params, Precision, X, Y, Field, Options, Phases);
+    return true;
+}
+
+
+void cpu_colorize(FractalType Type, const ParamsStruct& Params, const uint32_t* Field, int Width, int Height,
+                  unsigned char* RGB, const CPURenderOptions& Options, std::vector<PerfPhase>* Phases)
+{
+    parallel_rows("colorize", Width, Height, Options, Phases, [&](int Row) {
+        const uint32_t* In = Field + (size_t)Row * Width;
+        unsigned char* Out = RGB + (size_t)Row * Width * 3;
+        for (int j = 0; j < Width; ++j)
+        {
+            double Theta;
+            if (Type == FractalType::NEWTON)
+                Theta = (double)In[j] / (double)Params.nroots;
+            else
+            {
+                // The shaders colour the iterations left when the point escapes
+                long long K = In[j] == 0 ? 0 : (long long)Params.niters + 1 - In[j];
+                Theta = (double)K / (double)Params.niters;
+            }
+            colormap(Theta, Out + 3 * j);
+        }
+    });
+}
@@ -0,0 +1,282 @@
+/**
+ * @file        expmap.cpp
+ *
+ * @brief       Implementation of the exponential map zoom renderer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <expmap.hpp>
+#include <compute_renderer.hpp>
+#include <frame_pipeline.hpp>
+#include <tracer.hpp>
+#include <gl_utils.hpp>
+#include <memory_tracker.hpp>
+#include <defines.hpp>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+
+// Rows of the strip rendered by a single dispatch, fewer if the strip does not fit the memory budget
+const int MaxChunkRows = 512;
+const int MinChunkRows = 32;
+// Radius, in pixels of the last frame, of the innermost row of the strip
+const double InnerRadius = 1.0;
+// Smallest radius, in pixels, sampled from the strip by a resampled frame
+const double MinRho = 0.5;
+
+
+struct ExpMapStrip
+{
+    GLuint Program      = 0;
+    GLuint ParamsBuf    = 0;
+    GLuint Texture      = 0;
+    int NTheta          = 0;
+    int ChunkRows       = MaxChunkRows;
+    int NLayers         = 0;
+    long long NChunks   = 0;
+    double Delta        = 0.0;
+    double LogRMin      = 0.0;
+    std::vector<long long> LayerChunk;
+    long long ChunksRendered = 0;
+    MemoryReservation TextureBytes;
+    MemoryReservation ParamsBytes;
+};
+
+
+static void render_chunk(ExpMapStrip& Strip, const ParamsStruct& Params, const ExpMapOptions& Options,
+                         long long Chunk)
+{
+    TRACE_SCOPE("render_chunk", Chunk);
+    int Layer = (int)(Chunk % Strip.NLayers);
+    // The layer might still be read by the previous frames
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    // Columns span the whole turn, rows are relative to the first row of the chunk
+    ParamsStruct ChunkParams = Params;
+    ChunkParams.xlim[0] = 0.0;
+    ChunkParams.xlim[1] = 2.0 * M_PI;
+    ChunkParams.ylim[0] = 0.0;
+    ChunkParams.ylim[1] = Strip.ChunkRows * Strip.Delta;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, Strip.ParamsBuf);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(ChunkParams), &ChunkParams);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    double Scale = exp(Strip.LogRMin + (double)Chunk * Strip.ChunkRows * Strip.Delta);
+    glProgramUniform2d(Strip.Program, glGetUniformLocation(Strip.Program, "ExpCenter"), Options.CenterX, Options.CenterY);
+    glProgramUniform1d(Strip.Program, glGetUniformLocation(Strip.Program, "ExpScale"), Scale);
+
+    glUseProgram(Strip.Program);
+    glBindImageTexture(0, Strip.Texture, 0, GL_FALSE, Layer, GL_WRITE_ONLY, GL_RGBA8);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, Strip.ParamsBuf);
+    glDispatchCompute((Strip.NTheta + 31) / 32, (Strip.ChunkRows + 31) / 32, 1);
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    Strip.LayerChunk[Layer] = Chunk;
+    ++Strip.ChunksRendered;
+}
+
+
+static void destroy_strip(ExpMapStrip& Strip)
+{
+    if (Strip.Program != 0)
+        glDeleteProgram(Strip.Program);
+    if (Strip.ParamsBuf != 0)
+        glDeleteBuffers(1, &Strip.ParamsBuf);
+    if (Strip.Texture != 0)
+        glDeleteTextures(1, &Strip.Texture);
+    Strip.Program = Strip.ParamsBuf = Strip.Texture = 0;
+    Strip.TextureBytes.release();
+    Strip.ParamsBytes.release();
+}
+
+
+bool render_expmap_zoom(FractalType Type, const ParamsStruct& Params, const ExpMapOptions& Options,
+                        FrameSink& Sink)
+{
+    if (Type != FractalType::MANDELBROT && Type != FractalType::JULIA)
+    {
+        std::cerr << "Exponential map zooms are only available for Mandelbrot's and Julia's sets." << std::endl;
+        return false;
+    }
+    if (Options.NFrames < 1 || Options.Width < 1 || Options.Height < 1)
+    {
+        std::cerr << "Invalid number or size of frames." << std::endl;
+        return false;
+    }
+
+    // Natural logarithm of the pixel size of a frame
+    auto LogPixel = [&Options](long long k) {
+        double t = Options.NFrames > 1 ? (double)k / (double)(Options.NFrames - 1) : 0.0;
+        double LogScale = Options.LogScaleFrom + t * (Options.LogScaleTo - Options.LogScaleFrom);
+        return log(2.0) + LogScale * log(10.0) - log((double)Options.Height);
+    };
+    double LogPixelFirst = LogPixel(0);
+    double LogPixelLast = LogPixel(Options.NFrames - 1);
+    if (LogPixelLast > LogPixelFirst)
+    {
+        std::cerr << "Exponential map zooms must zoom in." << std::endl;
+        return false;
+    }
+
+    // One column per pixel on the outermost circle, and square samples
+    ExpMapStrip Strip;
+    double MaxRho = 0.5 * sqrt((double)Options.Width * Options.Width + (double)Options.Height * Options.Height);
+    Strip.NTheta = (int)ceil(2.0 * M_PI * MaxRho);
+    Strip.Delta = 2.0 * M_PI / Strip.NTheta;
+    Strip.LogRMin = LogPixelLast + log(InnerRadius);
+    double LogRMax = LogPixelFirst + log(MaxRho);
+    long long NRows = (long long)ceil((LogRMax - Strip.LogRMin) / Strip.Delta) + 2;
+    // Chunks spanned by a frame, plus one on each side for the interpolation across chunks. All of
+    // them must be resident, so smaller chunks are the only way to fit a tighter budget
+    long long FrameRows = (long long)ceil((log(MaxRho) - log(MinRho)) / Strip.Delta) + 2;
+    size_t Available = memory_tracker().available();
+    size_t StripBytes;
+    while (true)
+    {
+        Strip.NChunks = (NRows + Strip.ChunkRows - 1) / Strip.ChunkRows;
+        Strip.NLayers = (int)std::min(Strip.NChunks, (FrameRows + Strip.ChunkRows - 1) / Strip.ChunkRows + 2);
+        StripBytes = (size_t)Strip.NTheta * Strip.ChunkRows * Strip.NLayers * 4;
+        if (StripBytes + sizeof(Params) <= Available || Strip.ChunkRows <= MinChunkRows)
+            break;
+        Strip.ChunkRows /= 2;
+    }
+    Strip.LayerChunk.assign(Strip.NLayers, -1);
+
+    GLint MaxTexSize, MaxLayers;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &MaxTexSize);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &MaxLayers);
+    if (Strip.NTheta > MaxTexSize || Strip.NLayers > MaxLayers)
+    {
+        std::cerr << "Frames are too large for an exponential map strip." << std::endl;
+        return false;
+    }
+
+    // Strip resources
+    if (!Strip.TextureBytes.reserve(MEM_TEXTURES, StripBytes, "the exponential map strip") ||
+        !Strip.ParamsBytes.reserve(MEM_BUFFERS, sizeof(Params), "the parameters of the strip"))
+        return false;
+    Strip.Program = build_compute_program(compute_shader_path(Type), "#define EXPMAP\n");
+    GLuint ResampleProgram = build_compute_program(EXPMAP_RESAMPLE_SHADER);
+    if (Strip.Program == 0 || ResampleProgram == 0)
+    {
+        destroy_strip(Strip);
+        if (ResampleProgram != 0)
+            glDeleteProgram(ResampleProgram);
+        return false;
+    }
+    glGenBuffers(1, &Strip.ParamsBuf);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, Strip.ParamsBuf);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Params), &Params, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glGenTextures(1, &Strip.Texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, Strip.Texture);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, Strip.NTheta, Strip.ChunkRows, Strip.NLayers);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    if (glGetError() != GL_NO_ERROR)
+    {
+        std::cerr << "Cannot allocate the exponential map strip." << std::endl;
+        destroy_strip(Strip);
+        glDeleteProgram(ResampleProgram);
+        return false;
+    }
+
+    // Frames are resampled into, or rendered directly in, the texture of a regular renderer
+    ComputeRenderer Renderer;
+    FramePipeline Pipeline;
+    if (!create_compute_renderer(Renderer, Type, Params, Options.Width, Options.Height))
+    {
+        destroy_strip(Strip);
+        glDeleteProgram(ResampleProgram);
+        return false;
+    }
+    if (!Pipeline.create(Options.Width, Options.Height, &Sink))
+    {
+        destroy_compute_renderer(Renderer);
+        destroy_strip(Strip);
+        glDeleteProgram(ResampleProgram);
+        return false;
+    }
+
+    glProgramUniform1i(ResampleProgram, glGetUniformLocation(ResampleProgram, "NTheta"), Strip.NTheta);
+    glProgramUniform1i(ResampleProgram, glGetUniformLocation(ResampleProgram, "ChunkRows"), Strip.ChunkRows);
+    glProgramUniform1i(ResampleProgram, glGetUniformLocation(ResampleProgram, "NLayers"), Strip.NLayers);
+    glProgramUniform1f(ResampleProgram, glGetUniformLocation(ResampleProgram, "InvDelta"), (float)(1.0 / Strip.Delta));
+    glProgramUniform1f(ResampleProgram, glGetUniformLocation(ResampleProgram, "MinRho"), (float)MinRho);
+    glProgramUniform1i(ResampleProgram, glGetUniformLocation(ResampleProgram, "Strip"), 1);
+    GLint RowOffsetLoc = glGetUniformLocation(ResampleProgram, "RowOffset");
+
+    std::cout << "Rendering " << Options.NFrames << " frames of " << Options.Width << "x" << Options.Height <<
+                 " from a " << Strip.NTheta << "x" << NRows << " log-polar strip." << std::endl;
+
+    bool Success = true;
+    long long FullFrames = 0;
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    for (long long k = 0; k < Options.NFrames && Success; ++k)
+    {
+        TRACE_SCOPE("frame", k);
+        double LogPixelSize = LogPixel(k);
+
+        // Innermost frames would sample the center below the first row of the strip
+        double HoleRadius = exp(Strip.LogRMin - LogPixelSize);
+        if (HoleRadius > MinRho)
+        {
+            double HalfHeight = 0.5 * exp(LogPixelSize) * Options.Height;
+            double HalfWidth = 0.5 * exp(LogPixelSize) * Options.Width;
+            ParamsStruct Frame = Params;
+            Frame.xlim[0] = Options.CenterX - HalfWidth;
+            Frame.xlim[1] = Options.CenterX + HalfWidth;
+            Frame.ylim[0] = Options.CenterY - HalfHeight;
+            Frame.ylim[1] = Options.CenterY + HalfHeight;
+            compute_render(Renderer, Frame);
+            ++FullFrames;
+        }
+        else
+        {
+            // Make sure all the chunks spanned by the frame are resident
+            double RowOffset = (LogPixelSize - Strip.LogRMin) / Strip.Delta;
+            long long RowMin = std::max(0LL, (long long)floor(RowOffset + log(MinRho) / Strip.Delta));
+            long long RowMax = std::min(NRows - 1, (long long)ceil(RowOffset + log(MaxRho) / Strip.Delta) + 1);
+            for (long long c = RowMax / Strip.ChunkRows; c >= RowMin / Strip.ChunkRows; --c)
+            {
+                if (Strip.LayerChunk[c % Strip.NLayers] != c)
+                    render_chunk(Strip, Params, Options, c);
+            }
+
+            TRACE_SCOPE("resample");
+            glProgramUniform1f(ResampleProgram, RowOffsetLoc, (float)RowOffset);
+            glUseProgram(ResampleProgram);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, Strip.Texture);
+            glBindImageTexture(0, Renderer.Texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+            glDispatchCompute((Options.Width + 31) / 32, (Options.Height + 31) / 32, 1);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+            glActiveTexture(GL_TEXTURE0);
+        }
+        Success = Pipeline.push(Renderer.Texture);
+    }
+    Success = Pipeline.finish() && Success;
+    double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    if (Success)
+    {
+        double FramePixels = (double)Options.Width * Options.Height;
+        double StripPixels = (double)Strip.ChunksRendered * Strip.ChunkRows * Strip.NTheta;
+        std::cout << "Rendered " << Pipeline.frames() << " frames in " << Elapsed << " seconds: " <<
+                     Pipeline.frames() / Elapsed << " fps." << std::endl;
+        std::cout << "Computed " << StripPixels * 1.0e-6 << " MPixels of strip and " << FullFrames <<
+                     " full frames, against " << FramePixels * Options.NFrames * 1.0e-6 <<
+                     " MPixels for rendering every frame." << std::endl;
+    }
+
+    destroy_compute_renderer(Renderer);
+    destroy_strip(Strip);
+    glDeleteProgram(ResampleProgram);
+    return Success;
+}
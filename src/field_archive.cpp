@@ -0,0 +1,591 @@
+/**
+ * @file        field_archive.cpp
+ *
+ * @brief       Implementation of the iteration field archive.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <field_archive.hpp>
+#include <metrics.hpp>
+#include <iostream>
+#include <algorithm>
+#include <queue>
+#include <string.h>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+const char HeaderMagic[8] = { 'I', 'T', 'E', 'R', 'F', 'L', 'D', '1' };
+const char TrailerMagic[8] = { 'I', 'T', 'E', 'R', 'I', 'D', 'X', '1' };
+const int HeaderSize = 128;
+const int TrailerSize = 24;
+const uint32_t FormatVersion = 1;
+
+// Payload modes
+const unsigned char STORED_TOKENS = 0;
+const unsigned char HUFFMAN_TOKENS = 1;
+
+// Codes are limited in length so that a single table lookup decodes them
+const int MaxCodeLength = 12;
+
+
+static void put_u32(unsigned char* Dst, uint32_t V)
+{
+    for (int i = 0; i < 4; ++i)
+        Dst[i] = (unsigned char)(V >> (8 * i));
+}
+
+static void put_u64(unsigned char* Dst, uint64_t V)
+{
+    for (int i = 0; i < 8; ++i)
+        Dst[i] = (unsigned char)(V >> (8 * i));
+}
+
+static void put_f64(unsigned char* Dst, double V)
+{
+    uint64_t Bits;
+    memcpy(&Bits, &V, 8);
+    put_u64(Dst, Bits);
+}
+
+static uint32_t get_u32(const unsigned char* Src)
+{
+    uint32_t V = 0;
+    for (int i = 0; i < 4; ++i)
+        V |= (uint32_t)Src[i] << (8 * i);
+    return V;
+}
+
+static uint64_t get_u64(const unsigned char* Src)
+{
+    uint64_t V = 0;
+    for (int i = 0; i < 8; ++i)
+        V |= (uint64_t)Src[i] << (8 * i);
+    return V;
+}
+
+static double get_f64(const unsigned char* Src)
+{
+    uint64_t Bits = get_u64(Src);
+    double V;
+    memcpy(&V, &Bits, 8);
+    return V;
+}
+
+
+static void serialize_header(const FieldArchiveHeader& Header, unsigned char* Dst)
+{
+    memset(Dst, 0, HeaderSize);
+    memcpy(Dst, HeaderMagic, 8);
+    put_u32(Dst + 8, FormatVersion);
+    put_u32(Dst + 12, Header.TileSize);
+    put_u64(Dst + 16, Header.Width);
+    put_u64(Dst + 24, Header.Height);
+    put_u32(Dst + 32, (uint32_t)Header.Type);
+    put_u32(Dst + 36, (uint32_t)Header.Params.niters);
+    put_u32(Dst + 40, (uint32_t)Header.Params.nroots);
+    put_f64(Dst + 48, Header.Params.angle);
+    put_f64(Dst + 56, Header.Params.xlim[0]);
+    put_f64(Dst + 64, Header.Params.xlim[1]);
+    put_f64(Dst + 72, Header.Params.ylim[0]);
+    put_f64(Dst + 80, Header.Params.ylim[1]);
+}
+
+static bool deserialize_header(const unsigned char* Src, FieldArchiveHeader& Header)
+{
+    if (memcmp(Src, HeaderMagic, 8) != 0 || get_u32(Src + 8) != FormatVersion)
+        return false;
+    Header.TileSize = get_u32(Src + 12);
+    Header.Width = get_u64(Src + 16);
+    Header.Height = get_u64(Src + 24);
+    Header.Type = (int32_t)get_u32(Src + 32);
+    Header.Params.niters = (int)get_u32(Src + 36);
+    Header.Params.nroots = (int)get_u32(Src + 40);
+    Header.Params.angle = get_f64(Src + 48);
+    Header.Params.xlim[0] = get_f64(Src + 56);
+    Header.Params.xlim[1] = get_f64(Src + 64);
+    Header.Params.ylim[0] = get_f64(Src + 72);
+    Header.Params.ylim[1] = get_f64(Src + 80);
+    return Header.TileSize > 0;
+}
+
+
+
+// Median edge detector of LOCO-I: picks the left or top neighbour across edges, the planar
+// prediction elsewhere
+static inline uint32_t predict(const uint32_t* Row, const uint32_t* Above, int j)
+{
+    if (Above == NULL)
+        return j > 0 ? Row[j - 1] : 0;
+    if (j == 0)
+        return Above[0];
+    uint32_t A = Row[j - 1];
+    uint32_t B = Above[j];
+    uint32_t C = Above[j - 1];
+    if (C >= std::max(A, B))
+        return std::min(A, B);
+    if (C <= std::min(A, B))
+        return std::max(A, B);
+    return A + B - C;
+}
+
+static inline void put_varint(std::vector<unsigned char>& Dst, uint32_t V)
+{
+    while (V >= 0x80)
+    {
+        Dst.push_back((unsigned char)(V | 0x80));
+        V >>= 7;
+    }
+    Dst.push_back((unsigned char)V);
+}
+
+static inline bool get_varint(const unsigned char*& Src, const unsigned char* End, uint32_t& V)
+{
+    V = 0;
+    for (int Shift = 0; Shift < 35 && Src < End; Shift += 7)
+    {
+        unsigned char Byte = *Src++;
+        V |= (uint32_t)(Byte & 0x7F) << Shift;
+        if (!(Byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+
+/**
+ * Turns the residuals of a tile into bytes. A non-zero zigzag residual is a varint, whose first
+ * byte is never zero, and a zero byte starts a run of zero residuals, followed by its length
+ * minus one as a varint.
+ */
+static void tokenize(const uint32_t* Values, long long Stride, int Cols, int Rows, std::vector<unsigned char>& Tokens)
+{
+    Tokens.clear();
+    uint32_t Run = 0;
+    for (int i = 0; i < Rows; ++i)
+    {
+        const uint32_t* Row = Values + i * Stride;
+        const uint32_t* Above = i > 0 ? Row - Stride : NULL;
+        for (int j = 0; j < Cols; ++j)
+        {
+            // The residual wraps around, so that any 32-bit value is encoded losslessly
+            uint32_t Residual = Row[j] - predict(Row, Above, j);
+            uint32_t Zigzag = (Residual << 1) ^ (uint32_t)((int32_t)Residual >> 31);
+            if (Zigzag == 0)
+            {
+                ++Run;
+                continue;
+            }
+            if (Run > 0)
+            {
+                Tokens.push_back(0);
+                put_varint(Tokens, Run - 1);
+                Run = 0;
+            }
+            put_varint(Tokens, Zigzag);
+        }
+    }
+    if (Run > 0)
+    {
+        Tokens.push_back(0);
+        put_varint(Tokens, Run - 1);
+    }
+}
+
+static bool detokenize(const unsigned char* Src, const unsigned char* End, int Cols, int Rows, uint32_t* Values)
+{
+    uint32_t Run = 0;
+    for (int i = 0; i < Rows; ++i)
+    {
+        uint32_t* Row = Values + (size_t)i * Cols;
+        const uint32_t* Above = i > 0 ? Row - Cols : NULL;
+        for (int j = 0; j < Cols; ++j)
+        {
+            uint32_t Zigzag = 0;
+            if (Run > 0)
+                --Run;
+            else
+            {
+                if (Src >= End)
+                    return false;
+                if (*Src == 0)
+                {
+                    ++Src;
+                    if (!get_varint(Src, End, Run))
+                        return false;
+                }
+                else if (!get_varint(Src, End, Zigzag))
+                    return false;
+            }
+            uint32_t Residual = (Zigzag >> 1) ^ (0u - (Zigzag & 1));
+            Row[j] = predict(Row, Above, j) + Residual;
+        }
+    }
+    return Run == 0 && Src == End;
+}
+
+
+
+/**
+ * Computes the lengths of a Huffman code for the given frequencies, no longer than
+ * MaxCodeLength. Frequencies are flattened until the code fits.
+ */
+static void code_lengths(std::vector<uint64_t> Freq, unsigned char* Lengths)
+{
+    while (true)
+    {
+        memset(Lengths, 0, 256);
+        typedef std::pair<uint64_t, int> Node;
+        std::priority_queue<Node, std::vector<Node>, std::greater<Node>> Heap;
+        std::vector<int> Parent;
+        for (int s = 0; s < 256; ++s)
+        {
+            if (Freq[s] > 0)
+            {
+                Heap.push(Node(Freq[s], (int)Parent.size()));
+                Parent.push_back(-1);
+            }
+        }
+        std::vector<int> Symbols;
+        for (int s = 0; s < 256; ++s)
+        {
+            if (Freq[s] > 0)
+                Symbols.push_back(s);
+        }
+        if (Symbols.size() == 1)
+        {
+            Lengths[Symbols[0]] = 1;
+            return;
+        }
+
+        while (Heap.size() > 1)
+        {
+            Node A = Heap.top();
+            Heap.pop();
+            Node B = Heap.top();
+            Heap.pop();
+            int Id = (int)Parent.size();
+            Parent.push_back(-1);
+            Parent[A.second] = Id;
+            Parent[B.second] = Id;
+            Heap.push(Node(A.first + B.first, Id));
+        }
+
+        int MaxLength = 0;
+        for (size_t k = 0; k < Symbols.size(); ++k)
+        {
+            int Length = 0;
+            for (int n = (int)k; Parent[n] >= 0; n = Parent[n])
+                ++Length;
+            Lengths[Symbols[k]] = (unsigned char)Length;
+            MaxLength = std::max(MaxLength, Length);
+        }
+        if (MaxLength <= MaxCodeLength)
+            return;
+        for (uint64_t& F : Freq)
+        {
+            if (F > 0)
+                F = (F + 1) / 2;
+        }
+    }
+}
+
+// Canonical codes: shorter codes first, ties broken by symbol
+static void canonical_codes(const unsigned char* Lengths, uint32_t* Codes)
+{
+    uint32_t Code = 0;
+    for (int L = 1; L <= MaxCodeLength; ++L)
+    {
+        for (int s = 0; s < 256; ++s)
+        {
+            if (Lengths[s] == L)
+                Codes[s] = Code++;
+        }
+        Code <<= 1;
+    }
+}
+
+
+static void huffman_encode(const std::vector<unsigned char>& Tokens, std::vector<unsigned char>& Dst)
+{
+    std::vector<uint64_t> Freq(256, 0);
+    for (unsigned char T : Tokens)
+        ++Freq[T];
+    unsigned char Lengths[256];
+    uint32_t Codes[256];
+    code_lengths(Freq, Lengths);
+    canonical_codes(Lengths, Codes);
+
+    // Two lengths per byte
+    for (int s = 0; s < 256; s += 2)
+        Dst.push_back((unsigned char)(Lengths[s] | (Lengths[s + 1] << 4)));
+
+    uint64_t Bits = 0;
+    int Count = 0;
+    for (unsigned char T : Tokens)
+    {
+        Bits = (Bits << Lengths[T]) | Codes[T];
+        Count += Lengths[T];
+        while (Count >= 8)
+        {
+            Count -= 8;
+            Dst.push_back((unsigned char)(Bits >> Count));
+        }
+    }
+    if (Count > 0)
+        Dst.push_back((unsigned char)(Bits << (8 - Count)));
+}
+
+static bool huffman_decode(const unsigned char* Src, const unsigned char* End, std::vector<unsigned char>& Tokens)
+{
+    if (End - Src < 128)
+        return false;
+    unsigned char Lengths[256];
+    for (int s = 0; s < 256; s += 2)
+    {
+        Lengths[s] = Src[s / 2] & 0x0F;
+        Lengths[s + 1] = Src[s / 2] >> 4;
+    }
+    Src += 128;
+    uint32_t Codes[256];
+    canonical_codes(Lengths, Codes);
+
+    // Every entry of the table holds the symbol and the length of the code prefixing its index
+    uint16_t Table[1 << MaxCodeLength];
+    memset(Table, 0, sizeof(Table));
+    for (int s = 0; s < 256; ++s)
+    {
+        int L = Lengths[s];
+        if (L == 0)
+            continue;
+        if (L > MaxCodeLength)
+            return false;
+        uint32_t First = Codes[s] << (MaxCodeLength - L);
+        uint32_t Last = (Codes[s] + 1) << (MaxCodeLength - L);
+        if (Last > (1u << MaxCodeLength))
+            return false;
+        for (uint32_t k = First; k < Last; ++k)
+            Table[k] = (uint16_t)(s | (L << 8));
+    }
+
+    // Bits are kept left-aligned in a 64-bit buffer
+    uint64_t Bits = 0;
+    int Count = 0;
+    for (size_t t = 0; t < Tokens.size(); ++t)
+    {
+        while (Count <= 56)
+        {
+            if (Src < End)
+                Bits |= (uint64_t)*Src++ << (56 - Count);
+            Count += 8;
+        }
+        uint16_t Entry = Table[Bits >> (64 - MaxCodeLength)];
+        int L = Entry >> 8;
+        if (L == 0)
+            return false;
+        Tokens[t] = (unsigned char)(Entry & 0xFF);
+        Bits <<= L;
+        Count -= L;
+    }
+    return true;
+}
+
+
+
+bool field_archive_create(FieldArchiveWriter& Writer, const std::string& Path, const FieldArchiveHeader& Header)
+{
+    Writer.Handle = fopen(Path.c_str(), "wb");
+    if (Writer.Handle == NULL)
+    {
+        std::cerr << "Cannot open " << Path << " for writing." << std::endl;
+        return false;
+    }
+    Writer.Path = Path;
+    Writer.Header = Header;
+    Writer.NTilesX = (Header.Width + Header.TileSize - 1) / Header.TileSize;
+    Writer.NTilesY = (Header.Height + Header.TileSize - 1) / Header.TileSize;
+    Writer.Index.assign(2 * Writer.NTilesX * Writer.NTilesY, 0);
+    Writer.RawBytes = 0;
+
+    unsigned char Buffer[HeaderSize];
+    serialize_header(Header, Buffer);
+    if (fwrite(Buffer, 1, HeaderSize, Writer.Handle) != HeaderSize)
+    {
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+        return false;
+    }
+    Writer.Offset = HeaderSize;
+    return true;
+}
+
+
+bool field_archive_write_tile(FieldArchiveWriter& Writer, uint64_t TX, uint64_t TY,
+                              const uint32_t* Values, long long Stride)
+{
+    uint32_t T = Writer.Header.TileSize;
+    int Cols = (int)std::min((uint64_t)T, Writer.Header.Width - TX * T);
+    int Rows = (int)std::min((uint64_t)T, Writer.Header.Height - TY * T);
+    tokenize(Values, Stride, Cols, Rows, Writer.Tokens);
+
+    Writer.Payload.assign(5, 0);
+    Writer.Payload[0] = HUFFMAN_TOKENS;
+    put_u32(Writer.Payload.data() + 1, (uint32_t)Writer.Tokens.size());
+    huffman_encode(Writer.Tokens, Writer.Payload);
+    if (Writer.Payload.size() >= Writer.Tokens.size() + 5)
+    {
+        Writer.Payload.resize(5);
+        Writer.Payload[0] = STORED_TOKENS;
+        Writer.Payload.insert(Writer.Payload.end(), Writer.Tokens.begin(), Writer.Tokens.end());
+    }
+
+    // Payloads start at multiples of 8 bytes
+    uint64_t Size = Writer.Payload.size();
+    Writer.Payload.resize((Size + 7) & ~(uint64_t)7, 0);
+    if (fwrite(Writer.Payload.data(), 1, Writer.Payload.size(), Writer.Handle) != Writer.Payload.size())
+    {
+        std::cerr << "Cannot write " << Writer.Path << "." << std::endl;
+        return false;
+    }
+    uint64_t Tile = TY * Writer.NTilesX + TX;
+    Writer.Index[2 * Tile] = Writer.Offset;
+    Writer.Index[2 * Tile + 1] = Size;
+    Writer.Offset += Writer.Payload.size();
+    Writer.RawBytes += (uint64_t)Cols * Rows * 4;
+    metrics().add(METRIC_EXPORT_BYTES, (double)Writer.Payload.size());
+    return true;
+}
+
+
+bool field_archive_close(FieldArchiveWriter& Writer)
+{
+    if (Writer.Handle == NULL)
+        return false;
+
+    std::vector<unsigned char> Footer(Writer.Index.size() * 8 + TrailerSize);
+    for (size_t k = 0; k < Writer.Index.size(); ++k)
+        put_u64(Footer.data() + 8 * k, Writer.Index[k]);
+    unsigned char* Trailer = Footer.data() + Writer.Index.size() * 8;
+    put_u64(Trailer, Writer.Offset);
+    put_u64(Trailer + 8, Writer.NTilesX * Writer.NTilesY);
+    memcpy(Trailer + 16, TrailerMagic, 8);
+
+    bool Success = fwrite(Footer.data(), 1, Footer.size(), Writer.Handle) == Footer.size();
+    Success = fclose(Writer.Handle) == 0 && Success;
+    Writer.Handle = NULL;
+    if (!Success)
+        std::cerr << "Cannot write " << Writer.Path << "." << std::endl;
+    return Success;
+}
+
+
+
+bool field_archive_open(FieldArchiveReader& Reader, const std::string& Path)
+{
+#ifdef _WIN32
+    HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    Reader.File = File == INVALID_HANDLE_VALUE ? NULL : File;
+    LARGE_INTEGER FileSize;
+    if (Reader.File == NULL || !GetFileSizeEx(Reader.File, &FileSize))
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        field_archive_close(Reader);
+        return false;
+    }
+    Reader.Size = (uint64_t)FileSize.QuadPart;
+    Reader.Mapping = CreateFileMappingA(Reader.File, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (Reader.Mapping != NULL)
+        Reader.Data = (const unsigned char*)MapViewOfFile(Reader.Mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    Reader.File = open(Path.c_str(), O_RDONLY);
+    struct stat Info;
+    if (Reader.File < 0 || fstat(Reader.File, &Info) != 0)
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        field_archive_close(Reader);
+        return false;
+    }
+    Reader.Size = (uint64_t)Info.st_size;
+    void* Mapped = mmap(NULL, Reader.Size, PROT_READ, MAP_SHARED, Reader.File, 0);
+    if (Mapped != MAP_FAILED)
+        Reader.Data = (const unsigned char*)Mapped;
+#endif
+    if (Reader.Data == NULL || Reader.Size < HeaderSize + TrailerSize ||
+        !deserialize_header(Reader.Data, Reader.Header))
+    {
+        std::cerr << Path << " is not an iteration field archive." << std::endl;
+        field_archive_close(Reader);
+        return false;
+    }
+
+    uint32_t T = Reader.Header.TileSize;
+    Reader.NTilesX = (Reader.Header.Width + T - 1) / T;
+    Reader.NTilesY = (Reader.Header.Height + T - 1) / T;
+    const unsigned char* Trailer = Reader.Data + Reader.Size - TrailerSize;
+    uint64_t IndexOffset = get_u64(Trailer);
+    uint64_t NTiles = get_u64(Trailer + 8);
+    if (memcmp(Trailer + 16, TrailerMagic, 8) != 0 || NTiles != Reader.NTilesX * Reader.NTilesY ||
+        IndexOffset + NTiles * 16 + TrailerSize != Reader.Size)
+    {
+        std::cerr << Path << " is truncated or corrupted." << std::endl;
+        field_archive_close(Reader);
+        return false;
+    }
+    Reader.Index = Reader.Data + IndexOffset;
+    return true;
+}
+
+
+bool field_archive_read_tile(FieldArchiveReader& Reader, uint64_t TX, uint64_t TY, uint32_t* Values)
+{
+    if (TX >= Reader.NTilesX || TY >= Reader.NTilesY)
+        return false;
+    uint64_t Tile = TY * Reader.NTilesX + TX;
+    uint64_t Offset = get_u64(Reader.Index + 16 * Tile);
+    uint64_t Size = get_u64(Reader.Index + 16 * Tile + 8);
+    if (Size < 5 || Offset + Size > Reader.Size)
+        return false;
+
+    uint32_t T = Reader.Header.TileSize;
+    int Cols = (int)std::min((uint64_t)T, Reader.Header.Width - TX * T);
+    int Rows = (int)std::min((uint64_t)T, Reader.Header.Height - TY * T);
+    const unsigned char* Payload = Reader.Data + Offset;
+    const unsigned char* End = Payload + Size;
+    uint32_t TokenCount = get_u32(Payload + 1);
+    if (Payload[0] == STORED_TOKENS)
+        return TokenCount == Size - 5 && detokenize(Payload + 5, End, Cols, Rows, Values);
+    if (Payload[0] != HUFFMAN_TOKENS)
+        return false;
+    Reader.Tokens.resize(TokenCount);
+    return huffman_decode(Payload + 5, End, Reader.Tokens) &&
+           detokenize(Reader.Tokens.data(), Reader.Tokens.data() + TokenCount, Cols, Rows, Values);
+}
+
+
+void field_archive_close(FieldArchiveReader& Reader)
+{
+#ifdef _WIN32
+    if (Reader.Data != NULL)
+        UnmapViewOfFile(Reader.Data);
+    if (Reader.Mapping != NULL)
+        CloseHandle(Reader.Mapping);
+    if (Reader.File != NULL)
+        CloseHandle(Reader.File);
+#else
+    if (Reader.Data != NULL)
+        munmap((void*)Reader.Data, Reader.Size);
+    if (Reader.File >= 0)
+        close(Reader.File);
+#endif
+    Reader = FieldArchiveReader();
+}
@@ -0,0 +1,168 @@
+/**
+ * @file        fractal.cpp
+ *
+ * @brief       Implementation of the helpers for manipulating the view of a fractal.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <fractal.hpp>
+#include <algorithm>
+#include <vector>
+
+
+static NewtonStep PreferredStep = NewtonStep::NEWTON_STEP_AUTO;
+static bool ConvergenceShading = false;
+
+static const char* const NewtonStepNames[] = { "auto", "unity", "coefficients", "roots" };
+
+
+void fit_aspect(ParamsStruct& Params, long long Width, long long Height)
+{
+    double XLen = Params.xlim[1] - Params.xlim[0];
+    double YLen = Params.ylim[1] - Params.ylim[0];
+    double Aspect = (double)Width / (double)Height;
+    if (XLen < YLen * Aspect)
+    {
+        double XMid = 0.5 * (Params.xlim[0] + Params.xlim[1]);
+        Params.xlim[0] = XMid - 0.5 * YLen * Aspect;
+        Params.xlim[1] = XMid + 0.5 * YLen * Aspect;
+    }
+    else
+    {
+        double YMid = 0.5 * (Params.ylim[0] + Params.ylim[1]);
+        Params.ylim[0] = YMid - 0.5 * XLen / Aspect;
+        Params.ylim[1] = YMid + 0.5 * XLen / Aspect;
+    }
+}
+
+
+ParamsStruct tile_params(const ParamsStruct& Params, long long Width, long long Height,
+                         long long X0, long long Y0, int TileSize)
+{
+    double dx = (Params.xlim[1] - Params.xlim[0]) / (double)Width;
+    double dy = (Params.ylim[1] - Params.ylim[0]) / (double)Height;
+
+    // Textures store the rows bottom-up, so the tile starts TileSize rows above its bottom edge
+    long long BottomRow = Height - (Y0 + TileSize);
+
+    ParamsStruct Tile = Params;
+    Tile.xlim[0] = Params.xlim[0] + (double)X0 * dx;
+    Tile.xlim[1] = Tile.xlim[0] + (double)TileSize * dx;
+    Tile.ylim[0] = Params.ylim[0] + (double)BottomRow * dy;
+    Tile.ylim[1] = Tile.ylim[0] + (double)TileSize * dy;
+    return Tile;
+}
+
+
+void newton_roots(int NRoots, double* Roots)
+{
+    for (int i = 0; i < NRoots; ++i)
+    {
+        double theta = 2.0 * M_PI * ((double)i / (double)NRoots);
+        Roots[2 * i] = cos(theta);
+        Roots[2 * i + 1] = sin(theta);
+    }
+}
+
+
+void newton_coefficients(int NRoots, const double* Roots, double* Coeffs)
+{
+    // Multiply the factors (z - r_k) one at a time, starting from p = 1
+    for (int i = 0; i <= NRoots; ++i)
+    {
+        Coeffs[2 * i] = i == 0 ? 1.0 : 0.0;
+        Coeffs[2 * i + 1] = 0.0;
+    }
+    for (int k = 0; k < NRoots; ++k)
+    {
+        double RRe = Roots[2 * k];
+        double RIm = Roots[2 * k + 1];
+        for (int i = k + 1; i >= 0; --i)
+        {
+            // c_i = c_(i - 1) - r_k c_i
+            double Re = i > 0 ? Coeffs[2 * (i - 1)] : 0.0;
+            double Im = i > 0 ? Coeffs[2 * (i - 1) + 1] : 0.0;
+            Re -= RRe * Coeffs[2 * i] - RIm * Coeffs[2 * i + 1];
+            Im -= RRe * Coeffs[2 * i + 1] + RIm * Coeffs[2 * i];
+            Coeffs[2 * i] = Re;
+            Coeffs[2 * i + 1] = Im;
+        }
+    }
+}
+
+
+const char* newton_step_name(NewtonStep Step)
+{
+    return NewtonStepNames[Step];
+}
+
+
+void set_newton_step(NewtonStep Step)
+{
+    PreferredStep = Step;
+}
+
+
+NewtonStep newton_step(int NRoots, const double* Roots)
+{
+    if (PreferredStep != NewtonStep::NEWTON_STEP_AUTO)
+        return PreferredStep;
+
+    std::vector<double> Unity(2 * (size_t)std::max(NRoots, 1));
+    newton_roots(NRoots, Unity.data());
+    if (std::equal(Unity.begin(), Unity.begin() + 2 * NRoots, Roots))
+        return NewtonStep::NEWTON_STEP_UNITY;
+    if (NRoots <= NewtonCoefficientRoots)
+        return NewtonStep::NEWTON_STEP_COEFFICIENTS;
+    return NewtonStep::NEWTON_STEP_ROOTS;
+}
+
+
+void set_newton_shading(bool Shading)
+{
+    ConvergenceShading = Shading;
+}
+
+
+bool newton_shading()
+{
+    return ConvergenceShading;
+}
+
+
+void julia_constant(double Angle, double& Re, double& Im)
+{
+    // The shaders evaluate the exponential in single precision
+    Re = 0.7885 * (double)cosf((float)Angle);
+    Im = 0.7885 * (double)sinf((float)Angle);
+}
+
+
+static const float Colors[8][3] = {
+    { 0.2422f,  0.1504f,    0.6603f },
+    { 0.2810f,  0.3228f,    0.9579f },
+    { 0.1786f,  0.5289f,    0.9682f },
+    { 0.0689f,  0.6948f,    0.8394f },
+    { 0.2161f,  0.7843f,    0.5923f },
+    { 0.6720f,  0.7793f,    0.2227f },
+    { 0.9970f,  0.7659f,    0.2199f },
+    { 0.9769f,  0.9839f,    0.0805f }
+};
+
+void colormap(double Theta, unsigned char* RGB)
+{
+    // The shaders read past the palette for Theta = 1, here the last colour is used
+    int LeftIdx = std::min((int)floor(Theta * 8), 7);
+    int RightIdx = std::min((int)ceil(Theta * 8), 7);
+    float T = 0.0f;
+    if (LeftIdx != RightIdx)
+        T = (float)((Theta - LeftIdx / 8.0) / ((RightIdx - LeftIdx) / 8.0));
+    for (int c = 0; c < 3; ++c)
+    {
+        float V = Colors[LeftIdx][c] * (1.0f - T) + Colors[RightIdx][c] * T;
+        RGB[c] = (unsigned char)lrintf(std::min(std::max(V, 0.0f), 1.0f) * 255.0f);
+    }
+}
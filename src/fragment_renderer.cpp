@@ -0,0 +1,141 @@
+/**
+ * @file        fragment_renderer.cpp
+ *
+ * @brief       Implementation of the fragment shader renderer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <fragment_renderer.hpp>
+#include <compute_renderer.hpp>
+#include <gl_utils.hpp>
+#include <stage_timer.hpp>
+#include <tracer.hpp>
+#include <algorithm>
+#include <string>
+
+
+// The fragment shaders locate their pixels with gl_FragCoord, exact at any zoom
+const char *VSource = 
+"#version 440 core\n"\
+"layout(location = 0) in vec2 aPos;\n"\
+"void main() {\n"\
+"gl_Position = vec4(aPos, 0.0f, 1.0f);\n"\
+"}\n";
+
+const char* const KernelDefines[VIEW_AUTO] = {
+    "#define KERNEL_FP32\n",
+    "#define KERNEL_FP64\n",
+    "#define KERNEL_DD\n"
+};
+
+
+const float ScreenCoords[12] = {
+    // Vertex positions 
+    -1.0f,  -1.0f,
+    -1.0f,   1.0f,
+     1.0f,   1.0f,
+
+    -1.0f,  -1.0f,
+     1.0f,   1.0f,
+     1.0f,  -1.0f,
+};
+
+
+bool create_fragment_renderer(FragmentRenderer& Renderer, FractalType Type, GLuint RootsBuf)
+{
+    Renderer.Type = Type;
+    Renderer.RootsBuf = RootsBuf;
+
+    // Create the shader programs, Newton's fractal has no double-double kernel
+    int NKernels = Type == FractalType::NEWTON ? VIEW_DOUBLE_DOUBLE : VIEW_AUTO;
+    for (int p = 0; p < NKernels; ++p)
+    {
+        std::string Defines = KernelDefines[p];
+        if (Type == FractalType::NEWTON && newton_shading())
+            Defines += "#define CONVERGENCE_SHADING\n";
+        Renderer.Programs[p] = build_render_program(VSource, fragment_shader_path(Type), Defines);
+        if (Renderer.Programs[p] == 0)
+        {
+            destroy_fragment_renderer(Renderer);
+            return false;
+        }
+    }
+
+    // Create the vertex buffer
+    glGenVertexArrays(1, &Renderer.VAO);
+    glGenBuffers(1, &Renderer.VBO);
+    glBindVertexArray(Renderer.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, Renderer.VBO);
+    glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(float), ScreenCoords, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), NULL);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return true;
+}
+
+
+void fragment_render(FragmentRenderer& Renderer, const ParamsStruct& Params, const ViewModel& View, int Width, int Height)
+{
+    TRACE_SCOPE("draw");
+    // The viewport can have any shape, so the view is fitted to it
+    ViewModel Fitted = View;
+    if (Width > 0 && Height > 0)
+        view_fit_aspect(Fitted, Width, Height);
+    ViewPrecision Precision = Renderer.Precision;
+    if (Precision == ViewPrecision::VIEW_AUTO)
+        Precision = select_view_precision(Renderer.Type, Fitted, Width, Height);
+    if (Renderer.Programs[Precision] == 0)
+        Precision = ViewPrecision::VIEW_FP64;
+    Renderer.LastPrecision = Precision;
+    GLuint Shader = Renderer.Programs[Precision];
+
+    // Use the shader and send the data
+    glUseProgram(Shader);
+    glUniform1i(glGetUniformLocation(Shader, "NumIters"), Params.niters);
+    glUniform2d(glGetUniformLocation(Shader, "CenterX"), Fitted.CenterX.Hi, Fitted.CenterX.Lo);
+    glUniform2d(glGetUniformLocation(Shader, "CenterY"), Fitted.CenterY.Hi, Fitted.CenterY.Lo);
+    glUniform2d(glGetUniformLocation(Shader, "PixelSize"), 2.0 * Fitted.HalfWidth / std::max(Width, 1),
+                2.0 * Fitted.HalfHeight / std::max(Height, 1));
+    glUniform2f(glGetUniformLocation(Shader, "ViewportCenter"), 0.5f * Width, 0.5f * Height);
+    if (Renderer.Type == FractalType::JULIA)
+        glUniform1d(glGetUniformLocation(Shader, "Angle"), Params.angle);
+    else if (Renderer.Type == FractalType::NEWTON)
+    {
+        glUniform1i(glGetUniformLocation(Shader, "NumRoots"), Params.nroots);
+        glUniform1i(glGetUniformLocation(Shader, "StepForm"), (GLint)roots_buffer_step(Params.nroots));
+        glUniformBlockBinding(Shader, glGetUniformBlockIndex(Shader, "RootsBuf"), 2);
+        glBindBufferBase(GL_UNIFORM_BUFFER, 2, Renderer.RootsBuf);
+    }
+
+    // Draw
+    stage_timer().begin_gpu(STAGE_FRAGMENT, (double)Width * Height * Params.niters);
+    glBindVertexArray(Renderer.VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    stage_timer().end_gpu(STAGE_FRAGMENT);
+    glBindVertexArray(0);
+}
+
+
+void fragment_render(FragmentRenderer& Renderer, const ParamsStruct& Params, int Width, int Height)
+{
+    fragment_render(Renderer, Params, view_from_params(Params), Width, Height);
+}
+
+
+void destroy_fragment_renderer(FragmentRenderer& Renderer)
+{
+    if (Renderer.VAO != 0)
+        glDeleteVertexArrays(1, &Renderer.VAO);
+    if (Renderer.VBO != 0)
+        glDeleteBuffers(1, &Renderer.VBO);
+    for (GLuint Program : Renderer.Programs)
+    {
+        if (Program != 0)
+            glDeleteProgram(Program);
+    }
+    Renderer = FragmentRenderer();
+}
@@ -0,0 +1,279 @@
+/**
+ * @file        frame_pipeline.cpp
+ *
+ * @brief       Implementation of the asynchronous frame pipeline.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <frame_pipeline.hpp>
+#include <stage_timer.hpp>
+#include <metrics.hpp>
+#include <tracer.hpp>
+#include <iostream>
+#include <chrono>
+#include <string.h>
+
+
+typedef std::chrono::steady_clock Clock;
+
+static double seconds_since(Clock::time_point Start)
+{
+    return std::chrono::duration<double>(Clock::now() - Start).count();
+}
+
+
+FramePipeline::FramePipeline()
+    : m_Width(0), m_Height(0), m_FrameBytes(0), m_Sink(NULL), m_Head(0), m_InFlight(0), m_Pushed(0),
+      m_Stop(false), m_Failed(false), m_Frames(0), m_WaitTime(0.0), m_CopyTime(0.0),
+      m_StallTime(0.0), m_EncodeTime(0.0)
+{ }
+
+FramePipeline::~FramePipeline()
+{
+    destroy();
+}
+
+
+bool FramePipeline::create(int Width, int Height, FrameSink* Sink, int Depth)
+{
+    m_Width = Width;
+    m_Height = Height;
+    m_FrameBytes = (size_t)Width * Height * 4;
+    m_Sink = Sink;
+
+    // Shallower pipeline rather than failing, as long as a single pixel buffer fits
+    if (!m_HostBytes.reserve(MEM_STAGING, 2 * m_FrameBytes, "the encoding buffers"))
+        return false;
+    int MaxDepth = Depth;
+    while (Depth > 1 && Depth * m_FrameBytes > memory_tracker().available())
+        --Depth;
+    if (Depth < MaxDepth)
+        std::cout << "The memory budget limits the pipeline to " << Depth << " frames in flight." << std::endl;
+    if (!m_PBOBytes.reserve(MEM_BUFFERS, Depth * m_FrameBytes, "the readback buffers"))
+    {
+        m_HostBytes.release();
+        return false;
+    }
+
+    if (!m_Sink->open(Width, Height))
+    {
+        m_PBOBytes.release();
+        m_HostBytes.release();
+        return false;
+    }
+
+    m_PBOs.resize(Depth);
+    m_Fences.resize(Depth, (GLsync)0);
+    glGenBuffers(Depth, m_PBOs.data());
+    for (int i = 0; i < Depth; ++i)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBOs[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, m_FrameBytes, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (glGetError() != GL_NO_ERROR)
+    {
+        std::cerr << "Cannot allocate the readback buffers." << std::endl;
+        destroy();
+        return false;
+    }
+
+    // Two host buffers: one being filled, one being encoded
+    m_Buffers.resize(2);
+    for (int i = 0; i < 2; ++i)
+    {
+        m_Buffers[i].resize(m_FrameBytes);
+        m_FreeBuffers.push_back(i);
+    }
+
+    m_Stop = false;
+    m_Encoder = std::thread(&FramePipeline::encoder_loop, this);
+    return true;
+}
+
+
+bool FramePipeline::push(GLuint Texture)
+{
+    TRACE_SCOPE("queue_readback", m_Pushed);
+    if (m_InFlight == (int)m_PBOs.size() && !retire_oldest())
+        return false;
+
+    // The copy is queued after the commands that rendered the texture
+    glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT | GL_PIXEL_BUFFER_BARRIER_BIT);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBOs[m_Head]);
+    glBindTexture(GL_TEXTURE_2D, Texture);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    m_Fences[m_Head] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    m_Head = (m_Head + 1) % (int)m_PBOs.size();
+    ++m_InFlight;
+    ++m_Pushed;
+    metrics().set(METRIC_FRAME_QUEUE, m_InFlight);
+    return true;
+}
+
+
+bool FramePipeline::retire_oldest()
+{
+    int Slot = (m_Head - m_InFlight + (int)m_PBOs.size()) % (int)m_PBOs.size();
+    long long Index = m_Pushed - m_InFlight;
+
+    // Wait for the GPU to finish the copy
+    Clock::time_point Start = Clock::now();
+    GLenum Status;
+    {
+        TRACE_SCOPE("fence_wait", Index);
+        do
+        {
+            Status = glClientWaitSync(m_Fences[Slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ULL);
+        } while (Status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(m_Fences[Slot]);
+    m_Fences[Slot] = (GLsync)0;
+    --m_InFlight;
+    metrics().set(METRIC_FRAME_QUEUE, m_InFlight);
+    double ReadbackTime = seconds_since(Start);
+    m_WaitTime += ReadbackTime;
+    if (Status == GL_WAIT_FAILED)
+    {
+        std::cerr << "Cannot read back frame " << Index << "." << std::endl;
+        return false;
+    }
+
+    // Wait for the encoder to release a host buffer
+    Start = Clock::now();
+    int Buffer;
+    {
+        TRACE_SCOPE("encoder_stall", Index);
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_Signal.wait(Lock, [this]() { return !m_FreeBuffers.empty() || m_Failed; });
+        if (m_Failed)
+            return false;
+        Buffer = m_FreeBuffers.back();
+        m_FreeBuffers.pop_back();
+    }
+    m_StallTime += seconds_since(Start);
+
+    Start = Clock::now();
+    bool Success;
+    {
+        TRACE_SCOPE("readback", Index);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBOs[Slot]);
+        void* Mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_FrameBytes, GL_MAP_READ_BIT);
+        Success = Mapped != NULL;
+        if (Success)
+        {
+            memcpy(m_Buffers[Buffer].data(), Mapped, m_FrameBytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    double CopyTime = seconds_since(Start);
+    m_CopyTime += CopyTime;
+    stage_timer().record(STAGE_READBACK, 1000.0 * (ReadbackTime + CopyTime));
+
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    if (Success)
+        m_Queue.push_back(std::make_pair(Buffer, Index));
+    else
+        m_FreeBuffers.push_back(Buffer);
+    m_Signal.notify_all();
+    return Success;
+}
+
+
+void FramePipeline::encoder_loop()
+{
+    trace_thread_name("encoder");
+    while (true)
+    {
+        std::pair<int, long long> Item;
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            m_Signal.wait(Lock, [this]() { return !m_Queue.empty() || m_Stop; });
+            if (m_Queue.empty())
+                return;
+            Item = m_Queue.front();
+            m_Queue.pop_front();
+        }
+
+        Clock::time_point Start = Clock::now();
+        bool Success;
+        {
+            TRACE_SCOPE("write_frame", Item.second);
+            Success = m_Sink->write_frame(m_Buffers[Item.first].data(), Item.second);
+        }
+        double Elapsed = seconds_since(Start);
+        stage_timer().record(STAGE_ENCODE, 1000.0 * Elapsed);
+
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        m_EncodeTime += Elapsed;
+        m_FreeBuffers.push_back(Item.first);
+        if (Success)
+        {
+            ++m_Frames;
+            metrics().add(METRIC_FRAMES);
+        }
+        else
+            m_Failed = true;
+        m_Signal.notify_all();
+    }
+}
+
+
+bool FramePipeline::finish()
+{
+    bool Success = true;
+    while (m_InFlight > 0 && Success)
+        Success = retire_oldest();
+
+    {
+        std::lock_guard<std::mutex> Lock(m_Mutex);
+        m_Stop = true;
+        m_Signal.notify_all();
+    }
+    if (m_Encoder.joinable())
+        m_Encoder.join();
+
+    Success = Success && !m_Failed;
+    if (m_Sink != NULL)
+        Success = m_Sink->close() && Success;
+    m_Sink = NULL;
+    destroy();
+    return Success;
+}
+
+
+void FramePipeline::destroy()
+{
+    if (m_Encoder.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> Lock(m_Mutex);
+            m_Stop = true;
+            m_Signal.notify_all();
+        }
+        m_Encoder.join();
+    }
+    for (GLsync& Fence : m_Fences)
+    {
+        if (Fence != (GLsync)0)
+            glDeleteSync(Fence);
+    }
+    m_Fences.clear();
+    if (!m_PBOs.empty())
+        glDeleteBuffers((GLsizei)m_PBOs.size(), m_PBOs.data());
+    m_PBOs.clear();
+    m_InFlight = 0;
+    m_Buffers.clear();
+    m_FreeBuffers.clear();
+    m_PBOBytes.release();
+    m_HostBytes.release();
+}
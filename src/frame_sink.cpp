@@ -0,0 +1,74 @@
+/**
+ * @file        frame_sink.cpp
+ *
+ * @brief       Implementation of the frame sinks.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <frame_sink.hpp>
+#include <tracer.hpp>
+#include <metrics.hpp>
+#include <stb_image_write.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <filesystem>
+
+
+PNGSequenceSink::PNGSequenceSink(const std::string& Prefix)
+    : m_Prefix(Prefix), m_Width(0), m_Height(0)
+{ }
+
+bool PNGSequenceSink::open(int Width, int Height)
+{
+    m_Width = Width;
+    m_Height = Height;
+    m_RGB.resize((size_t)Width * Height * 3);
+    return true;
+}
+
+bool PNGSequenceSink::write_frame(const unsigned char* RGBA, long long Index)
+{
+    // Drop the alpha channel and flip the rows while copying
+    {
+        TRACE_SCOPE("rgba_to_rgb", Index);
+        for (int i = 0; i < m_Height; ++i)
+        {
+            const unsigned char* Src = RGBA + (size_t)(m_Height - 1 - i) * m_Width * 4;
+            unsigned char* Dst = m_RGB.data() + (size_t)i * m_Width * 3;
+            for (int j = 0; j < m_Width; ++j)
+            {
+                Dst[3 * j + 0] = Src[4 * j + 0];
+                Dst[3 * j + 1] = Src[4 * j + 1];
+                Dst[3 * j + 2] = Src[4 * j + 2];
+            }
+        }
+    }
+
+    std::stringstream ss;
+    ss << m_Prefix << std::setfill('0') << std::setw(5) << Index << ".png";
+    TRACE_SCOPE("encode_png", Index);
+    if (!stbi_write_png(ss.str().c_str(), m_Width, m_Height, 3, m_RGB.data(), 3 * m_Width))
+    {
+        std::cerr << "Cannot write " << ss.str() << "." << std::endl;
+        return false;
+    }
+    if (metrics().enabled())
+    {
+        std::error_code Error;
+        uintmax_t Size = std::filesystem::file_size(ss.str(), Error);
+        if (!Error)
+            metrics().add(METRIC_EXPORT_BYTES, (double)Size);
+    }
+    return true;
+}
+
+bool PNGSequenceSink::close()
+{
+    m_RGB.clear();
+    m_RGB.shrink_to_fit();
+    return true;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file        gl_utils.cpp
+ *
+ * @brief       Implementation of the utilities for loading and compiling shaders.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <gl_utils.hpp>
+#include <defines.hpp>
+#include <tracer.hpp>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+
+
+bool check_compile_errors(GLuint Shader, GLenum Type)
+{
+    int Success;
+    char Log[4096];
+
+    if (Type == GL_PROGRAM)
+        glGetProgramiv(Shader, GL_LINK_STATUS, &Success);
+    else
+        glGetShaderiv(Shader, GL_COMPILE_STATUS, &Success);
+    if (!Success)
+    {
+        std::string TypeStr;
+        switch (Type)
+        {
+        case GL_VERTEX_SHADER: TypeStr = "vertex shader"; break;
+        case GL_FRAGMENT_SHADER: TypeStr = "fragment shader"; break;
+        case GL_COMPUTE_SHADER: TypeStr = "compute shader"; break;
+        case GL_PROGRAM: TypeStr = "shader program"; break;
+
+        default:
+            break;
+        }
+        if (Type == GL_PROGRAM)
+            glGetProgramInfoLog(Shader, 4096, NULL, Log);
+        else
+            glGetShaderInfoLog(Shader, 4096, NULL, Log);
+        std::cerr << "Error compiling " << TypeStr << "." << std::endl;
+        std::cerr << "==========================================================" << std::endl;
+        std::cerr << Log << std::endl;
+        std::cerr << "==========================================================" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool read_text_file(const char* Path, std::string& Content)
+{
+    std::ifstream Stream(Path, std::ios::in);
+    if (!Stream.is_open())
+        return false;
+    std::stringstream ss;
+    ss << Stream.rdbuf();
+    Stream.close();
+    Content = ss.str();
+    return true;
+}
+
+
+const char* compute_shader_path(FractalType Type)
+{
+    switch (Type)
+    {
+    case FractalType::NEWTON: return NEWTON_COMPUTE_SHADER;
+    case FractalType::MANDELBROT: return MANDELBROT_COMPUTE_SHADER;
+    case FractalType::JULIA: return JULIA_COMPUTE_SHADER;
+
+    default:
+        return NULL;
+    }
+}
+
+const char* fragment_shader_path(FractalType Type)
+{
+    switch (Type)
+    {
+    case FractalType::NEWTON: return NEWTON_FRAGMENT_SHADER;
+    case FractalType::MANDELBROT: return MANDELBROT_FRAGMENT_SHADER;
+    case FractalType::JULIA: return JULIA_FRAGMENT_SHADER;
+
+    default:
+        return NULL;
+    }
+}
+
+
+std::string inject_defines(const std::string& Source, const std::string& Defines)
+{
+    if (Defines.empty())
+        return Source;
+    size_t LineEnd = Source.find('\n');
+    if (LineEnd == std::string::npos)
+        return Source + "\n" + Defines;
+    return Source.substr(0, LineEnd + 1) + Defines + Source.substr(LineEnd + 1);
+}
+
+
+GLuint build_compute_program(const char* Path, const std::string& Defines)
+{
+    TRACE_SCOPE("compile_shader");
+    std::string CSSource;
+    if (Path == NULL || !read_text_file(Path, CSSource))
+    {
+        std::cerr << "Cannot open the compute shader." << std::endl;
+        return 0;
+    }
+    CSSource = inject_defines(CSSource, Defines);
+    const char *CSource = CSSource.c_str();
+    GLuint CShader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(CShader, 1, &CSource, NULL);
+    glCompileShader(CShader);
+    if (!check_compile_errors(CShader, GL_COMPUTE_SHADER))
+    {
+        glDeleteShader(CShader);
+        return 0;
+    }
+    GLuint CSProgram = glCreateProgram();
+    glAttachShader(CSProgram, CShader);
+    glLinkProgram(CSProgram);
+    glDeleteShader(CShader);
+    if (!check_compile_errors(CSProgram, GL_PROGRAM))
+    {
+        glDeleteProgram(CSProgram);
+        return 0;
+    }
+    return CSProgram;
+}
+
+
+GLuint build_render_program(const char* VSource, const char* FragmentPath, const std::string& Defines)
+{
+    TRACE_SCOPE("compile_shader");
+    // Vertex shader is the same for all
+    GLuint VShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(VShader, 1, &VSource, NULL);
+    glCompileShader(VShader);
+    if (!check_compile_errors(VShader, GL_VERTEX_SHADER))
+    {
+        glDeleteShader(VShader);
+        return 0;
+    }
+
+    // Fragment shader depends on which fractal
+    std::string FSSource;
+    if (FragmentPath == NULL || !read_text_file(FragmentPath, FSSource))
+    {
+        std::cerr << "Cannot open the fragment shader." << std::endl;
+        glDeleteShader(VShader);
+        return 0;
+    }
+    FSSource = inject_defines(FSSource, Defines);
+    const char *FSource = FSSource.c_str();
+    GLuint FShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(FShader, 1, &FSource, NULL);
+    glCompileShader(FShader);
+    if (!check_compile_errors(FShader, GL_FRAGMENT_SHADER))
+    {
+        glDeleteShader(VShader);
+        glDeleteShader(FShader);
+        return 0;
+    }
+
+    GLuint Shader = glCreateProgram();
+    glAttachShader(Shader, VShader);
+    glAttachShader(Shader, FShader);
+    glLinkProgram(Shader);
+    glDeleteShader(VShader);
+    glDeleteShader(FShader);
+    if (!check_compile_errors(Shader, GL_PROGRAM))
+    {
+        glDeleteProgram(Shader);
+        return 0;
+    }
+    return Shader;
+}
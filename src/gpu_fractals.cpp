@@ -18,11 +18,34 @@
 #include <fstream>
 #include <string>
 #include <chrono>
+#include <thread>
+#include <algorithm>
 #define _USE_MATH_DEFINES
 #include <math.h>
 
 
 #include <defines.hpp>
+#include <fractal.hpp>
+#include <gl_utils.hpp>
+#include <compute_renderer.hpp>
+#include <fragment_renderer.hpp>
+#include <view_model.hpp>
+#include <stage_timer.hpp>
+#include <hud.hpp>
+#include <tracer.hpp>
+#include <tiled_export.hpp>
+#include <pyramid.hpp>
+#include <animation.hpp>
+#include <expmap.hpp>
+#include <video_stream.hpp>
+#include <cpu_renderer.hpp>
+#include <cost_map.hpp>
+#include <reference_orbit.hpp>
+#include <session.hpp>
+#include <memory_tracker.hpp>
+#include <metrics.hpp>
+#include <latency_tracker.hpp>
+#include <memory>
 
 
 
@@ -31,82 +54,29 @@ void fbcallback(GLFWwindow* Window, int Width, int Height)
     glViewport(0, 0, Width, Height);
 }
 
-
-const char *VSource = 
-"#version 440 core\n"\
-"layout(location = 0) in vec2 aPos;\n"\
-"out vec2 fPos;\n"\
-"void main() {\n"\
-"gl_Position = vec4(aPos, 0.0f, 1.0f);\n"\
-"fPos = aPos / 2.0f + 0.5f;\n"\
-"}\n";
-
-
-const float ScreenCoords[12] = {
-    // Vertex positions 
-    -1.0f,  -1.0f,
-    -1.0f,   1.0f,
-     1.0f,   1.0f,
-
-    -1.0f,  -1.0f,
-     1.0f,   1.0f,
-     1.0f,  -1.0f,
-};
-
-
-// Number of milliseconds between user actions
-const unsigned long long ActionDelay = 250;
-
-
-bool check_compile_errors(GLuint Shader, GLenum Type)
+// The input callbacks only timestamp the events, the state is sampled at the start of every frame
+void cursorcallback(GLFWwindow* Window, double, double)
 {
-    int Success;
-    char Log[4096];
-
-    glGetShaderiv(Shader, GL_COMPILE_STATUS, &Success);
-    if (!Success)
-    {
-        std::string TypeStr;
-        switch (Type)
-        {
-        case GL_VERTEX_SHADER: TypeStr = "vertex shader"; break;
-        case GL_FRAGMENT_SHADER: TypeStr = "fragment shader"; break;
-        case GL_COMPUTE_SHADER: TypeStr = "compute shader"; break;
-        case GL_PROGRAM: TypeStr = "shader program"; break;
-        
-        default:
-            break;
-        }
-        glGetShaderInfoLog(Shader, 4096, NULL, Log);
-        std::cerr << "Error compiling " << TypeStr << "." << std::endl;
-        std::cerr << "==========================================================" << std::endl;
-        std::cerr << Log << std::endl;
-        std::cerr << "==========================================================" << std::endl;
-        return false;
-    }
-    return true;
+    // Moving the cursor only changes the view while dragging
+    if (glfwGetMouseButton(Window, GLFW_MOUSE_BUTTON_1) == GLFW_PRESS ||
+        glfwGetMouseButton(Window, GLFW_MOUSE_BUTTON_2) == GLFW_PRESS)
+        latency_tracker().input_arrived(latency_tracker().now());
 }
 
-
-
-struct ParamsStruct
+void buttoncallback(GLFWwindow*, int, int, int)
 {
-    int niters      = 40;
-    int nroots      = 3;
-    double angle    = M_PI / 2.0;
-    double xlim[2]  = { -1.0, 1.0 };
-    double ylim[2]  = { -1.0, 1.0 };
-};
+    latency_tracker().input_arrived(latency_tracker().now());
+}
 
-enum FractalType
+void keycallback(GLFWwindow*, int, int, int, int)
 {
-    NEWTON,
-    JULIA,
-    MANDELBROT,
-    INVALID
-};
+    latency_tracker().input_arrived(latency_tracker().now());
+}
 
 
+// Number of milliseconds between user actions
+const unsigned long long ActionDelay = 250;
+
 
 void usage(const char* argv0, std::ostream& Stream)
 {
@@ -117,6 +87,71 @@ void usage(const char* argv0, std::ostream& Stream)
     Stream << "    used will be z^3 - 1 = 0." << std::endl;
     Stream << "    For Julia\'s set the rotation coefficient can be specified. If nothing is given, pi/2 is assumed." << std::endl;
     Stream << "    For Mandelbrot\'s set no option can be specified." << std::endl;
+    Stream << "    The following options are common to all the fractals:" << std::endl;
+    Stream << "        --niters N                      Number of iterations." << std::endl;
+    Stream << "        --view XMIN XMAX YMIN YMAX      Region of the plane to render. It is enlarged along one axis" << std::endl;
+    Stream << "                                        to match the aspect ratio of the output." << std::endl;
+    Stream << "        --center CX CY H                Region of the plane around (CX, CY), 2 * H high, with the center" << std::endl;
+    Stream << "                                        kept to about 31 digits for deep zooms. Replaces --view." << std::endl;
+    Stream << "        --size WxH                      Size of the exported images (default " << TEX_SIZE << "x" << TEX_SIZE << ")." << std::endl;
+    Stream << "        --tiled-export FILE WxH         Render a W x H image tile by tile into the binary PPM FILE," << std::endl;
+    Stream << "                                        without opening the interactive window." << std::endl;
+    Stream << "        --field-export FILE WxH         Render the raw iteration field of a W x H image into the" << std::endl;
+    Stream << "                                        compressed tiled archive FILE, without opening the window." << std::endl;
+    Stream << "        --checkpoint-interval S         Seconds between two checkpoints of the tiled export (default 60)." << std::endl;
+    Stream << "        --pyramid OUTPUT LEVELS         Render a tile pyramid with the given number of levels, without" << std::endl;
+    Stream << "                                        opening the interactive window." << std::endl;
+    Stream << "        --pyramid-layout dzi|xyz        Write OUTPUT.dzi and OUTPUT_files/ (default) or OUTPUT/z/x/y.png." << std::endl;
+    Stream << "        --pyramid-native                Render every level of the pyramid instead of downsampling." << std::endl;
+    Stream << "        --threaded-writes               Write the tiles of the pyramid with a thread pool, even where" << std::endl;
+    Stream << "                                        io_uring is available." << std::endl;
+    Stream << "        --animate KEYFRAMES N           Render N frames interpolating the keyframes in the given file," << std::endl;
+    Stream << "                                        without opening the interactive window." << std::endl;
+    Stream << "        --expmap-zoom CX CY S0 S1 N     Render N frames zooming into (CX, CY), from half height 10^S0 to" << std::endl;
+    Stream << "                                        10^S1, by resampling a log-polar strip (Mandelbrot and Julia)." << std::endl;
+    Stream << "        --frame-prefix PREFIX           Prefix of the frames of the animation (default Frame)." << std::endl;
+    Stream << "        --stream FILE                   Stream the frames of the animation as raw video to FILE, which" << std::endl;
+    Stream << "                                        can be a named pipe, or to the standard output if FILE is -." << std::endl;
+    Stream << "        --stream-format y4m|rgba        Format of the stream, YUV4MPEG2 4:2:0 (default) or raw RGBA." << std::endl;
+    Stream << "        --fps N                         Frame rate written in the header of the stream (default 60)." << std::endl;
+    Stream << "        --cost-map OUTPUT               Record the iterations of every pixel of a --size image and the" << std::endl;
+    Stream << "                                        time of every tile, without opening the interactive window." << std::endl;
+    Stream << "        --cost-format npy|csv           Write the iterations to OUTPUT.npy (default) or OUTPUT.csv." << std::endl;
+    Stream << "        --precision auto|fp32|fp64|dd   Arithmetic of the interactive view. By default the cheapest one" << std::endl;
+    Stream << "                                        that resolves the pixels at the current zoom is used." << std::endl;
+    Stream << "        --compute-arithmetic A          Arithmetic of the compute shaders: fp64, int64 (Q4.60 fixed point," << std::endl;
+    Stream << "                                        Mandelbrot and Julia) or auto (default), the faster on the GPU." << std::endl;
+    Stream << "        --newton-step S                 Form of the polynomial for Newton's step: unity (z^n - 1 by squaring)," << std::endl;
+    Stream << "                                        coefficients (Horner), roots (sum of 1 / (z - r)) or auto (default)." << std::endl;
+    Stream << "        --newton-shading                Darken Newton's fractal with the iterations taken to reach a root." << std::endl;
+    Stream << "        --record FILE                   Record the input of the interactive session to FILE." << std::endl;
+    Stream << "        --replay FILE                   Replay the session recorded in FILE, with its fractal and view," << std::endl;
+    Stream << "                                        and report the distribution of the frame times." << std::endl;
+    Stream << "        --replay-speed original|max     Replay the frames at the recorded times (default) or as fast as" << std::endl;
+    Stream << "                                        possible, without vertical sync." << std::endl;
+    Stream << "        --replay-headless               Replay the session in a hidden window." << std::endl;
+    Stream << "        --tile-size N                   Size of the tiles (default 2048 for the tiled export, 256 for" << std::endl;
+    Stream << "                                        the pyramid, 64 for the cost map)." << std::endl;
+    Stream << "        --stats                         Show the statistics at start. Batch jobs print the time spent" << std::endl;
+    Stream << "                                        in each stage at the end." << std::endl;
+    Stream << "        --trace FILE                    Record a timeline of the rendering and write it to FILE in the" << std::endl;
+    Stream << "                                        Chrome trace format when the application exits." << std::endl;
+    Stream << "        --cpu-render FILE WxH           Render a W x H image on the CPU into the PNG FILE, without" << std::endl;
+    Stream << "                                        opening the interactive window." << std::endl;
+    Stream << "        --cpu-precision P               Arithmetic of the CPU rendering: fp32, fp64, dd (double-double)," << std::endl;
+    Stream << "                                        qd (quad-double) or auto (default), the cheapest from fp64 on" << std::endl;
+    Stream << "                                        that resolves the pixels." << std::endl;
+    Stream << "        --reference-orbit FILE CX CY S  Compute the orbit of (CX, CY), given with any number of digits," << std::endl;
+    Stream << "                                        for --niters iterations in the precision of pixels 10^S apart" << std::endl;
+    Stream << "                                        into the .npy FILE, without opening the interactive window." << std::endl;
+    Stream << "        --threads N                     Threads of the CPU rendering (default all)." << std::endl;
+    Stream << "        --perf-counters                 Count cycles, instructions, branch and cache misses of every" << std::endl;
+    Stream << "                                        phase and thread of the CPU rendering (Linux only)." << std::endl;
+    Stream << "        --memory-budget MB              Limit textures, buffers and host images to MB megabytes. Tiles" << std::endl;
+    Stream << "                                        shrink to fit, and batch jobs print the peak use at the end." << std::endl;
+    Stream << "        --metrics-file FILE             Write counters and histograms of the rendering to FILE in the" << std::endl;
+    Stream << "                                        Prometheus text format, for the textfile collector." << std::endl;
+    Stream << "        --metrics-interval S            Seconds between two rewrites of the metrics file (default 15)." << std::endl;
 }
 
 
@@ -130,42 +165,606 @@ bool istreq(const std::string& s1, const std::string& s2)
         if (std::tolower(s1[i]) != std::tolower(s2[i]))
             return false;
     }
+    return true;
 }
 
 
-void export_tex(GLuint Texture)
+void export_tex(ComputeRenderer& Renderer)
 {
+    TRACE_SCOPE("export");
     static int CurFrame = 0;
-    static void* raw_image = NULL;
-    if (raw_image == NULL)
+    int Width = Renderer.Width;
+    int Height = Renderer.Height;
+    MemoryReservation ImageBytes;
+    unsigned char* CImage = NULL;
+    if (ImageBytes.reserve(MEM_STAGING, (size_t)Width * Height * 3, "the export"))
+        CImage = (unsigned char*)malloc((size_t)Width * Height * 3 * sizeof(unsigned char));
+    if (CImage == NULL)
     {
-        raw_image = malloc(TEX_SIZE * TEX_SIZE * (4 * sizeof(float) + 3 * sizeof(unsigned char)));
-        if (raw_image == NULL)
-        {
-            std::cerr << "Cannot export images." << std::endl;
-            return;
-        }
+        std::cerr << "Cannot export images." << std::endl;
+        return;
     }
-    float* FImage = (float*)raw_image;
-    unsigned char* CImage = (unsigned char*)(FImage + TEX_SIZE * TEX_SIZE * 4);
     std::stringstream ss;
     ss << "Screenshot" << std::setfill('0') << std::setw(3) << CurFrame++ << ".png";
     std::string ExportFile = ss.str();
-    glBindTexture(GL_TEXTURE_2D, Texture);
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, FImage);
-    for (register int i = 0; i < TEX_SIZE; ++i)
+    compute_readback_rgb(Renderer, CImage);
+    // Texture rows are stored bottom-up
+    {
+        CPUStageScope Scope(STAGE_ENCODE);
+        TRACE_SCOPE("encode_png");
+        stbi_write_png(ExportFile.c_str(), Width, Height, 3, CImage + (size_t)(Height - 1) * Width * 3, -3 * Width);
+    }
+    free(CImage);
+}
+
+
+InputSample sample_input(GLFWwindow* Window, double Time)
+{
+    InputSample In;
+    In.Time = Time;
+    glfwGetCursorPos(Window, &In.MouseX, &In.MouseY);
+    if (glfwGetMouseButton(Window, GLFW_MOUSE_BUTTON_1) == GLFW_PRESS)
+        In.Buttons |= INPUT_LEFT;
+    if (glfwGetMouseButton(Window, GLFW_MOUSE_BUTTON_2) == GLFW_PRESS)
+        In.Buttons |= INPUT_RIGHT;
+    if (glfwGetKey(Window, GLFW_KEY_KP_ADD) == GLFW_PRESS)
+        In.Keys |= INPUT_KEY_ADD;
+    if (glfwGetKey(Window, GLFW_KEY_KP_SUBTRACT) == GLFW_PRESS)
+        In.Keys |= INPUT_KEY_SUBTRACT;
+    if (glfwGetKey(Window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS || glfwGetKey(Window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS)
+        In.Keys |= INPUT_KEY_SHIFT;
+    if (glfwGetKey(Window, GLFW_KEY_E) == GLFW_PRESS)
+        In.Keys |= INPUT_KEY_EXPORT;
+    if (glfwGetKey(Window, GLFW_KEY_H) == GLFW_PRESS)
+        In.Keys |= INPUT_KEY_STATS;
+    if (glfwGetKey(Window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        In.Keys |= INPUT_KEY_ESCAPE;
+    return In;
+}
+
+
+/**
+ * @brief       Moves and scales the view with the mouse and changes the number of iterations.
+ *              Only the time of the samples is used, so a recorded session changes the view in
+ *              the same way when replayed.
+ *
+ * @param       View        The view, whose center keeps the precision lost by the limits in Params.
+ * @param       Params      Receives the limits of the view and the number of iterations.
+ * @param       LastAction  Time of the last action, actions are taken at most once every ActionDelay.
+ * @return      The keys of the actions left to the caller: exporting, toggling the statistics
+ *              and quitting.
+ */
+int apply_input(const InputSample& In, const InputSample& Prev, ViewModel& View, ParamsStruct& Params, double& LastAction)
+{
+    double dx = Prev.MouseX - In.MouseX;
+    double dy = Prev.MouseY - In.MouseY;
+    double UnitLength = 2.0 * sqrt(View.HalfWidth * View.HalfHeight);
+    // Movement
+    if (In.Buttons & INPUT_LEFT)
+    {
+        View.CenterX += dx * UnitLength / 600.0;
+        View.CenterY -= dy * UnitLength / 600.0;
+        view_to_params(View, Params);
+    }
+    // Zoom, scaling both half extents by the same factor to keep the aspect ratio and the sign
+    else if (In.Buttons & INPUT_RIGHT)
+    {
+        double Scale = exp(dy / 300.0);
+        View.HalfWidth *= Scale;
+        View.HalfHeight *= Scale;
+        view_to_params(View, Params);
+    }
+
+    int Actions = In.Keys & INPUT_KEY_ESCAPE;
+    if ((In.Time - LastAction) * 1000.0 >= ActionDelay)
+    {
+        bool Shift = (In.Keys & INPUT_KEY_SHIFT) != 0;
+        // Increment the number of iterations
+        if (In.Keys & INPUT_KEY_ADD)
+            Params.niters += Shift ? 10 : 1;
+        else if (In.Keys & INPUT_KEY_SUBTRACT)
+            Params.niters = std::max(Params.niters - (Shift ? 10 : 1), 0);
+        Actions |= In.Keys & (INPUT_KEY_EXPORT | INPUT_KEY_STATS);
+        LastAction = In.Time;
+    }
+    return Actions;
+}
+
+
+/**
+ * @brief       Renders the view on the CPU into a PNG file, then prints the time of every phase and,
+ *              if requested, the hardware counters of every thread.
+ *
+ * @param       View        If not NULL, the view to render, more precise than the limits in Params.
+ */
+bool cpu_render_png(FractalType Type, const ParamsStruct& Params, const ViewModel* View, const std::string& File,
+                    int Width, int Height, const CPURenderOptions& Options)
+{
+    TRACE_SCOPE("cpu_render");
+    std::vector<uint32_t> Field;
+    std::vector<unsigned char> RGB;
+    MemoryReservation ImageBytes;
+    if (!ImageBytes.reserve(MEM_IMAGES, (size_t)Width * Height * (sizeof(uint32_t) + 3), "the image"))
+        return false;
+    try
+    {
+        Field.resize((size_t)Width * Height);
+        RGB.resize((size_t)Width * Height * 3);
+    }
+    catch (const std::bad_alloc&)
+    {
+        std::cerr << "Cannot allocate a " << Width << "x" << Height << " image." << std::endl;
+        return false;
+    }
+
+    std::vector<PerfPhase> Phases;
+    CPURenderOptions Resolved = Options;
+    if (Resolved.Precision == CPUPrecision::CPU_AUTO)
+        Resolved.Precision = select_cpu_precision(View != NULL ? *View : view_from_params(Params), Width, Height);
+    std::cout << "Rendering in " << cpu_precision_name(Resolved.Precision) << " precision." << std::endl;
+    bool Rendered = View != NULL ? cpu_render_field(Type, Params, *View, Width, Height, Field.data(), Resolved, &Phases)
+                                 : cpu_render_field(Type, Params, Width, Height, Field.data(), Resolved, &Phases);
+    if (!Rendered)
+        return false;
+    cpu_colorize(Type, Params, Field.data(), Width, Height, RGB.data(), Options, &Phases);
+    {
+        TRACE_SCOPE("encode_png");
+        // Rows are stored bottom-up, as in the textures
+        if (!stbi_write_png(File.c_str(), Width, Height, 3, RGB.data() + (size_t)(Height - 1) * Width * 3, -3 * Width))
+        {
+            std::cerr << "Cannot write " << File << "." << std::endl;
+            return false;
+        }
+    }
+    perf_report(std::cout, Phases);
+    return true;
+}
+
+
+/**
+ * @brief       Formats the statistics shown by the overlay. The fragment shader is timed every frame,
+ *              the other stages at every export. The throughput assumes that every pixel uses the
+ *              whole iteration budget, so it is an upper bound for Mandelbrot's and Julia's sets.
+ */
+std::string stats_text(const FragmentRenderer& Display, int FBWidth, int FBHeight)
+{
+    double FrameMs = stage_timer().frame_ms();
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << std::left << std::setw(10) << "Frame" << std::right << std::setw(9) << FrameMs << " ms  "
+       << std::setprecision(1) << (FrameMs > 0.0 ? 1000.0 / FrameMs : 0.0) << " fps";
+    ss << std::endl << std::left << std::setw(10) << "Window" << FBWidth << "x" << FBHeight << std::right;
+    ss << std::endl << std::left << std::setw(10) << "Kernel" << view_precision_name(Display.LastPrecision)
+       << (Display.Precision == ViewPrecision::VIEW_AUTO ? " (auto)" : "") << std::right;
+    for (int s = 0; s < STAGE_COUNT; ++s)
     {
-        for (register int j = 0; j < TEX_SIZE; ++j)
+        StageStats S = stage_timer().stats((StageType)s);
+        if (S.Count == 0)
+            continue;
+        double Ms = s == STAGE_FRAGMENT ? S.AverageMs : S.LastMs;
+        ss << std::endl << std::left << std::setw(10) << stage_name((StageType)s) << std::right
+           << std::setprecision(2) << std::setw(9) << Ms << " ms";
+        if (s == STAGE_FRAGMENT && Ms > 0.0)
+            ss << "  " << S.Iterations / S.Count / (Ms * 1e6) << " Giter/s max";
+    }
+    double P50, P99;
+    if (latency_tracker().recent(P50, P99))
+        ss << std::endl << std::left << std::setw(10) << "Latency" << std::right << std::setprecision(2) << std::setw(9)
+           << P50 << " ms  p99 " << P99 << " ms";
+    ss << std::endl << std::left << std::setw(10) << "Memory" << std::right << std::setprecision(1) << std::setw(9)
+       << memory_tracker().total() / 1048576.0 << " MB  peak " << memory_tracker().total_peak() / 1048576.0 << " MB";
+    return ss.str();
+}
+
+
+struct RunOptions
+{
+    long long Width = TEX_SIZE;
+    long long Height = TEX_SIZE;
+    bool TiledExport = false;
+    TiledExportOptions Tiled;
+    bool FieldExport = false;
+    TiledExportOptions Field;
+    bool BuildPyramid = false;
+    PyramidOptions Pyramid;
+    bool Animate = false;
+    AnimationOptions Animation;
+    bool ExpMapZoom = false;
+    ExpMapOptions ExpMap;
+    std::string StreamPath;
+    VideoStreamFormat StreamFormat = VideoStreamFormat::Y4M;
+    int FPS = 60;
+    bool Stats = false;
+    std::string TracePath;
+    bool CPURender = false;
+    std::string CPUFile;
+    long long CPUWidth = 0;
+    long long CPUHeight = 0;
+    CPURenderOptions CPU;
+    bool CostMap = false;
+    CostMapOptions Cost;
+    bool ReferenceOrbit = false;
+    ReferenceOrbitOptions Orbit;
+    std::string RecordPath;
+    std::string ReplayPath;
+    bool ReplayMaxSpeed = false;
+    bool ReplayHeadless = false;
+    double MemoryBudget = 0.0;          // MB, 0 for no budget
+    std::string MetricsPath;
+    double MetricsInterval = 15.0;
+    ViewPrecision Precision = ViewPrecision::VIEW_AUTO;
+    ComputeArithmetic Arithmetic = ComputeArithmetic::COMPUTE_AUTO;
+    NewtonStep Step = NewtonStep::NEWTON_STEP_AUTO;
+    bool NewtonShading = false;
+    bool DeepView = false;              // View was given by --center
+    ViewModel View;
+};
+
+
+bool parse_size(const char* Str, long long& Width, long long& Height)
+{
+    char Sep;
+    std::stringstream ss(Str);
+    if (!(ss >> Width >> Sep >> Height) || (Sep != 'x' && Sep != 'X'))
+        return false;
+    return Width > 0 && Height > 0;
+}
+
+
+FractalType parse_options(int argc, char const* argv[], int First, FractalType Type,
+                          ParamsStruct& Params, RunOptions& Options)
+{
+    for (int i = First; i < argc; ++i)
+    {
+        if (istreq(argv[i], "--niters") && i + 1 < argc)
+        {
+            Params.niters = std::atoi(argv[++i]);
+            if (Params.niters < 0)
+            {
+                std::cerr << "Number of iterations cannot be negative." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--view") && i + 4 < argc)
+        {
+            Params.xlim[0] = std::atof(argv[++i]);
+            Params.xlim[1] = std::atof(argv[++i]);
+            Params.ylim[0] = std::atof(argv[++i]);
+            Params.ylim[1] = std::atof(argv[++i]);
+            if (Params.xlim[0] >= Params.xlim[1] || Params.ylim[0] >= Params.ylim[1])
+            {
+                std::cerr << "The view must have positive width and height." << std::endl;
+                return FractalType::INVALID;
+            }
+            // The last of --view and --center wins
+            Options.DeepView = false;
+        }
+        else if (istreq(argv[i], "--center") && i + 3 < argc)
+        {
+            Options.DeepView = true;
+            Options.View.HalfHeight = std::atof(argv[i + 3]);
+            Options.View.HalfWidth = Options.View.HalfHeight;
+            if (!parse_view_coordinate(argv[i + 1], Options.View.CenterX) ||
+                !parse_view_coordinate(argv[i + 2], Options.View.CenterY) || !(Options.View.HalfHeight > 0.0))
+            {
+                std::cerr << "The center must be given as two numbers, followed by a positive half height." << std::endl;
+                return FractalType::INVALID;
+            }
+            view_to_params(Options.View, Params);
+            i += 3;
+        }
+        else if (istreq(argv[i], "--size") && i + 1 < argc)
+        {
+            if (!parse_size(argv[++i], Options.Width, Options.Height))
+            {
+                std::cerr << "The size of the output must be given as WxH." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--tiled-export") && i + 2 < argc)
+        {
+            Options.TiledExport = true;
+            Options.Tiled.OutputFile = argv[++i];
+            if (!parse_size(argv[++i], Options.Tiled.Width, Options.Tiled.Height))
+            {
+                std::cerr << "The size of the export must be given as WxH." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--field-export") && i + 2 < argc)
+        {
+            Options.FieldExport = true;
+            Options.Field.OutputFile = argv[++i];
+            if (!parse_size(argv[++i], Options.Field.Width, Options.Field.Height))
+            {
+                std::cerr << "The size of the export must be given as WxH." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--checkpoint-interval") && i + 1 < argc)
+        {
+            Options.Tiled.CheckpointInterval = std::atof(argv[++i]);
+            if (Options.Tiled.CheckpointInterval < 0.0)
+            {
+                std::cerr << "The checkpoint interval cannot be negative." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--pyramid") && i + 2 < argc)
+        {
+            Options.BuildPyramid = true;
+            Options.Pyramid.Output = argv[++i];
+            Options.Pyramid.Levels = std::atoi(argv[++i]);
+            if (Options.Pyramid.Levels < 1)
+            {
+                std::cerr << "The pyramid needs at least one level." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--pyramid-layout") && i + 1 < argc)
+        {
+            ++i;
+            if (istreq(argv[i], "dzi"))
+                Options.Pyramid.Layout = PyramidLayout::DEEP_ZOOM;
+            else if (istreq(argv[i], "xyz"))
+                Options.Pyramid.Layout = PyramidLayout::XYZ_TILES;
+            else
+            {
+                std::cerr << "Pyramid layout must be dzi or xyz." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--animate") && i + 2 < argc)
+        {
+            Options.Animate = true;
+            Options.Animation.KeyframeFile = argv[++i];
+            Options.Animation.NFrames = std::atoll(argv[++i]);
+            if (Options.Animation.NFrames < 1)
+            {
+                std::cerr << "The animation needs at least one frame." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--expmap-zoom") && i + 5 < argc)
+        {
+            Options.ExpMapZoom = true;
+            Options.ExpMap.CenterX = std::atof(argv[++i]);
+            Options.ExpMap.CenterY = std::atof(argv[++i]);
+            Options.ExpMap.LogScaleFrom = std::atof(argv[++i]);
+            Options.ExpMap.LogScaleTo = std::atof(argv[++i]);
+            Options.ExpMap.NFrames = std::atoll(argv[++i]);
+            if (Options.ExpMap.NFrames < 1 || Options.ExpMap.LogScaleTo > Options.ExpMap.LogScaleFrom)
+            {
+                std::cerr << "The zoom needs at least one frame and must zoom in." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--frame-prefix") && i + 1 < argc)
+            Options.Animation.FramePrefix = argv[++i];
+        else if (istreq(argv[i], "--stream") && i + 1 < argc)
+            Options.StreamPath = argv[++i];
+        else if (istreq(argv[i], "--stream-format") && i + 1 < argc)
+        {
+            ++i;
+            if (istreq(argv[i], "y4m"))
+                Options.StreamFormat = VideoStreamFormat::Y4M;
+            else if (istreq(argv[i], "rgba"))
+                Options.StreamFormat = VideoStreamFormat::RAW_RGBA;
+            else
+            {
+                std::cerr << "Stream format must be y4m or rgba." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--fps") && i + 1 < argc)
+        {
+            Options.FPS = std::atoi(argv[++i]);
+            if (Options.FPS < 1)
+            {
+                std::cerr << "The frame rate must be positive." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--pyramid-native"))
+            Options.Pyramid.Downsample = false;
+        else if (istreq(argv[i], "--threaded-writes"))
+            Options.Pyramid.ThreadedWrites = true;
+        else if (istreq(argv[i], "--stats"))
+            Options.Stats = true;
+        else if (istreq(argv[i], "--trace") && i + 1 < argc)
+            Options.TracePath = argv[++i];
+        else if (istreq(argv[i], "--cpu-render") && i + 2 < argc)
+        {
+            Options.CPURender = true;
+            Options.CPUFile = argv[++i];
+            if (!parse_size(argv[++i], Options.CPUWidth, Options.CPUHeight))
+            {
+                std::cerr << "The size of the render must be given as WxH." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--reference-orbit") && i + 4 < argc)
+        {
+            Options.ReferenceOrbit = true;
+            Options.Orbit.Output = argv[++i];
+            Options.Orbit.CenterX = argv[++i];
+            Options.Orbit.CenterY = argv[++i];
+            Options.Orbit.Log10Scale = std::atof(argv[++i]);
+            if (!(Options.Orbit.Log10Scale < 0.0))
+            {
+                std::cerr << "The scale of the orbit must be a negative power of ten." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--threads") && i + 1 < argc)
+        {
+            Options.CPU.Threads = std::atoi(argv[++i]);
+            if (Options.CPU.Threads < 0)
+            {
+                std::cerr << "Number of threads cannot be negative." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--cpu-precision") && i + 1 < argc)
+        {
+            ++i;
+            if (istreq(argv[i], "auto"))
+                Options.CPU.Precision = CPUPrecision::CPU_AUTO;
+            else if (istreq(argv[i], "fp32"))
+                Options.CPU.Precision = CPUPrecision::CPU_FP32;
+            else if (istreq(argv[i], "fp64"))
+                Options.CPU.Precision = CPUPrecision::CPU_FP64;
+            else if (istreq(argv[i], "dd"))
+                Options.CPU.Precision = CPUPrecision::CPU_DOUBLE_DOUBLE;
+            else if (istreq(argv[i], "qd"))
+                Options.CPU.Precision = CPUPrecision::CPU_QUAD_DOUBLE;
+            else
+            {
+                std::cerr << "CPU precision must be auto, fp32, fp64, dd or qd." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--perf-counters"))
+            Options.CPU.Counters = true;
+        else if (istreq(argv[i], "--metrics-file") && i + 1 < argc)
+            Options.MetricsPath = argv[++i];
+        else if (istreq(argv[i], "--metrics-interval") && i + 1 < argc)
+        {
+            Options.MetricsInterval = std::atof(argv[++i]);
+            if (Options.MetricsInterval <= 0.0)
+            {
+                std::cerr << "The interval of the metrics must be positive." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--memory-budget") && i + 1 < argc)
+        {
+            Options.MemoryBudget = std::atof(argv[++i]);
+            if (Options.MemoryBudget <= 0.0)
+            {
+                std::cerr << "The memory budget must be positive." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--precision") && i + 1 < argc)
+        {
+            ++i;
+            if (istreq(argv[i], "auto"))
+                Options.Precision = ViewPrecision::VIEW_AUTO;
+            else if (istreq(argv[i], "fp32"))
+                Options.Precision = ViewPrecision::VIEW_FP32;
+            else if (istreq(argv[i], "fp64"))
+                Options.Precision = ViewPrecision::VIEW_FP64;
+            else if (istreq(argv[i], "dd"))
+                Options.Precision = ViewPrecision::VIEW_DOUBLE_DOUBLE;
+            else
+            {
+                std::cerr << "Precision must be auto, fp32, fp64 or dd." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--compute-arithmetic") && i + 1 < argc)
         {
-            for (int register k = 0; k < 3; ++k)
-                CImage[(TEX_SIZE - i - 1) * TEX_SIZE * 3 + j * 3 + k] = (unsigned char)(FImage[i * TEX_SIZE * 4 + j * 4 + k] * 255.0f);
+            ++i;
+            if (istreq(argv[i], "auto"))
+                Options.Arithmetic = ComputeArithmetic::COMPUTE_AUTO;
+            else if (istreq(argv[i], "fp64"))
+                Options.Arithmetic = ComputeArithmetic::COMPUTE_FP64;
+            else if (istreq(argv[i], "int64"))
+                Options.Arithmetic = ComputeArithmetic::COMPUTE_INT64;
+            else
+            {
+                std::cerr << "Compute arithmetic must be auto, fp64 or int64." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--newton-step") && i + 1 < argc)
+        {
+            ++i;
+            if (istreq(argv[i], "auto"))
+                Options.Step = NewtonStep::NEWTON_STEP_AUTO;
+            else if (istreq(argv[i], "unity"))
+                Options.Step = NewtonStep::NEWTON_STEP_UNITY;
+            else if (istreq(argv[i], "coefficients"))
+                Options.Step = NewtonStep::NEWTON_STEP_COEFFICIENTS;
+            else if (istreq(argv[i], "roots"))
+                Options.Step = NewtonStep::NEWTON_STEP_ROOTS;
+            else
+            {
+                std::cerr << "Newton's step must be auto, unity, coefficients or roots." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--newton-shading"))
+            Options.NewtonShading = true;
+        else if (istreq(argv[i], "--record") && i + 1 < argc)
+            Options.RecordPath = argv[++i];
+        else if (istreq(argv[i], "--replay") && i + 1 < argc)
+            Options.ReplayPath = argv[++i];
+        else if (istreq(argv[i], "--replay-speed") && i + 1 < argc)
+        {
+            ++i;
+            if (istreq(argv[i], "original"))
+                Options.ReplayMaxSpeed = false;
+            else if (istreq(argv[i], "max"))
+                Options.ReplayMaxSpeed = true;
+            else
+            {
+                std::cerr << "Replay speed must be original or max." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--replay-headless"))
+            Options.ReplayHeadless = true;
+        else if (istreq(argv[i], "--cost-map") && i + 1 < argc)
+        {
+            Options.CostMap = true;
+            Options.Cost.Output = argv[++i];
+        }
+        else if (istreq(argv[i], "--cost-format") && i + 1 < argc)
+        {
+            ++i;
+            if (istreq(argv[i], "npy"))
+                Options.Cost.Format = CostMapFormat::COST_NPY;
+            else if (istreq(argv[i], "csv"))
+                Options.Cost.Format = CostMapFormat::COST_CSV;
+            else
+            {
+                std::cerr << "Cost map format must be npy or csv." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else if (istreq(argv[i], "--tile-size") && i + 1 < argc)
+        {
+            Options.Tiled.TileSize = std::atoi(argv[++i]);
+            Options.Pyramid.TileSize = Options.Tiled.TileSize;
+            Options.Cost.TileSize = Options.Tiled.TileSize;
+            if (Options.Tiled.TileSize < 32)
+            {
+                std::cerr << "Tile size must be at least 32." << std::endl;
+                return FractalType::INVALID;
+            }
+        }
+        else
+        {
+            std::cerr << "Invalid or incomplete option " << argv[i] << "." << std::endl;
+            usage(argv[0], std::cerr);
+            return FractalType::INVALID;
         }
     }
-    stbi_write_png(ExportFile.c_str(), TEX_SIZE, TEX_SIZE, 3, CImage, 3 * TEX_SIZE);
+    return Type;
+}
+
+
+std::unique_ptr<FrameSink> create_frame_sink(const RunOptions& Options)
+{
+    if (Options.StreamPath.empty())
+        return std::unique_ptr<FrameSink>(new PNGSequenceSink(Options.Animation.FramePrefix));
+    return std::unique_ptr<FrameSink>(new VideoStreamSink(Options.StreamPath, Options.StreamFormat, Options.FPS));
 }
 
 
-FractalType parse_args(int argc, char const* argv[], ParamsStruct& Params)
+FractalType parse_args(int argc, char const* argv[], ParamsStruct& Params, RunOptions& Options)
 {
     if (argc < 2)
     {
@@ -174,9 +773,11 @@ FractalType parse_args(int argc, char const* argv[], ParamsStruct& Params)
         return FractalType::INVALID;
     }
 
+    // The optional argument of the fractal is the only one not starting with --
+    bool HasArg = argc > 2 && std::string(argv[2]).compare(0, 2, "--") != 0;
     if (istreq(argv[1], "Newton"))
     {
-        if (argc > 2)
+        if (HasArg)
         {
             Params.nroots = std::atoi(argv[2]);
             if (Params.nroots < 1)
@@ -185,13 +786,13 @@ FractalType parse_args(int argc, char const* argv[], ParamsStruct& Params)
                 return FractalType::INVALID;
             }
         }
-        return FractalType::NEWTON;
+        return parse_options(argc, argv, HasArg ? 3 : 2, FractalType::NEWTON, Params, Options);
     }
     else if (istreq(argv[1], "Julia"))
     {
-        if (argc > 2)
+        if (HasArg)
             Params.angle = std::atof(argv[2]);
-        return FractalType::JULIA;
+        return parse_options(argc, argv, HasArg ? 3 : 2, FractalType::JULIA, Params, Options);
     }
     else if (istreq(argv[1], "Mandelbrot"))
     {
@@ -199,7 +800,7 @@ FractalType parse_args(int argc, char const* argv[], ParamsStruct& Params)
         Params.xlim[1] = 1.0;
         Params.ylim[0] = -1.5;
         Params.ylim[1] = 1.5;
-        return FractalType::MANDELBROT;
+        return parse_options(argc, argv, 2, FractalType::MANDELBROT, Params, Options);
     }
     
     std::cerr << "Invalid fractal type." << std::endl;
@@ -213,9 +814,28 @@ int main(int argc, char const *argv[])
 {
     // Parse arguments
     struct ParamsStruct Params;
-    FractalType Type = parse_args(argc, argv, Params);
+    RunOptions Options;
+    FractalType Type = parse_args(argc, argv, Params, Options);
     if (Type == FractalType::INVALID)
         return -1;
+    bool Headless = Options.CPURender || Options.ReferenceOrbit || Options.CostMap || Options.TiledExport || Options.FieldExport || Options.BuildPyramid || Options.Animate || Options.ExpMapZoom;
+    // The standard output carries the video, so the messages go to the standard error
+    if (Options.StreamPath == "-")
+        std::cout.rdbuf(std::cerr.rdbuf());
+    if (!Options.TracePath.empty())
+        trace_start();
+
+    // A replayed session brings its own fractal and view
+    SessionHeader Session;
+    std::vector<SessionFrame> Replay;
+    bool Replaying = !Options.ReplayPath.empty();
+    if (Replaying)
+    {
+        if (!session_read(Options.ReplayPath, Session, Replay))
+            return -1;
+        Type = Session.Type;
+        Params = Session.Params;
+    }
 
 
     // Initialize a window
@@ -227,10 +847,25 @@ int main(int argc, char const *argv[])
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Batch jobs only need the context
+    if (Headless || (Replaying && Options.ReplayHeadless))
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     GLFWmonitor* Monitor = glfwGetPrimaryMonitor();
     const GLFWvidmode* VideoMode = glfwGetVideoMode(Monitor);
-    GLFWwindow* Window = glfwCreateWindow(800, 800, "GPU Fractals", NULL, NULL);
+    // The window has the same aspect ratio of the exported images
+    int WinWidth = 800;
+    int WinHeight = 800;
+    if (Options.Width > Options.Height)
+        WinHeight = (int)(800 * Options.Height / Options.Width);
+    else
+        WinWidth = (int)(800 * Options.Width / Options.Height);
+    if (Replaying)
+    {
+        WinWidth = Session.WinWidth;
+        WinHeight = Session.WinHeight;
+    }
+    GLFWwindow* Window = glfwCreateWindow(std::max(WinWidth, 1), std::max(WinHeight, 1), "GPU Fractals", NULL, NULL);
     if (Window == NULL)
     {
         std::cerr << "Cannot initialize a window." << std::endl;
@@ -238,6 +873,9 @@ int main(int argc, char const *argv[])
     }
     glfwMakeContextCurrent(Window);
     glfwSetFramebufferSizeCallback(Window, fbcallback);
+    glfwSetCursorPosCallback(Window, cursorcallback);
+    glfwSetMouseButtonCallback(Window, buttoncallback);
+    glfwSetKeyCallback(Window, keycallback);
 
     // Initialize GLAD
     int GLADStatus = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
@@ -247,126 +885,129 @@ int main(int argc, char const *argv[])
     }
 
 
-    // Create the shader program
-    GLuint VShader, FShader;
-    // Vertex shader is the same for all
-    VShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(VShader, 1, &VSource, NULL);
-    glCompileShader(VShader);
-    if (!check_compile_errors(VShader, GL_VERTEX_SHADER))
-        return -1;
-    // Fragment shader depends on which fractal
-    std::ifstream Stream;
-    if (Type == FractalType::NEWTON)
-        Stream.open(NEWTON_FRAGMENT_SHADER, std::ios::in);
-    else if (Type == FractalType::MANDELBROT)
-        Stream.open(MANDELBROT_FRAGMENT_SHADER, std::ios::in);
-    else if (Type == FractalType::JULIA)
-        Stream.open(JULIA_FRAGMENT_SHADER, std::ios::in);
-    if (!Stream.is_open())
+    // Run the batch job, if any
+    // The stage timer also feeds the histograms of the metrics
+    stage_timer().set_enabled(Options.Stats || !Options.MetricsPath.empty());
+    memory_tracker().set_budget((size_t)(Options.MemoryBudget * 1048576.0));
+    set_compute_arithmetic(Options.Arithmetic);
+    set_newton_step(Options.Step);
+    set_newton_shading(Options.NewtonShading);
+    if (!Options.MetricsPath.empty() && !metrics().start(Options.MetricsPath, Options.MetricsInterval))
     {
-        std::cerr << "Cannot open the compute shader." << std::endl;
+        glfwTerminate();
         return -1;
     }
-    std::stringstream ss;
-    ss << Stream.rdbuf();
-    Stream.close();
-    std::string FSSource = ss.str();
-    const char *FSource = FSSource.c_str();
-    FShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(FShader, 1, &FSource, NULL);
-    glCompileShader(FShader);
-    if (!check_compile_errors(FShader, GL_FRAGMENT_SHADER))
-        return -1;
-    GLuint Shader = glCreateProgram();
-    glAttachShader(Shader, VShader);
-    glAttachShader(Shader, FShader);
-    glLinkProgram(Shader);
-    if (!check_compile_errors(Shader, GL_PROGRAM))
-        return -1;
-
-
-    // Create the vertex buffer
-    GLuint VAO, VBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(float), ScreenCoords, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), NULL);
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    // Create the texture
-    GLuint Tex;
-    glGenTextures(1, &Tex);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, Tex);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, TEX_SIZE, TEX_SIZE, 0, GL_RGBA, GL_FLOAT, NULL);
-    glBindImageTexture(0, Tex, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
-
-
-    // Compile the compute shader
-    if (Type == FractalType::NEWTON)
-        Stream.open(NEWTON_COMPUTE_SHADER, std::ios::in);
-    else if (Type == FractalType::MANDELBROT)
-        Stream.open(MANDELBROT_COMPUTE_SHADER, std::ios::in);
-    else if (Type == FractalType::JULIA)
-        Stream.open(JULIA_COMPUTE_SHADER, std::ios::in);
-    if (!Stream.is_open())
+    if (Headless)
     {
-        std::cerr << "Cannot open the compute shader." << std::endl;
-        return -1;
+        bool Success = true;
+        if (Options.CPURender)
+        {
+            ParamsStruct CPUParams = Params;
+            fit_aspect(CPUParams, Options.CPUWidth, Options.CPUHeight);
+            ViewModel CPUView = Options.View;
+            view_fit_aspect(CPUView, Options.CPUWidth, Options.CPUHeight);
+            Success = cpu_render_png(Type, CPUParams, Options.DeepView ? &CPUView : NULL, Options.CPUFile,
+                                     (int)Options.CPUWidth, (int)Options.CPUHeight, Options.CPU);
+        }
+        if (Success && Options.ReferenceOrbit)
+        {
+            std::vector<double> Orbit;
+            Options.Orbit.Iterations = Params.niters;
+            Success = reference_orbit(Type, Params, Options.Orbit, Orbit);
+        }
+        if (Success && Options.CostMap)
+        {
+            ParamsStruct CostParams = Params;
+            Options.Cost.Width = Options.Width;
+            Options.Cost.Height = Options.Height;
+            fit_aspect(CostParams, Options.Width, Options.Height);
+            Success = cost_map_export(Type, CostParams, Options.Cost);
+        }
+        if (Success && Options.TiledExport)
+        {
+            ParamsStruct TiledParams = Params;
+            fit_aspect(TiledParams, Options.Tiled.Width, Options.Tiled.Height);
+            Success = tiled_export(Type, TiledParams, Options.Tiled);
+        }
+        if (Success && Options.FieldExport)
+        {
+            ParamsStruct FieldParams = Params;
+            fit_aspect(FieldParams, Options.Field.Width, Options.Field.Height);
+            Options.Field.TileSize = Options.Tiled.TileSize;
+            Success = tiled_field_export(Type, FieldParams, Options.Field);
+        }
+        if (Success && Options.BuildPyramid)
+        {
+            ParamsStruct PyramidParams = Params;
+            fit_aspect(PyramidParams, 1, 1);
+            Success = build_pyramid(Type, PyramidParams, Options.Pyramid);
+        }
+        if (Success && Options.Animate)
+        {
+            Options.Animation.Width = (int)Options.Width;
+            Options.Animation.Height = (int)Options.Height;
+            std::unique_ptr<FrameSink> Sink = create_frame_sink(Options);
+            Success = render_animation(Type, Params, Options.Animation, *Sink);
+        }
+        if (Success && Options.ExpMapZoom)
+        {
+            Options.ExpMap.Width = (int)Options.Width;
+            Options.ExpMap.Height = (int)Options.Height;
+            std::unique_ptr<FrameSink> Sink = create_frame_sink(Options);
+            Success = render_expmap_zoom(Type, Params, Options.ExpMap, *Sink);
+        }
+        if (Options.Stats)
+            stage_timer().report(std::cout);
+        stage_timer().destroy();
+        if (Options.Stats || Options.MemoryBudget > 0.0)
+            memory_tracker().report(std::cout);
+        if (!metrics().stop())
+            Success = false;
+        if (!Options.TracePath.empty() && trace_write(Options.TracePath))
+            std::cout << "Trace written to " << Options.TracePath << "." << std::endl;
+        else if (!Options.TracePath.empty())
+            Success = false;
+        glfwTerminate();
+        return Success ? 0 : -1;
     }
-    ss = std::stringstream();
-    ss << Stream.rdbuf();
-    Stream.close();
-    std::string CSSource = ss.str();
-    const char *CSource = CSSource.c_str();
-    GLuint CShader = glCreateShader(GL_COMPUTE_SHADER);
-    glShaderSource(CShader, 1, &CSource, NULL);
-    glCompileShader(CShader);
-    if (!check_compile_errors(CShader, GL_COMPUTE_SHADER))
-        return -1;
-    GLuint CSProgram = glCreateProgram();
-    glAttachShader(CSProgram, CShader);
-    glLinkProgram(CSProgram);
-    if (!check_compile_errors(CSProgram, GL_PROGRAM))
-        return -1;
-
 
-    // Send the compute buffers
-    GLuint ParamsBuf;
-    glGenBuffers(1, &ParamsBuf);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ParamsBuf);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Params), &Params, GL_STATIC_READ);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, ParamsBuf);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
-    double* Roots = NULL;
+    // The roots are shared by the fragment and the compute shader
     GLuint RootsBuf = 0;
-    
     if (Type == FractalType::NEWTON)
+        RootsBuf = create_roots_buffer(Params.nroots);
+
+    // Create the shader program
+    FragmentRenderer Display;
+    if (!create_fragment_renderer(Display, Type, RootsBuf))
+        return -1;
+    Display.Precision = Options.Precision;
+
+    // Create the compute shader and the texture for the exports
+    ComputeRenderer Renderer;
+    fit_aspect(Params, Options.Width, Options.Height);
+    if (!create_compute_renderer(Renderer, Type, Params, (int)Options.Width, (int)Options.Height, RootsBuf))
+        return -1;
+    // The interactive view lives in double-double, Params only gets its rounding
+    ViewModel View = view_from_params(Params);
+    // The recorded view was already fitted to the recorded exports
+    if (Replaying)
     {
-        Roots = (double*)malloc(Params.nroots * 2 * sizeof(double));
-        int i;
-        for (i = 0; i < Params.nroots; ++i)
-        {
-            double theta = 2.0 * M_PI * ((double)i / (double)Params.nroots);
-            Roots[2 * i] = cos(theta);
-            Roots[2 * i + 1] = sin(theta);
-        }
-        glGenBuffers(1, &RootsBuf);
-        glBindBuffer(GL_UNIFORM_BUFFER, RootsBuf);
-        glBufferData(GL_UNIFORM_BUFFER, 2 * Params.nroots * sizeof(double), Roots, GL_STATIC_READ);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, RootsBuf);
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        Params = Session.Params;
+        View = Session.View;
     }
+    else if (Options.DeepView)
+    {
+        View = Options.View;
+        view_fit_aspect(View, Options.Width, Options.Height);
+    }
+
+    // The overlay with the statistics
+    Hud Overlay;
+    if (!create_hud(Overlay))
+        return -1;
+    Overlay.Visible = Options.Stats;
+    std::chrono::steady_clock::time_point LastHudUpdate;
 
 
     std::cout << "Left click and move the mouse to move the view around." << std::endl;
@@ -374,124 +1015,157 @@ int main(int argc, char const *argv[])
     std::cout << "Press numpad +/- to increase/decrease the number of iterations by 1." << std::endl;
     std::cout << "Press shift + numpad +/- to increase/decrease the number of iterations by 10." << std::endl;
     std::cout << "Press E to export the view." << std::endl;
+    std::cout << "Press H to show/hide the statistics." << std::endl;
     std::cout << "Press ESC to quit the application." << std::endl;
 
 
-    double mouseX, mouseY;
-    double oldMouseX, oldMouseY;
-    glfwGetCursorPos(Window, &oldMouseX, &oldMouseY);
-    std::chrono::system_clock::time_point LastAction = std::chrono::system_clock::from_time_t(0);
+    // The input comes from the window, or from the recorded session
+    InputSample Prev;
+    glfwGetCursorPos(Window, &Prev.MouseX, &Prev.MouseY);
+    if (Replaying)
+    {
+        Prev.MouseX = Session.MouseX;
+        Prev.MouseY = Session.MouseY;
+        if (Options.ReplayMaxSpeed)
+            glfwSwapInterval(0);
+    }
+    SessionWriter Recorder;
+    if (!Options.RecordPath.empty())
+    {
+        SessionHeader Header;
+        Header.Type = Type;
+        Header.Params = Params;
+        Header.View = View;
+        glfwGetWindowSize(Window, &Header.WinWidth, &Header.WinHeight);
+        Header.MouseX = Prev.MouseX;
+        Header.MouseY = Prev.MouseY;
+        if (!session_create(Recorder, Options.RecordPath, Header))
+            return -1;
+    }
+    std::vector<double> FrameTimes;
+    long long Divergent = 0;
+
+    std::chrono::steady_clock::time_point SessionStart = std::chrono::steady_clock::now();
+    double LastAction = -1e9;
+    long long FrameIndex = 0;
     while (!glfwWindowShouldClose(Window))
     {
+        if (Replaying && FrameIndex >= (long long)Replay.size())
+            break;
+        TRACE_SCOPE("frame", FrameIndex);
+        InputSample In;
+        if (Replaying)
+        {
+            In = Replay[FrameIndex].Input;
+            if (!Options.ReplayMaxSpeed)
+                std::this_thread::sleep_until(SessionStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                                std::chrono::duration<double>(In.Time)));
+        }
+        else
+            In = sample_input(Window, std::chrono::duration<double>(std::chrono::steady_clock::now() - SessionStart).count());
+        std::chrono::steady_clock::time_point FrameStart = std::chrono::steady_clock::now();
+        // The replayed input arrives when its frame starts
+        double InputTime = latency_tracker().take_pending();
+        if (Replaying)
+            InputTime = latency_tracker().now();
+
+        ParamsStruct PrevParams = Params;
+        int Actions = apply_input(In, Prev, View, Params, LastAction);
+        Prev = In;
+        bool ViewChanged = !session_same_view(PrevParams, Params);
+        if (Replaying && !session_same_view(Params, Replay[FrameIndex].Params))
+            ++Divergent;
+        if (Recorder.Handle != NULL)
+        {
+            SessionFrame Frame;
+            Frame.Input = In;
+            Frame.Params = Params;
+            if (!session_write_frame(Recorder, Frame))
+                session_close(Recorder);
+        }
+        ++FrameIndex;
+
         // Must close?
-        if (glfwGetKey(Window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        if (Actions & INPUT_KEY_ESCAPE)
             glfwSetWindowShouldClose(Window, true);
 
-        glfwGetCursorPos(Window, &mouseX, &mouseY);
-        double dx = oldMouseX - mouseX;
-        double dy = oldMouseY - mouseY;
-        // Movement
-        if (glfwGetMouseButton(Window, GLFW_MOUSE_BUTTON_1) == GLFW_PRESS)
-        {
-            double SurfArea = (Params.xlim[1] - Params.xlim[0]) * (Params.ylim[1] - Params.ylim[0]);
-            double UnitLength = sqrt(SurfArea);
-            Params.xlim[0] += dx * UnitLength / 600.0;
-            Params.xlim[1] += dx * UnitLength / 600.0;
-            Params.ylim[0] -= dy * UnitLength / 600.0;
-            Params.ylim[1] -= dy * UnitLength / 600.0;
-        }
-        // Zoom
-        else if (glfwGetMouseButton(Window, GLFW_MOUSE_BUTTON_2) == GLFW_PRESS)
-        {
-            double SurfArea = (Params.xlim[1] - Params.xlim[0]) * (Params.ylim[1] - Params.ylim[0]);
-            double UnitLength = sqrt(SurfArea);
-            Params.xlim[1] += dy * UnitLength / 600.0;
-            Params.xlim[0] -= dy * UnitLength / 600.0;
-            Params.ylim[0] -= dy * UnitLength / 600.0;
-            Params.ylim[1] += dy * UnitLength / 600.0;
-        }
-        oldMouseX = mouseX;
-        oldMouseY = mouseY;
-
-        std::chrono::system_clock::time_point Now = std::chrono::system_clock::now();
-        unsigned long long Delay = std::chrono::duration_cast<std::chrono::milliseconds>(Now - LastAction).count();
-        if (Delay >= ActionDelay)
-        {
-            // Increment the number of iterations
-            if (glfwGetKey(Window, GLFW_KEY_KP_ADD) == GLFW_PRESS)
-            {
-                if (glfwGetKey(Window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ||
-                    glfwGetKey(Window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS)
-                    Params.niters += 10;
-                else
-                    Params.niters += 1;
-            }
-            else if (glfwGetKey(Window, GLFW_KEY_KP_SUBTRACT) == GLFW_PRESS)
-            {
-                if (glfwGetKey(Window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS ||
-                    glfwGetKey(Window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS)
-                    Params.niters -= 10;
-                else
-                    Params.niters -= 1;
-                if (Params.niters < 0)
-                    Params.niters = 0;
-            }
+        // Export
+        if (Actions & INPUT_KEY_EXPORT)
+        {
+            // The window may have a different shape than the exports
+            ViewModel ExportView = View;
+            view_fit_aspect(ExportView, Renderer.Width, Renderer.Height);
+            ParamsStruct ExportParams = Params;
+            view_to_params(ExportView, ExportParams);
+            compute_render(Renderer, ExportParams);
+            export_tex(Renderer);
+        }
 
-            // Export
-            if (glfwGetKey(Window, GLFW_KEY_E) == GLFW_PRESS)
-            {
-                glBindBuffer(GL_SHADER_STORAGE_BUFFER, ParamsBuf);
-                glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Params), &Params, GL_STATIC_READ);
-                glUseProgram(CSProgram);
-                glDispatchCompute((TEX_SIZE + 31) / 32, (TEX_SIZE + 31) / 32, 1);
-                glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-                glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
-
-                export_tex(Tex);
-            }
-            LastAction = Now;
+        // Statistics
+        if (Actions & INPUT_KEY_STATS)
+        {
+            Overlay.Visible = !Overlay.Visible;
+            stage_timer().set_enabled(Overlay.Visible || metrics().enabled());
         }
 
         // Clear the window
         glClear(GL_COLOR_BUFFER_BIT);
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
-        // Use the shader and send the data
-        glUseProgram(Shader);
-        glUniform1i(glGetUniformLocation(Shader, "NumIters"), Params.niters);
-        glUniform2dv(glGetUniformLocation(Shader, "XLim"), 1, Params.xlim);
-        glUniform2dv(glGetUniformLocation(Shader, "YLim"), 1, Params.ylim);
-        if (Type == FractalType::JULIA)
-            glUniform1d(glGetUniformLocation(Shader, "Angle"), Params.angle);
-        else if (Type == FractalType::NEWTON)
+        // Draw, fitting the view to the current shape of the window
+        int FBWidth, FBHeight;
+        glfwGetFramebufferSize(Window, &FBWidth, &FBHeight);
+        fragment_render(Display, Params, View, FBWidth, FBHeight);
+        stage_timer().end_frame();
+
+        // The text is refreshed a few times per second to stay readable
+        if (Overlay.Visible && std::chrono::steady_clock::now() - LastHudUpdate > std::chrono::milliseconds(250))
         {
-            glUniform1i(glGetUniformLocation(Shader, "NumRoots"), Params.nroots);
-            glUniformBlockBinding(Shader, glGetUniformBlockIndex(Shader, "RootsBuf"), 2);
-            glBindBufferBase(GL_UNIFORM_BUFFER, 2, RootsBuf);
+            hud_set_text(Overlay, stats_text(Display, FBWidth, FBHeight));
+            LastHudUpdate = std::chrono::steady_clock::now();
         }
+        hud_draw(Overlay, FBWidth, FBHeight);
 
-
-        // Draw
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-
-
-        glfwSwapBuffers(Window);
+        {
+            TRACE_SCOPE("swap_buffers");
+            glfwSwapBuffers(Window);
+        }
+        // The first frame showing a change of the view closes the latency of the input behind it
+        if (ViewChanged && InputTime >= 0.0)
+            latency_tracker().frame_presented(InputTime);
+        latency_tracker().poll(false);
+        // Replayed frames are timed until the GPU is done with them
+        if (Replaying)
+        {
+            glFinish();
+            FrameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - FrameStart).count());
+        }
         glfwPollEvents();
     }
 
+    if (Replaying)
+    {
+        std::cout << "Replayed " << Options.ReplayPath << ": ";
+        frame_time_report(std::cout, FrameTimes);
+        if (Divergent > 0)
+            std::cout << "The view differs from the recorded one in " << Divergent << " frames." << std::endl;
+    }
+    if (Replaying || Options.Stats)
+        latency_tracker().report(std::cout);
+    session_close(Recorder);
+
 
     // Free memory
-    if (Roots != NULL)
-        free(Roots);
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &ParamsBuf);
+    destroy_compute_renderer(Renderer);
+    destroy_fragment_renderer(Display);
+    destroy_hud(Overlay);
+    stage_timer().destroy();
+    latency_tracker().destroy();
+    metrics().stop();
+    if (!Options.TracePath.empty())
+        trace_write(Options.TracePath);
     if (RootsBuf > 0)
         glDeleteBuffers(1, &RootsBuf);
-    glDeleteProgram(Shader);
 
 
     // Close GLFW
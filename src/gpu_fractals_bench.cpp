@@ -0,0 +1,1026 @@
+/**
+ * @file        gpu_fractals_bench.cpp
+ *
+ * @brief       Renders a fixed catalogue of views with every backend and reports their throughput.
+ *
+ * @details     Every view of the catalogue is rendered a fixed number of times by every backend,
+ *              after a few warm-up frames, waiting for the GPU after each frame. The results are
+ *              written as JSON, one result per line, and can be compared against the results of a
+ *              previous run to spot regressions. In accuracy mode, the iteration fields of every
+ *              precision are instead compared against a quad-double reference rendered on the CPU.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <fractal.hpp>
+#include <compute_renderer.hpp>
+#include <fragment_renderer.hpp>
+#include <tracer.hpp>
+#include <stage_timer.hpp>
+#include <cpu_renderer.hpp>
+
+
+struct BenchView
+{
+    const char* Name;
+    FractalType Type;
+    ParamsStruct Params;
+};
+
+
+struct BenchOptions
+{
+    int Width           = 1920;
+    int Height          = 1080;
+    int Frames          = 50;
+    int Warmup          = 5;
+    std::string Backend;                // Only run this backend, if not empty
+    std::string View;                   // Only run this view, if not empty
+    std::string OutputFile;             // Standard output if empty
+    std::string BaselineFile;           // Compare against this file, if not empty
+    std::string TraceFile;              // Record a trace, if not empty
+    bool Counters       = false;        // Collect the hardware counters of the CPU backend
+    bool Accuracy       = false;        // Compare the precisions instead of the backends
+    double Threshold    = 10.0;         // Percentage
+};
+
+
+struct BenchResult
+{
+    std::string View;
+    std::string Backend;
+    double MPixPerSec   = 0.0;
+    double GItersPerSec = 0.0;
+    double P50          = 0.0;          // Milliseconds
+    double P99          = 0.0;          // Milliseconds
+    double PeakRSS      = 0.0;          // Megabytes
+    double DeviceMemory = 0.0;          // Megabytes
+    PerfSample Counters;                // Per frame, only for the CPU backend
+};
+
+
+std::vector<BenchView> catalogue()
+{
+    std::vector<BenchView> Views;
+
+    BenchView Mandelbrot = { "mandelbrot_full", FractalType::MANDELBROT, ParamsStruct() };
+    Mandelbrot.Params.niters = 1000;
+    Mandelbrot.Params.xlim[0] = -2.2;   Mandelbrot.Params.xlim[1] = 0.8;
+    Mandelbrot.Params.ylim[0] = -1.2;   Mandelbrot.Params.ylim[1] = 1.2;
+    Views.push_back(Mandelbrot);
+
+    // Dominated by points close to the boundary, where the escape time varies the most
+    BenchView Seahorse = { "seahorse_valley", FractalType::MANDELBROT, ParamsStruct() };
+    Seahorse.Params.niters = 10000;
+    Seahorse.Params.xlim[0] = -0.743643887 - 0.002;     Seahorse.Params.xlim[1] = -0.743643887 + 0.002;
+    Seahorse.Params.ylim[0] = 0.131825904 - 0.002;      Seahorse.Params.ylim[1] = 0.131825904 + 0.002;
+    Views.push_back(Seahorse);
+
+    BenchView Julia = { "julia_default", FractalType::JULIA, ParamsStruct() };
+    Julia.Params.niters = 1000;
+    Julia.Params.angle = M_PI / 2.0;
+    Julia.Params.xlim[0] = -1.5;        Julia.Params.xlim[1] = 1.5;
+    Julia.Params.ylim[0] = -1.5;        Julia.Params.ylim[1] = 1.5;
+    Views.push_back(Julia);
+
+    const int NRoots[] = { 3, 7, 20 };
+    const char* NewtonNames[] = { "newton_3", "newton_7", "newton_20" };
+    for (int i = 0; i < 3; ++i)
+    {
+        BenchView Newton = { NewtonNames[i], FractalType::NEWTON, ParamsStruct() };
+        Newton.Params.nroots = NRoots[i];
+        Views.push_back(Newton);
+    }
+
+    return Views;
+}
+
+
+/**
+ * @brief       A way of rendering a view. Every call to render returns once the frame is complete.
+ */
+class BenchBackend
+{
+public:
+    virtual ~BenchBackend() { }
+
+    virtual const char* name() const = 0;
+    virtual bool create(const BenchView& View, const ParamsStruct& Params, int Width, int Height, GLuint RootsBuf) = 0;
+    virtual void render(const ParamsStruct& Params) = 0;
+    virtual void destroy() = 0;
+
+    /**
+     * @brief   Bytes allocated on the device by the backend, besides the shaders.
+     */
+    virtual size_t device_bytes() const = 0;
+
+    /**
+     * @brief   Whether the backend runs when no backend is selected.
+     */
+    virtual bool by_default() const { return true; }
+
+    /**
+     * @brief   The phases of all the frames rendered since create, if the backend records them.
+     */
+    virtual const std::vector<PerfPhase>* phases() const { return NULL; }
+};
+
+
+class ComputeBackend : public BenchBackend
+{
+public:
+    ComputeBackend(const char* Name, ComputeArithmetic Arithmetic) : m_Name(Name), m_Arithmetic(Arithmetic) { }
+
+    const char* name() const override { return m_Name; }
+
+    bool create(const BenchView& View, const ParamsStruct& Params, int Width, int Height, GLuint RootsBuf) override
+    {
+        return create_compute_renderer(m_Renderer, View.Type, Params, Width, Height, RootsBuf, m_Arithmetic);
+    }
+
+    void render(const ParamsStruct& Params) override
+    {
+        compute_render(m_Renderer, Params);
+        glFinish();
+    }
+
+    void destroy() override { destroy_compute_renderer(m_Renderer); }
+
+    size_t device_bytes() const override
+    {
+        return (size_t)m_Renderer.Width * m_Renderer.Height * 4 * sizeof(float) + sizeof(ParamsStruct);
+    }
+
+    /**
+     * @brief   The arithmetics forced one at a time only run when selected.
+     */
+    bool by_default() const override { return m_Arithmetic == ComputeArithmetic::COMPUTE_AUTO; }
+
+private:
+    const char* m_Name;
+    ComputeArithmetic m_Arithmetic;
+    ComputeRenderer m_Renderer;
+};
+
+
+class FragmentBackend : public BenchBackend
+{
+public:
+    FragmentBackend() : m_FBO(0), m_Color(0), m_Width(0), m_Height(0) { }
+
+    const char* name() const override { return "fragment"; }
+
+    bool create(const BenchView& View, const ParamsStruct&, int Width, int Height, GLuint RootsBuf) override
+    {
+        m_Width = Width;
+        m_Height = Height;
+        if (!create_fragment_renderer(m_Renderer, View.Type, RootsBuf))
+            return false;
+
+        // The window is hidden, so the frames are drawn into an off-screen framebuffer
+        glGenTextures(1, &m_Color);
+        glBindTexture(GL_TEXTURE_2D, m_Color);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, Width, Height);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glGenFramebuffers(1, &m_FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_Color, 0);
+        bool Complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!Complete)
+        {
+            std::cerr << "Cannot create a " << Width << "x" << Height << " framebuffer." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void render(const ParamsStruct& Params) override
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+        glViewport(0, 0, m_Width, m_Height);
+        fragment_render(m_Renderer, Params, m_Width, m_Height);
+        glFinish();
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void destroy() override
+    {
+        destroy_fragment_renderer(m_Renderer);
+        if (m_FBO != 0)
+            glDeleteFramebuffers(1, &m_FBO);
+        if (m_Color != 0)
+            glDeleteTextures(1, &m_Color);
+        m_FBO = m_Color = 0;
+    }
+
+    size_t device_bytes() const override { return (size_t)m_Width * m_Height * 4; }
+
+private:
+    FragmentRenderer m_Renderer;
+    GLuint m_FBO;
+    GLuint m_Color;
+    int m_Width;
+    int m_Height;
+};
+
+
+/**
+ * @brief       The native renderer, as a reference for the GPU backends. It is orders of magnitude
+ *              slower, so it only runs when selected.
+ */
+class CPUBackend : public BenchBackend
+{
+public:
+    explicit CPUBackend(bool Counters) : m_Type(FractalType::INVALID), m_Width(0), m_Height(0)
+    {
+        m_Options.Counters = Counters;
+    }
+
+    const char* name() const override { return "cpu"; }
+
+    bool create(const BenchView& View, const ParamsStruct&, int Width, int Height, GLuint) override
+    {
+        m_Type = View.Type;
+        m_Width = Width;
+        m_Height = Height;
+        m_Field.resize((size_t)Width * Height);
+        m_RGB.resize((size_t)Width * Height * 3);
+        m_Phases.clear();
+        return true;
+    }
+
+    void render(const ParamsStruct& Params) override
+    {
+        std::vector<PerfPhase> Phases;
+        cpu_render_field(m_Type, Params, m_Width, m_Height, m_Field.data(), m_Options, &Phases);
+        cpu_colorize(m_Type, Params, m_Field.data(), m_Width, m_Height, m_RGB.data(), m_Options, &Phases);
+        perf_merge(m_Phases, Phases);
+    }
+
+    void destroy() override
+    {
+        m_Field = std::vector<uint32_t>();
+        m_RGB = std::vector<unsigned char>();
+    }
+
+    size_t device_bytes() const override { return 0; }
+
+    bool by_default() const override { return false; }
+
+    const std::vector<PerfPhase>* phases() const override { return &m_Phases; }
+
+private:
+    CPURenderOptions m_Options;
+    FractalType m_Type;
+    int m_Width;
+    int m_Height;
+    std::vector<uint32_t> m_Field;
+    std::vector<unsigned char> m_RGB;
+    std::vector<PerfPhase> m_Phases;
+};
+
+
+std::vector<std::unique_ptr<BenchBackend>> available_backends(const BenchOptions& Options)
+{
+    std::vector<std::unique_ptr<BenchBackend>> Backends;
+    Backends.emplace_back(new ComputeBackend("compute", ComputeArithmetic::COMPUTE_AUTO));
+    Backends.emplace_back(new ComputeBackend("compute_fp64", ComputeArithmetic::COMPUTE_FP64));
+    Backends.emplace_back(new ComputeBackend("compute_int64", ComputeArithmetic::COMPUTE_INT64));
+    Backends.emplace_back(new FragmentBackend());
+    Backends.emplace_back(new CPUBackend(Options.Counters));
+    return Backends;
+}
+
+
+/**
+ * @brief       A way of rendering the iteration field of a view, for the accuracy mode. Every call
+ *              to render returns once the field is complete.
+ */
+class FieldBackend
+{
+public:
+    virtual ~FieldBackend() { }
+
+    virtual const char* name() const = 0;
+    virtual bool create(const BenchView& View, const ParamsStruct& Params, int Width, int Height) = 0;
+    virtual void render(const ParamsStruct& Params) = 0;
+    virtual void read_field(uint32_t* Field) = 0;
+    virtual void destroy() = 0;
+};
+
+
+class GPUFieldBackend : public FieldBackend
+{
+public:
+    GPUFieldBackend(const char* Name, ComputeArithmetic Arithmetic) : m_Name(Name), m_Arithmetic(Arithmetic) { }
+
+    const char* name() const override { return m_Name; }
+
+    bool create(const BenchView& View, const ParamsStruct& Params, int Width, int Height) override
+    {
+        return create_field_renderer(m_Renderer, View.Type, Params, Width, Height, 0, m_Arithmetic);
+    }
+
+    void render(const ParamsStruct& Params) override
+    {
+        compute_render(m_Renderer, Params);
+        glFinish();
+    }
+
+    void read_field(uint32_t* Field) override { compute_readback_field(m_Renderer, Field); }
+
+    void destroy() override { destroy_compute_renderer(m_Renderer); }
+
+private:
+    const char* m_Name;
+    ComputeArithmetic m_Arithmetic;
+    ComputeRenderer m_Renderer;
+};
+
+
+class CPUFieldBackend : public FieldBackend
+{
+public:
+    CPUFieldBackend(const char* Name, CPUPrecision Precision)
+        : m_Name(Name), m_Type(FractalType::INVALID), m_Width(0), m_Height(0)
+    {
+        m_Options.Precision = Precision;
+    }
+
+    const char* name() const override { return m_Name; }
+
+    bool create(const BenchView& View, const ParamsStruct&, int Width, int Height) override
+    {
+        m_Type = View.Type;
+        m_Width = Width;
+        m_Height = Height;
+        m_Field.resize((size_t)Width * Height);
+        return true;
+    }
+
+    void render(const ParamsStruct& Params) override
+    {
+        cpu_render_field(m_Type, Params, m_Width, m_Height, m_Field.data(), m_Options);
+    }
+
+    void read_field(uint32_t* Field) override { std::copy(m_Field.begin(), m_Field.end(), Field); }
+
+    void destroy() override { m_Field = std::vector<uint32_t>(); }
+
+private:
+    const char* m_Name;
+    CPURenderOptions m_Options;
+    FractalType m_Type;
+    int m_Width;
+    int m_Height;
+    std::vector<uint32_t> m_Field;
+};
+
+
+/**
+ * @brief       The precisions compared by the accuracy mode. The last one is the reference.
+ */
+std::vector<std::unique_ptr<FieldBackend>> field_backends()
+{
+    std::vector<std::unique_ptr<FieldBackend>> Backends;
+    Backends.emplace_back(new GPUFieldBackend("gpu_fp64", ComputeArithmetic::COMPUTE_FP64));
+    // Newton's fractal has no fixed-point kernel, there gpu_int64 repeats gpu_fp64
+    if (compute_int64_supported())
+        Backends.emplace_back(new GPUFieldBackend("gpu_int64", ComputeArithmetic::COMPUTE_INT64));
+    Backends.emplace_back(new CPUFieldBackend("cpu_fp32", CPUPrecision::CPU_FP32));
+    Backends.emplace_back(new CPUFieldBackend("cpu_fp64", CPUPrecision::CPU_FP64));
+    Backends.emplace_back(new CPUFieldBackend("cpu_dd", CPUPrecision::CPU_DOUBLE_DOUBLE));
+    Backends.emplace_back(new CPUFieldBackend("cpu_qd", CPUPrecision::CPU_QUAD_DOUBLE));
+    return Backends;
+}
+
+
+/**
+ * @brief       Peak resident memory of the process, in bytes.
+ */
+size_t peak_rss_bytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS Counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &Counters, sizeof(Counters)))
+        return Counters.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage Usage;
+    if (getrusage(RUSAGE_SELF, &Usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return (size_t)Usage.ru_maxrss;
+#else
+    return (size_t)Usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+
+/**
+ * @brief       Counts the iterations executed to render the view, from its map of iteration costs.
+ *              Points of Mandelbrot's and Julia's sets that do not escape cost the whole budget,
+ *              while points of Newton's fractal stop as soon as they converge or fall in a cycle.
+ */
+double count_iterations(const BenchView& View, const ParamsStruct& Params, int Width, int Height, GLuint RootsBuf)
+{
+    ComputeRenderer Costs;
+    if (!create_cost_renderer(Costs, View.Type, Params, Width, Height, RootsBuf))
+        return (double)Width * Height * Params.niters;
+    compute_render(Costs, Params);
+    std::vector<uint32_t> Values((size_t)Width * Height);
+    compute_readback_field(Costs, Values.data());
+    destroy_compute_renderer(Costs);
+
+    double Iterations = 0.0;
+    for (uint32_t V : Values)
+        Iterations += V & ~CostUnfinished;
+    return Iterations;
+}
+
+
+bool run_view(BenchBackend& Backend, const BenchView& View, const BenchOptions& Options, BenchResult& Result)
+{
+    ParamsStruct Params = View.Params;
+    fit_aspect(Params, Options.Width, Options.Height);
+
+    GLuint RootsBuf = 0;
+    if (View.Type == FractalType::NEWTON)
+        RootsBuf = create_roots_buffer(Params.nroots);
+
+    bool Success = Backend.create(View, Params, Options.Width, Options.Height, RootsBuf);
+    if (Success)
+    {
+        for (int i = 0; i < Options.Warmup; ++i)
+            Backend.render(Params);
+
+        std::vector<double> Times(Options.Frames);
+        for (int i = 0; i < Options.Frames; ++i)
+        {
+            TRACE_SCOPE("frame", i);
+            auto Start = std::chrono::steady_clock::now();
+            Backend.render(Params);
+            Times[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+        }
+        std::sort(Times.begin(), Times.end());
+
+        double Pixels = (double)Options.Width * Options.Height;
+        double Iterations = count_iterations(View, Params, Options.Width, Options.Height, RootsBuf);
+        Result.View = View.Name;
+        Result.Backend = Backend.name();
+        Result.P50 = percentile(Times, 50.0);
+        Result.P99 = percentile(Times, 99.0);
+        Result.MPixPerSec = Pixels / (Result.P50 * 1e3);
+        Result.GItersPerSec = Iterations / (Result.P50 * 1e6);
+        Result.PeakRSS = peak_rss_bytes() / 1048576.0;
+        Result.DeviceMemory = Backend.device_bytes() / 1048576.0;
+
+        // The counters include the warm-up frames, so they are averaged over all the frames
+        const std::vector<PerfPhase>* Phases = Backend.phases();
+        if (Phases != NULL && Options.Counters)
+        {
+            for (const PerfPhase& P : *Phases)
+                Result.Counters.add(P.total());
+            for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+                Result.Counters.Values[c] /= (double)(Options.Warmup + Options.Frames);
+            std::cerr << "Counters of " << View.Name << " over " << Options.Warmup + Options.Frames << " frames:" << std::endl;
+            perf_report(std::cerr, *Phases);
+        }
+    }
+    Backend.destroy();
+    if (RootsBuf != 0)
+        glDeleteBuffers(1, &RootsBuf);
+    return Success;
+}
+
+
+struct AccuracyResult
+{
+    std::string View;
+    std::string Backend;
+    bool Newton             = false;
+    double MPixPerSec       = 0.0;
+    double MismatchRate     = 0.0;      // Fraction of the pixels that differ from the reference
+    double MaxIterError     = 0.0;      // Escape-time fractals only
+    double MeanIterError    = 0.0;      // Escape-time fractals only
+};
+
+
+/**
+ * @brief       Compares a field against the reference. Points that never escape count as escaping
+ *              one iteration past the budget. For Newton's fractal, the mismatches are the points
+ *              classified to a different root.
+ */
+void compare_fields(const std::vector<uint32_t>& Reference, const std::vector<uint32_t>& Field, int NIters,
+                    AccuracyResult& Result)
+{
+    long long Mismatches = 0;
+    double MaxError = 0.0, TotalError = 0.0;
+    for (size_t p = 0; p < Field.size(); ++p)
+    {
+        if (Field[p] == Reference[p])
+            continue;
+        ++Mismatches;
+        if (Result.Newton)
+            continue;
+        double V = Field[p] == 0 ? NIters + 1.0 : (double)Field[p];
+        double R = Reference[p] == 0 ? NIters + 1.0 : (double)Reference[p];
+        MaxError = std::max(MaxError, fabs(V - R));
+        TotalError += fabs(V - R);
+    }
+    double Pixels = (double)std::max(Field.size(), (size_t)1);
+    Result.MismatchRate = Mismatches / Pixels;
+    Result.MaxIterError = MaxError;
+    Result.MeanIterError = TotalError / Pixels;
+}
+
+
+/**
+ * @brief       Renders a view with a precision a few times, returning the median time in
+ *              milliseconds and the field.
+ */
+bool time_field(FieldBackend& Backend, const BenchView& View, const ParamsStruct& Params, const BenchOptions& Options,
+                int Runs, std::vector<uint32_t>& Field, double& Ms)
+{
+    if (!Backend.create(View, Params, Options.Width, Options.Height))
+    {
+        Backend.destroy();
+        return false;
+    }
+    std::vector<double> Times(Runs);
+    for (int i = 0; i < Runs; ++i)
+    {
+        TRACE_SCOPE("frame", i);
+        auto Start = std::chrono::steady_clock::now();
+        Backend.render(Params);
+        Times[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+    }
+    std::sort(Times.begin(), Times.end());
+    Ms = percentile(Times, 50.0);
+    Field.resize((size_t)Options.Width * Options.Height);
+    Backend.read_field(Field.data());
+    Backend.destroy();
+    return true;
+}
+
+
+/**
+ * @brief       Renders every view of the catalogue with every precision and compares their
+ *              iteration fields against the quad-double reference.
+ */
+bool run_accuracy(const BenchOptions& Options, std::vector<AccuracyResult>& Results)
+{
+    // The CPU precisions are far slower than the GPU, so they are timed on a few frames only
+    const int Runs = std::min(Options.Frames, 3);
+    bool Success = true;
+    std::vector<std::unique_ptr<FieldBackend>> Backends = field_backends();
+    for (const BenchView& View : catalogue())
+    {
+        if (!Options.View.empty() && Options.View != View.Name)
+            continue;
+        ParamsStruct Params = View.Params;
+        fit_aspect(Params, Options.Width, Options.Height);
+
+        std::cerr << "Rendering the reference of " << View.Name << "..." << std::endl;
+        FieldBackend& Ref = *Backends.back();
+        std::vector<uint32_t> Reference;
+        double RefMs;
+        if (!time_field(Ref, View, Params, Options, 1, Reference, RefMs))
+        {
+            Success = false;
+            continue;
+        }
+
+        for (std::unique_ptr<FieldBackend>& Backend : Backends)
+        {
+            if (!Options.Backend.empty() && Options.Backend != Backend->name())
+                continue;
+            AccuracyResult Result;
+            Result.View = View.Name;
+            Result.Backend = Backend->name();
+            Result.Newton = View.Type == FractalType::NEWTON;
+            std::vector<uint32_t> Field;
+            double Ms = RefMs;
+            if (Backend.get() != &Ref)
+            {
+                std::cerr << "Running " << View.Name << " on " << Backend->name() << "..." << std::endl;
+                if (!time_field(*Backend, View, Params, Options, Runs, Field, Ms))
+                {
+                    std::cerr << "Cannot run " << View.Name << " on " << Backend->name() << "." << std::endl;
+                    Success = false;
+                    continue;
+                }
+                compare_fields(Reference, Field, Params.niters, Result);
+            }
+            Result.MPixPerSec = (double)Options.Width * Options.Height / (Ms * 1e3);
+            Results.push_back(Result);
+        }
+    }
+    return Success;
+}
+
+
+void write_accuracy_json(std::ostream& Stream, const BenchOptions& Options, const std::vector<AccuracyResult>& Results)
+{
+    const char* Renderer = (const char*)glGetString(GL_RENDERER);
+    Stream << "{" << std::endl;
+    Stream << "  \"renderer\": \"" << (Renderer != NULL ? Renderer : "unknown") << "\"," << std::endl;
+    Stream << "  \"width\": " << Options.Width << ", \"height\": " << Options.Height
+           << ", \"reference\": \"cpu_qd\"," << std::endl;
+    Stream << "  \"accuracy\": [" << std::endl;
+    Stream << std::fixed << std::setprecision(6);
+    for (size_t i = 0; i < Results.size(); ++i)
+    {
+        const AccuracyResult& R = Results[i];
+        Stream << "    { \"view\": \"" << R.View << "\", \"backend\": \"" << R.Backend << "\""
+               << ", \"mpix_per_s\": " << R.MPixPerSec;
+        if (R.Newton)
+            Stream << ", \"root_disagreement\": " << R.MismatchRate;
+        else
+            Stream << ", \"mismatch_rate\": " << R.MismatchRate
+                   << ", \"max_iter_error\": " << R.MaxIterError
+                   << ", \"mean_iter_error\": " << R.MeanIterError;
+        Stream << " }" << (i + 1 < Results.size() ? "," : "") << std::endl;
+    }
+    Stream << "  ]" << std::endl;
+    Stream << "}" << std::endl;
+}
+
+
+/**
+ * @brief       Prints the accuracy of every precision next to its throughput.
+ */
+void accuracy_report(std::ostream& Stream, const std::vector<AccuracyResult>& Results)
+{
+    std::ios::fmtflags Flags = Stream.flags();
+    Stream << std::left << std::setw(18) << "View" << std::setw(10) << "Backend" << std::right << std::setw(10) << "MP/s"
+           << std::setw(12) << "Mismatch %" << std::setw(10) << "Max err" << std::setw(10) << "Mean err" << std::endl;
+    for (const AccuracyResult& R : Results)
+    {
+        Stream << std::left << std::setw(18) << R.View << std::setw(10) << R.Backend << std::right << std::fixed
+               << std::setprecision(1) << std::setw(10) << R.MPixPerSec << std::setprecision(3) << std::setw(12)
+               << 100.0 * R.MismatchRate;
+        if (R.Newton)
+            Stream << std::setw(10) << "-" << std::setw(10) << "-";
+        else
+            Stream << std::setprecision(0) << std::setw(10) << R.MaxIterError << std::setprecision(3) << std::setw(10)
+                   << R.MeanIterError;
+        Stream << std::endl;
+    }
+    Stream.flags(Flags);
+}
+
+
+void write_json(std::ostream& Stream, const BenchOptions& Options, const std::vector<BenchResult>& Results)
+{
+    const char* Renderer = (const char*)glGetString(GL_RENDERER);
+    Stream << "{" << std::endl;
+    Stream << "  \"renderer\": \"" << (Renderer != NULL ? Renderer : "unknown") << "\"," << std::endl;
+    Stream << "  \"width\": " << Options.Width << ", \"height\": " << Options.Height
+           << ", \"frames\": " << Options.Frames << "," << std::endl;
+    Stream << "  \"results\": [" << std::endl;
+    Stream << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < Results.size(); ++i)
+    {
+        const BenchResult& R = Results[i];
+        Stream << "    { \"view\": \"" << R.View << "\", \"backend\": \"" << R.Backend << "\""
+               << ", \"mpix_per_s\": " << R.MPixPerSec
+               << ", \"giters_per_s\": " << R.GItersPerSec
+               << ", \"p50_ms\": " << R.P50
+               << ", \"p99_ms\": " << R.P99
+               << ", \"peak_rss_mb\": " << R.PeakRSS
+               << ", \"device_mb\": " << R.DeviceMemory;
+        // Counters that could not be collected are left out
+        const PerfSample& C = R.Counters;
+        double Pixels = (double)Options.Width * Options.Height;
+        if (C.Valid[PERF_CYCLES] && C.Valid[PERF_INSTRUCTIONS] && C.Values[PERF_CYCLES] > 0.0)
+            Stream << ", \"ipc\": " << C.Values[PERF_INSTRUCTIONS] / C.Values[PERF_CYCLES];
+        if (C.Valid[PERF_BRANCH_MISSES])
+            Stream << ", \"branch_misses_per_px\": " << C.Values[PERF_BRANCH_MISSES] / Pixels;
+        if (C.Valid[PERF_LLC_MISSES])
+            Stream << ", \"llc_misses_per_px\": " << C.Values[PERF_LLC_MISSES] / Pixels;
+        Stream << " }"
+               << (i + 1 < Results.size() ? "," : "") << std::endl;
+    }
+    Stream << "  ]" << std::endl;
+    Stream << "}" << std::endl;
+}
+
+
+/**
+ * @brief       Extracts the value of Key from a line of the JSON written by write_json.
+ */
+bool json_field(const std::string& Line, const std::string& Key, std::string& Value)
+{
+    size_t Pos = Line.find("\"" + Key + "\"");
+    if (Pos == std::string::npos)
+        return false;
+    Pos = Line.find(':', Pos);
+    if (Pos == std::string::npos)
+        return false;
+    Pos = Line.find_first_not_of(" \t", Pos + 1);
+    if (Pos == std::string::npos)
+        return false;
+    if (Line[Pos] == '"')
+    {
+        size_t End = Line.find('"', Pos + 1);
+        if (End == std::string::npos)
+            return false;
+        Value = Line.substr(Pos + 1, End - Pos - 1);
+    }
+    else
+    {
+        size_t End = Line.find_first_of(",} \t\r", Pos);
+        Value = Line.substr(Pos, End == std::string::npos ? std::string::npos : End - Pos);
+    }
+    return true;
+}
+
+
+/**
+ * @brief       Reads the results of a previous run. Only files written by this tool are supported,
+ *              with one result per line.
+ */
+bool read_baseline(const std::string& Path, std::vector<BenchResult>& Results)
+{
+    std::ifstream Stream(Path);
+    if (!Stream.is_open())
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        return false;
+    }
+    std::string Line;
+    while (std::getline(Stream, Line))
+    {
+        BenchResult R;
+        std::string MPix, P99;
+        if (!json_field(Line, "view", R.View) || !json_field(Line, "backend", R.Backend) ||
+            !json_field(Line, "mpix_per_s", MPix) || !json_field(Line, "p99_ms", P99))
+            continue;
+        R.MPixPerSec = atof(MPix.c_str());
+        R.P99 = atof(P99.c_str());
+        Results.push_back(R);
+    }
+    if (Results.empty())
+    {
+        std::cerr << "No results found in " << Path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief       Compares the results against a baseline. A result regresses if its throughput drops,
+ *              or its 99th percentile grows, by more than Threshold percent. Returns the number of
+ *              regressions.
+ */
+int compare(const std::vector<BenchResult>& Results, const std::vector<BenchResult>& Baseline, double Threshold)
+{
+    int Regressions = 0;
+    std::cerr << std::fixed << std::setprecision(1);
+    for (const BenchResult& R : Results)
+    {
+        auto Base = std::find_if(Baseline.begin(), Baseline.end(), [&](const BenchResult& B) {
+            return B.View == R.View && B.Backend == R.Backend;
+        });
+        std::cerr << std::left << std::setw(18) << R.View << std::setw(10) << R.Backend << std::right;
+        if (Base == Baseline.end())
+        {
+            std::cerr << "  not in the baseline" << std::endl;
+            continue;
+        }
+
+        double Throughput = Base->MPixPerSec > 0.0 ? 100.0 * (R.MPixPerSec / Base->MPixPerSec - 1.0) : 0.0;
+        double Tail = Base->P99 > 0.0 ? 100.0 * (R.P99 / Base->P99 - 1.0) : 0.0;
+        bool Regressed = Throughput < -Threshold || Tail > Threshold;
+        Regressions += Regressed ? 1 : 0;
+        std::cerr << std::showpos << std::setw(9) << Throughput << "% MP/s"
+                  << std::setw(9) << Tail << "% p99" << std::noshowpos
+                  << (Regressed ? "  REGRESSION" : "") << std::endl;
+    }
+    return Regressions;
+}
+
+
+void usage(const char* argv0, std::ostream& Stream)
+{
+    Stream << "Usage: " << argv0 << " [ OPTIONS ]" << std::endl;
+    Stream << "    Renders a fixed catalogue of views with every backend and writes the results as JSON." << std::endl;
+    Stream << "        --size WxH              Size of the frames (default 1920x1080)." << std::endl;
+    Stream << "        --frames N              Number of timed frames per view (default 50)." << std::endl;
+    Stream << "        --warmup N              Number of frames rendered before timing (default 5)." << std::endl;
+    Stream << "        --backend NAME          Only run the given backend (compute, compute_fp64, compute_int64," << std::endl;
+    Stream << "                                fragment, cpu). compute_fp64, compute_int64 and cpu only run" << std::endl;
+    Stream << "                                when selected." << std::endl;
+    Stream << "        --view NAME             Only run the given view (mandelbrot_full, seahorse_valley," << std::endl;
+    Stream << "                                julia_default, newton_3, newton_7, newton_20)." << std::endl;
+    Stream << "        --output FILE           Write the results to FILE instead of the standard output." << std::endl;
+    Stream << "        --compare BASELINE      Compare the results with the ones in BASELINE and exit with an" << std::endl;
+    Stream << "                                error if any of them regressed." << std::endl;
+    Stream << "        --threshold PCT         Tolerated change of throughput and p99 in percent (default 10)." << std::endl;
+    Stream << "        --trace FILE            Write a timeline of the run to FILE in the Chrome trace format." << std::endl;
+    Stream << "        --accuracy              Compare the iteration fields of every precision (gpu_fp64, gpu_int64," << std::endl;
+    Stream << "                                cpu_fp32, cpu_fp64, cpu_dd) against a quad-double CPU reference" << std::endl;
+    Stream << "                                (cpu_qd), instead of the throughput of the backends. --backend" << std::endl;
+    Stream << "                                selects a precision." << std::endl;
+    Stream << "        --counters              Collect the hardware counters of the CPU backend and add the" << std::endl;
+    Stream << "                                IPC and the misses per pixel to the results (Linux only)." << std::endl;
+}
+
+
+bool parse_args(int argc, char const* argv[], BenchOptions& Options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string Arg = argv[i];
+        bool HasValue = i + 1 < argc;
+        if (Arg == "--size" && HasValue)
+        {
+            if (sscanf(argv[++i], "%dx%d", &Options.Width, &Options.Height) != 2 || Options.Width <= 0 || Options.Height <= 0)
+            {
+                std::cerr << "Invalid size " << argv[i] << "." << std::endl;
+                return false;
+            }
+        }
+        else if (Arg == "--frames" && HasValue)
+            Options.Frames = std::max(atoi(argv[++i]), 1);
+        else if (Arg == "--warmup" && HasValue)
+            Options.Warmup = std::max(atoi(argv[++i]), 0);
+        else if (Arg == "--backend" && HasValue)
+            Options.Backend = argv[++i];
+        else if (Arg == "--view" && HasValue)
+            Options.View = argv[++i];
+        else if (Arg == "--output" && HasValue)
+            Options.OutputFile = argv[++i];
+        else if (Arg == "--compare" && HasValue)
+            Options.BaselineFile = argv[++i];
+        else if (Arg == "--threshold" && HasValue)
+            Options.Threshold = atof(argv[++i]);
+        else if (Arg == "--trace" && HasValue)
+            Options.TraceFile = argv[++i];
+        else if (Arg == "--counters")
+            Options.Counters = true;
+        else if (Arg == "--accuracy")
+            Options.Accuracy = true;
+        else
+        {
+            std::cerr << "Unknown option " << Arg << "." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char const *argv[])
+{
+    BenchOptions Options;
+    if (!parse_args(argc, argv, Options))
+    {
+        usage(argv[0], std::cerr);
+        return -1;
+    }
+
+    std::vector<BenchResult> Baseline;
+    if (!Options.BaselineFile.empty() && !read_baseline(Options.BaselineFile, Baseline))
+        return -1;
+
+
+    // Only the context is needed
+    if (!glfwInit())
+    {
+        std::cerr << "Cannot initialize GLFW." << std::endl;
+        return -1;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* Window = glfwCreateWindow(64, 64, "GPU Fractals Bench", NULL, NULL);
+    if (Window == NULL)
+    {
+        std::cerr << "Cannot initialize a window." << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(Window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Cannot initialize GLAD." << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+
+
+    if (!Options.TraceFile.empty())
+        trace_start();
+
+    // Compare the precisions
+    if (Options.Accuracy)
+    {
+        std::vector<AccuracyResult> Results;
+        bool Success = run_accuracy(Options, Results);
+        if (!Options.TraceFile.empty())
+            Success = trace_write(Options.TraceFile) && Success;
+        accuracy_report(std::cerr, Results);
+        std::ofstream File;
+        if (!Options.OutputFile.empty())
+        {
+            File.open(Options.OutputFile);
+            if (!File.is_open())
+                std::cerr << "Cannot open " << Options.OutputFile << " for writing." << std::endl;
+        }
+        Success = (Options.OutputFile.empty() || File.is_open()) && Success;
+        write_accuracy_json(File.is_open() ? File : std::cout, Options, Results);
+        glfwTerminate();
+        return Success ? 0 : 1;
+    }
+
+    // Run the catalogue
+    std::vector<BenchResult> Results;
+    bool Success = true;
+    std::vector<std::unique_ptr<BenchBackend>> Backends = available_backends(Options);
+    for (const BenchView& View : catalogue())
+    {
+        if (!Options.View.empty() && Options.View != View.Name)
+            continue;
+        for (std::unique_ptr<BenchBackend>& Backend : Backends)
+        {
+            if (Options.Backend.empty() ? !Backend->by_default() : Options.Backend != Backend->name())
+                continue;
+            std::cerr << "Running " << View.Name << " on " << Backend->name() << "..." << std::endl;
+            BenchResult Result;
+            if (!run_view(*Backend, View, Options, Result))
+            {
+                std::cerr << "Cannot run " << View.Name << " on " << Backend->name() << "." << std::endl;
+                Success = false;
+                continue;
+            }
+            Results.push_back(Result);
+        }
+    }
+    if (Results.empty())
+    {
+        std::cerr << "No view or backend matches the given filters." << std::endl;
+        Success = false;
+    }
+    if (!Options.TraceFile.empty())
+        Success = trace_write(Options.TraceFile) && Success;
+
+
+    // Report
+    if (Options.OutputFile.empty())
+        write_json(std::cout, Options, Results);
+    else
+    {
+        std::ofstream Stream(Options.OutputFile);
+        if (!Stream.is_open())
+        {
+            std::cerr << "Cannot open " << Options.OutputFile << " for writing." << std::endl;
+            Success = false;
+        }
+        else
+            write_json(Stream, Options, Results);
+    }
+
+    if (!Baseline.empty())
+    {
+        int Regressions = compare(Results, Baseline, Options.Threshold);
+        if (Regressions > 0)
+        {
+            std::cerr << Regressions << " result(s) regressed by more than " << Options.Threshold << "%." << std::endl;
+            Success = false;
+        }
+    }
+
+    glfwTerminate();
+    return Success ? 0 : 1;
+}
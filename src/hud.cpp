@@ -0,0 +1,209 @@
+/**
+ * @file        hud.cpp
+ *
+ * @brief       Implementation of the text overlay.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <hud.hpp>
+#include <gl_utils.hpp>
+#include <defines.hpp>
+#include <algorithm>
+
+
+// The quad is generated from the vertex index, within the rectangle given in clip coordinates
+const char *HudVSource = 
+"#version 440 core\n"\
+"uniform vec4 Rect;\n"\
+"out vec2 fUV;\n"\
+"void main() {\n"\
+"vec2 Corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);\n"\
+"gl_Position = vec4(mix(Rect.xy, Rect.zw, Corner), 0.0f, 1.0f);\n"\
+"fUV = vec2(Corner.x, 1.0f - Corner.y);\n"\
+"}\n";
+
+
+// Glyphs of the characters from ' ' to 'Z', 7 rows of 5 pixels each, most significant bit on the left
+const unsigned char Font[59][7] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // ' '
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '!'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '"'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '#'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '$'
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },   // '%'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '&'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '\''
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },   // '('
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },   // ')'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '*'
+    { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 },   // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 },   // ','
+    { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },   // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },   // '.'
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },   // '/'
+    { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },   // '0'
+    { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },   // '1'
+    { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },   // '2'
+    { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },   // '3'
+    { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },   // '4'
+    { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },   // '5'
+    { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },   // '6'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },   // '7'
+    { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },   // '8'
+    { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },   // '9'
+    { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },   // ':'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // ';'
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 },   // '<'
+    { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 },   // '='
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 },   // '>'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '?'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // '@'
+    { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 },   // 'A'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },   // 'B'
+    { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },   // 'C'
+    { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },   // 'D'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },   // 'E'
+    { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },   // 'F'
+    { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },   // 'G'
+    { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },   // 'H'
+    { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },   // 'I'
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },   // 'J'
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },   // 'K'
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },   // 'L'
+    { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },   // 'M'
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },   // 'N'
+    { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // 'O'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },   // 'P'
+    { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },   // 'Q'
+    { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },   // 'R'
+    { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },   // 'S'
+    { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },   // 'T'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },   // 'U'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },   // 'V'
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },   // 'W'
+    { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },   // 'X'
+    { 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04 },   // 'Y'
+    { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },   // 'Z'
+};
+
+const int GlyphWidth = 5;
+const int GlyphHeight = 7;
+const int CellWidth = 6;
+const int CellHeight = 9;
+const int Padding = 3;
+const int Scale = 2;
+const int Margin = 8;
+
+
+bool create_hud(Hud& H)
+{
+    H.Program = build_render_program(HudVSource, HUD_FRAGMENT_SHADER);
+    if (H.Program == 0)
+        return false;
+
+    // The vertices are generated in the shader, but a vertex array must be bound to draw
+    glGenVertexArrays(1, &H.VAO);
+    glGenTextures(1, &H.Texture);
+    glBindTexture(GL_TEXTURE_2D, H.Texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+
+void hud_set_text(Hud& H, const std::string& Text)
+{
+    // Measure the text
+    int Columns = 0;
+    int Rows = 1;
+    int Column = 0;
+    for (char c : Text)
+    {
+        if (c == '\n')
+        {
+            ++Rows;
+            Column = 0;
+        }
+        else
+            Columns = std::max(Columns, ++Column);
+    }
+    H.Width = Columns * CellWidth + 2 * Padding;
+    H.Height = Rows * CellHeight + 2 * Padding;
+    H.Pixels.assign((size_t)H.Width * H.Height, 0);
+
+    // Rasterize, rows top-down
+    int Row = 0;
+    Column = 0;
+    for (char c : Text)
+    {
+        if (c == '\n')
+        {
+            ++Row;
+            Column = 0;
+            continue;
+        }
+        if (c >= 'a' && c <= 'z')
+            c = c - 'a' + 'A';
+        if (c > ' ' && c <= 'Z')
+        {
+            const unsigned char* Glyph = Font[c - ' '];
+            int X0 = Padding + Column * CellWidth;
+            int Y0 = Padding + Row * CellHeight;
+            for (int y = 0; y < GlyphHeight; ++y)
+                for (int x = 0; x < GlyphWidth; ++x)
+                    if (Glyph[y] & (1 << (GlyphWidth - 1 - x)))
+                        H.Pixels[(size_t)(Y0 + y) * H.Width + X0 + x] = 255;
+        }
+        ++Column;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, H.Texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, H.Width, H.Height, 0, GL_RED, GL_UNSIGNED_BYTE, H.Pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+
+void hud_draw(Hud& H, int Width, int Height)
+{
+    if (!H.Visible || H.Width == 0 || Width <= 0 || Height <= 0)
+        return;
+
+    // Pixels of the text are drawn as Scale x Scale squares
+    float X0 = -1.0f + 2.0f * Margin / Width;
+    float Y1 = 1.0f - 2.0f * Margin / Height;
+    float X1 = X0 + 2.0f * Scale * H.Width / Width;
+    float Y0 = Y1 - 2.0f * Scale * H.Height / Height;
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(H.Program);
+    glUniform4f(glGetUniformLocation(H.Program, "Rect"), X0, Y0, X1, Y1);
+    glUniform1i(glGetUniformLocation(H.Program, "Text"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, H.Texture);
+    glBindVertexArray(H.VAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_BLEND);
+}
+
+
+void destroy_hud(Hud& H)
+{
+    if (H.VAO != 0)
+        glDeleteVertexArrays(1, &H.VAO);
+    if (H.Texture != 0)
+        glDeleteTextures(1, &H.Texture);
+    if (H.Program != 0)
+        glDeleteProgram(H.Program);
+    H = Hud();
+}
@@ -0,0 +1,141 @@
+/**
+ * @file        latency_tracker.cpp
+ *
+ * @brief       Implementation of the input latency tracker.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <latency_tracker.hpp>
+#include <stage_timer.hpp>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+
+LatencyTracker::LatencyTracker()
+    : m_Epoch(std::chrono::steady_clock::now()), m_Pending(-1.0)
+{ }
+
+
+double LatencyTracker::now() const
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Epoch).count();
+}
+
+
+void LatencyTracker::input_arrived(double Time)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    if (m_Pending < 0.0)
+        m_Pending = Time;
+}
+
+
+double LatencyTracker::take_pending()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    double Time = m_Pending;
+    m_Pending = -1.0;
+    return Time;
+}
+
+
+void LatencyTracker::frame_presented(double InputTime)
+{
+    PendingFrame F;
+    F.InputTime = InputTime;
+    F.SwapMs = 1000.0 * (now() - InputTime);
+    if (m_FreeQueries.empty())
+    {
+        F.Query = 0;
+        glGenQueries(1, &F.Query);
+    }
+    else
+    {
+        F.Query = m_FreeQueries.back();
+        m_FreeQueries.pop_back();
+    }
+    glQueryCounter(F.Query, GL_TIMESTAMP);
+
+    // The current GPU time ties the two clocks together
+    GLint64 GPUNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &GPUNow);
+    F.ClockOffset = now() - GPUNow * 1e-9;
+    m_Frames.push_back(F);
+}
+
+
+void LatencyTracker::poll(bool Wait)
+{
+    while (!m_Frames.empty())
+    {
+        PendingFrame& F = m_Frames.front();
+        GLint Available = GL_TRUE;
+        if (!Wait)
+            glGetQueryObjectiv(F.Query, GL_QUERY_RESULT_AVAILABLE, &Available);
+        if (!Available)
+            break;
+        GLuint64 Done = 0;
+        glGetQueryObjectui64v(F.Query, GL_QUERY_RESULT, &Done);
+        double DisplayMs = 1000.0 * (Done * 1e-9 + F.ClockOffset - F.InputTime);
+        m_SwapMs.push_back(F.SwapMs);
+        m_DisplayMs.push_back(std::max(DisplayMs, F.SwapMs));
+        m_FreeQueries.push_back(F.Query);
+        m_Frames.pop_front();
+    }
+}
+
+
+static std::string latency_percentiles(std::vector<double> Ms)
+{
+    std::sort(Ms.begin(), Ms.end());
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << "p50 " << percentile(Ms, 50.0) << " ms, p90 " << percentile(Ms, 90.0)
+       << " ms, p99 " << percentile(Ms, 99.0) << " ms, max " << Ms.back() << " ms";
+    return ss.str();
+}
+
+
+bool LatencyTracker::recent(double& P50, double& P99, size_t LastFrames)
+{
+    if (m_DisplayMs.empty())
+        return false;
+    size_t First = m_DisplayMs.size() - std::min(LastFrames, m_DisplayMs.size());
+    std::vector<double> Ms(m_DisplayMs.begin() + First, m_DisplayMs.end());
+    std::sort(Ms.begin(), Ms.end());
+    P50 = percentile(Ms, 50.0);
+    P99 = percentile(Ms, 99.0);
+    return true;
+}
+
+
+void LatencyTracker::report(std::ostream& Stream)
+{
+    poll(true);
+    if (m_DisplayMs.empty())
+        return;
+    Stream << "Input latency of " << m_DisplayMs.size() << " frames" << std::endl;
+    Stream << "    to swap:    " << latency_percentiles(m_SwapMs) << std::endl;
+    Stream << "    to display: " << latency_percentiles(m_DisplayMs) << std::endl;
+}
+
+
+void LatencyTracker::destroy()
+{
+    for (const PendingFrame& F : m_Frames)
+        m_FreeQueries.push_back(F.Query);
+    m_Frames.clear();
+    if (!m_FreeQueries.empty())
+        glDeleteQueries((GLsizei)m_FreeQueries.size(), m_FreeQueries.data());
+    m_FreeQueries.clear();
+}
+
+
+LatencyTracker& latency_tracker()
+{
+    static LatencyTracker Tracker;
+    return Tracker;
+}
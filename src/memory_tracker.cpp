@@ -0,0 +1,157 @@
+/**
+ * @file        memory_tracker.cpp
+ *
+ * @brief       Implementation of the memory tracker.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <memory_tracker.hpp>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <stdint.h>
+
+
+const char* const MemoryCategoryNames[MEM_COUNT] = { "textures", "buffers", "staging", "images" };
+
+
+const char* memory_category_name(MemoryCategory Category)
+{
+    return MemoryCategoryNames[Category];
+}
+
+
+MemoryTracker::MemoryTracker()
+    : m_Budget(0), m_Total(0), m_TotalPeak(0)
+{
+    for (int c = 0; c < MEM_COUNT; ++c)
+        m_Current[c] = m_Peak[c] = 0;
+}
+
+
+void MemoryTracker::set_budget(size_t Bytes)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Budget = Bytes;
+}
+
+
+bool MemoryTracker::reserve(MemoryCategory Category, size_t Bytes)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    if (m_Budget > 0 && (Bytes > m_Budget || m_Total > m_Budget - Bytes))
+        return false;
+    m_Current[Category] += Bytes;
+    m_Peak[Category] = std::max(m_Peak[Category], m_Current[Category]);
+    m_Total += Bytes;
+    m_TotalPeak = std::max(m_TotalPeak, m_Total);
+    return true;
+}
+
+
+void MemoryTracker::release(MemoryCategory Category, size_t Bytes)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    Bytes = std::min(Bytes, m_Current[Category]);
+    m_Current[Category] -= Bytes;
+    m_Total -= Bytes;
+}
+
+
+size_t MemoryTracker::current(MemoryCategory Category)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_Current[Category];
+}
+
+
+size_t MemoryTracker::peak(MemoryCategory Category)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_Peak[Category];
+}
+
+
+size_t MemoryTracker::total()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_Total;
+}
+
+
+size_t MemoryTracker::total_peak()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_TotalPeak;
+}
+
+
+size_t MemoryTracker::available()
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    if (m_Budget == 0)
+        return SIZE_MAX;
+    return m_Budget > m_Total ? m_Budget - m_Total : 0;
+}
+
+
+void MemoryTracker::report(std::ostream& Stream)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    std::ios::fmtflags Flags = Stream.flags();
+    Stream << std::fixed << std::setprecision(1);
+    Stream << "Memory       Current (MB)   Peak (MB)" << std::endl;
+    for (int c = 0; c < MEM_COUNT; ++c)
+        Stream << std::left << std::setw(10) << MemoryCategoryNames[c] << std::right << std::setw(15)
+               << m_Current[c] / 1048576.0 << std::setw(12) << m_Peak[c] / 1048576.0 << std::endl;
+    Stream << std::left << std::setw(10) << "total" << std::right << std::setw(15) << m_Total / 1048576.0
+           << std::setw(12) << m_TotalPeak / 1048576.0;
+    if (m_Budget > 0)
+        Stream << "   of a " << m_Budget / 1048576.0 << " MB budget";
+    Stream << std::endl;
+    Stream.flags(Flags);
+}
+
+
+MemoryTracker& memory_tracker()
+{
+    static MemoryTracker Tracker;
+    return Tracker;
+}
+
+
+
+bool MemoryReservation::reserve(MemoryCategory Category, size_t Bytes, const char* What)
+{
+    release();
+    if (!memory_tracker().reserve(Category, Bytes))
+    {
+        std::cerr << "Allocating " << Bytes / 1048576.0 << " MB for " << What << " would exceed the memory budget." << std::endl;
+        return false;
+    }
+    m_Category = Category;
+    m_Bytes = Bytes;
+    return true;
+}
+
+
+void MemoryReservation::release()
+{
+    if (m_Bytes > 0)
+        memory_tracker().release(m_Category, m_Bytes);
+    m_Bytes = 0;
+}
+
+
+int fit_tile_size(int TileSize, size_t BytesPerPixel, int MinTileSize)
+{
+    size_t Available = memory_tracker().available();
+    while (TileSize > MinTileSize && (size_t)TileSize * TileSize * BytesPerPixel > Available)
+        TileSize = std::max(TileSize / 2, MinTileSize);
+    if ((size_t)TileSize * TileSize * BytesPerPixel > Available)
+        return 0;
+    return TileSize;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file        metrics.cpp
+ *
+ * @brief       Implementation of the metrics exporter.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <metrics.hpp>
+#include <memory_tracker.hpp>
+#include <tracer.hpp>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <stdio.h>
+
+
+struct MetricInfo
+{
+    const char* Name;
+    const char* Help;
+};
+
+const MetricInfo CounterInfo[METRIC_COUNTER_COUNT] = {
+    { "gpu_fractals_frames_total", "Frames handed to the image sequences and video streams." },
+    { "gpu_fractals_tiles_total", "Tiles rendered by the tiled exports, the field exports, the cost maps and the pyramids." },
+    { "gpu_fractals_tiles_resumed_total", "Tiles of the tiled exports found complete in the journal." },
+    { "gpu_fractals_pixels_total", "Pixels computed by the compute shaders." },
+    { "gpu_fractals_iterations_total", "Iteration budget of the computed pixels, an upper bound for Mandelbrot's and Julia's sets." },
+    { "gpu_fractals_export_bytes_total", "Bytes written to images, field archives, pyramid tiles and video streams." }
+};
+
+const char* const GaugeLabels[METRIC_GAUGE_COUNT] = { "tile_writes", "frame_readbacks" };
+
+// Upper bounds of the buckets of the stage histograms, in seconds
+const double BucketBounds[] = { 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5 };
+
+
+static std::string format_value(double Value)
+{
+    char Buffer[32];
+    snprintf(Buffer, sizeof(Buffer), "%.15g", Value);
+    return Buffer;
+}
+
+
+Metrics::Metrics()
+    : m_Enabled(false), m_Interval(0.0), m_Stop(false)
+{
+    for (int c = 0; c < METRIC_COUNTER_COUNT; ++c)
+        m_Counters[c] = 0.0;
+    for (int g = 0; g < METRIC_GAUGE_COUNT; ++g)
+        m_Gauges[g] = 0.0;
+    for (int s = 0; s < STAGE_COUNT; ++s)
+    {
+        for (int b = 0; b < NBuckets; ++b)
+            m_Buckets[s][b] = 0;
+        m_Count[s] = 0;
+        m_Sum[s] = 0.0;
+    }
+}
+
+Metrics::~Metrics()
+{
+    stop();
+}
+
+
+void Metrics::set_enabled(bool Enabled)
+{
+    m_Enabled.store(Enabled, std::memory_order_relaxed);
+}
+
+
+void Metrics::add(MetricCounter Counter, double Value)
+{
+    if (!enabled())
+        return;
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Counters[Counter] += Value;
+}
+
+
+void Metrics::set(MetricGauge Gauge, double Value)
+{
+    if (!enabled())
+        return;
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Gauges[Gauge] = Value;
+}
+
+
+void Metrics::observe(StageType Stage, double Seconds)
+{
+    if (!enabled())
+        return;
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    int b = 0;
+    while (b < NBuckets && Seconds > BucketBounds[b])
+        ++b;
+    if (b < NBuckets)
+        ++m_Buckets[Stage][b];
+    ++m_Count[Stage];
+    m_Sum[Stage] += Seconds;
+}
+
+
+void Metrics::write_text(std::ostream& Stream)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    for (int c = 0; c < METRIC_COUNTER_COUNT; ++c)
+    {
+        Stream << "# HELP " << CounterInfo[c].Name << " " << CounterInfo[c].Help << "\n";
+        Stream << "# TYPE " << CounterInfo[c].Name << " counter\n";
+        Stream << CounterInfo[c].Name << " " << format_value(m_Counters[c]) << "\n";
+    }
+
+    // The share of the tiles that did not need to be rendered again
+    double Resumed = m_Counters[METRIC_TILES_RESUMED];
+    double AllTiles = Resumed + m_Counters[METRIC_TILES];
+    Stream << "# HELP gpu_fractals_tile_resume_ratio Share of the tiles of the exports recovered from the journals.\n";
+    Stream << "# TYPE gpu_fractals_tile_resume_ratio gauge\n";
+    Stream << "gpu_fractals_tile_resume_ratio " << format_value(AllTiles > 0.0 ? Resumed / AllTiles : 0.0) << "\n";
+
+    Stream << "# HELP gpu_fractals_queue_depth Items waiting in the queues of the batch jobs.\n";
+    Stream << "# TYPE gpu_fractals_queue_depth gauge\n";
+    for (int g = 0; g < METRIC_GAUGE_COUNT; ++g)
+        Stream << "gpu_fractals_queue_depth{queue=\"" << GaugeLabels[g] << "\"} " << format_value(m_Gauges[g]) << "\n";
+
+    Stream << "# HELP gpu_fractals_memory_bytes Memory accounted for by the memory tracker.\n";
+    Stream << "# TYPE gpu_fractals_memory_bytes gauge\n";
+    for (int c = 0; c < MEM_COUNT; ++c)
+        Stream << "gpu_fractals_memory_bytes{category=\"" << memory_category_name((MemoryCategory)c) << "\"} "
+               << memory_tracker().current((MemoryCategory)c) << "\n";
+
+    Stream << "# HELP gpu_fractals_stage_seconds Time spent in every stage of the rendering.\n";
+    Stream << "# TYPE gpu_fractals_stage_seconds histogram\n";
+    for (int s = 0; s < STAGE_COUNT; ++s)
+    {
+        const char* Stage = stage_name((StageType)s);
+        long long Cumulative = 0;
+        for (int b = 0; b < NBuckets; ++b)
+        {
+            Cumulative += m_Buckets[s][b];
+            Stream << "gpu_fractals_stage_seconds_bucket{stage=\"" << Stage << "\",le=\"" << format_value(BucketBounds[b])
+                   << "\"} " << Cumulative << "\n";
+        }
+        Stream << "gpu_fractals_stage_seconds_bucket{stage=\"" << Stage << "\",le=\"+Inf\"} " << m_Count[s] << "\n";
+        Stream << "gpu_fractals_stage_seconds_sum{stage=\"" << Stage << "\"} " << format_value(m_Sum[s]) << "\n";
+        Stream << "gpu_fractals_stage_seconds_count{stage=\"" << Stage << "\"} " << m_Count[s] << "\n";
+    }
+}
+
+
+bool Metrics::write_file(const std::string& Path)
+{
+    TRACE_SCOPE("write_metrics");
+    std::string Temp = Path + ".tmp";
+    {
+        std::ofstream Stream(Temp, std::ios::binary);
+        if (!Stream.is_open())
+        {
+            std::cerr << "Cannot open " << Temp << "." << std::endl;
+            return false;
+        }
+        write_text(Stream);
+        Stream.close();
+        if (!Stream)
+        {
+            std::cerr << "Cannot write " << Temp << "." << std::endl;
+            return false;
+        }
+    }
+    std::error_code Error;
+    std::filesystem::rename(Temp, Path, Error);
+    if (Error)
+    {
+        std::cerr << "Cannot replace " << Path << ": " << Error.message() << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool Metrics::start(const std::string& Path, double Interval)
+{
+    stop();
+    m_Path = Path;
+    m_Interval = Interval;
+    set_enabled(true);
+    if (!write_file(m_Path))
+        return false;
+    m_Stop = false;
+    m_Writer = std::thread(&Metrics::writer_loop, this);
+    return true;
+}
+
+
+bool Metrics::stop()
+{
+    if (!m_Writer.joinable())
+        return true;
+    {
+        std::lock_guard<std::mutex> Lock(m_WriterMutex);
+        m_Stop = true;
+        m_WriterSignal.notify_all();
+    }
+    m_Writer.join();
+    return write_file(m_Path);
+}
+
+
+void Metrics::writer_loop()
+{
+    trace_thread_name("metrics");
+    std::unique_lock<std::mutex> Lock(m_WriterMutex);
+    while (!m_WriterSignal.wait_for(Lock, std::chrono::duration<double>(m_Interval), [this] { return m_Stop; }))
+    {
+        Lock.unlock();
+        write_file(m_Path);
+        Lock.lock();
+    }
+}
+
+
+Metrics& metrics()
+{
+    static Metrics Instance;
+    return Instance;
+}
@@ -0,0 +1,46 @@
+/**
+ * @file        npy_file.cpp
+ *
+ * @brief       Implementation of the .npy writer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <npy_file.hpp>
+#include <iostream>
+#include <stdint.h>
+
+
+FILE* npy_create(const std::string& Path, const char* Descr, const std::vector<long long>& Shape)
+{
+    // A tuple of a single element needs its comma
+    std::string Dims;
+    for (size_t i = 0; i < Shape.size(); ++i)
+        Dims += (i > 0 ? ", " : "") + std::to_string(Shape[i]);
+    if (Shape.size() == 1)
+        Dims += ",";
+    std::string Header = std::string("{'descr': '") + Descr + "', 'fortran_order': False, 'shape': (" + Dims + "), }";
+    // Magic, version and length take 10 bytes, the data starts at a multiple of 64
+    Header.append(63 - (10 + Header.size()) % 64, ' ');
+    Header.push_back('\n');
+    uint16_t Length = (uint16_t)Header.size();
+
+    FILE* Stream = fopen(Path.c_str(), "wb");
+    if (Stream == NULL)
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        return NULL;
+    }
+    const unsigned char Magic[8] = { 0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0 };
+    unsigned char LengthBytes[2] = { (unsigned char)(Length & 0xFF), (unsigned char)(Length >> 8) };
+    if (fwrite(Magic, 1, 8, Stream) != 8 || fwrite(LengthBytes, 1, 2, Stream) != 2 ||
+        fwrite(Header.data(), 1, Header.size(), Stream) != Header.size())
+    {
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+        fclose(Stream);
+        return NULL;
+    }
+    return Stream;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file        perf_counters.cpp
+ *
+ * @brief       Implementation of the hardware performance counters.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <perf_counters.hpp>
+#include <iomanip>
+#include <algorithm>
+#include <sstream>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HAS_PERF_EVENTS
+#endif
+
+
+void PerfSample::add(const PerfSample& Other)
+{
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+    {
+        if (!Other.Valid[c])
+            continue;
+        Values[c] += Other.Values[c];
+        Valid[c] = true;
+    }
+}
+
+
+PerfCounters::PerfCounters()
+{
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+        m_Fds[c] = -1;
+}
+
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+bool PerfCounters::open()
+{
+#ifdef HAS_PERF_EVENTS
+    const uint32_t Types[PERF_COUNTER_COUNT] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE
+    };
+    const uint64_t Configs[PERF_COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+    };
+
+    // The counters are opened one by one, so the ones that are available work on their own
+    bool Any = false;
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+    {
+        perf_event_attr Attr;
+        memset(&Attr, 0, sizeof(Attr));
+        Attr.size = sizeof(Attr);
+        Attr.type = Types[c];
+        Attr.config = Configs[c];
+        Attr.disabled = 1;
+        Attr.exclude_kernel = 1;
+        Attr.exclude_hv = 1;
+        Attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        m_Fds[c] = (int)syscall(__NR_perf_event_open, &Attr, 0, -1, -1, 0);
+        Any |= m_Fds[c] >= 0;
+    }
+    return Any;
+#else
+    return false;
+#endif
+}
+
+void PerfCounters::start()
+{
+#ifdef HAS_PERF_EVENTS
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+    {
+        if (m_Fds[c] < 0)
+            continue;
+        ioctl(m_Fds[c], PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_Fds[c], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+PerfSample PerfCounters::stop()
+{
+    PerfSample Sample;
+#ifdef HAS_PERF_EVENTS
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+    {
+        if (m_Fds[c] >= 0)
+            ioctl(m_Fds[c], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+    {
+        // Value, time enabled, time running
+        uint64_t Data[3];
+        if (m_Fds[c] < 0 || read(m_Fds[c], Data, sizeof(Data)) != (ssize_t)sizeof(Data) || Data[2] == 0)
+            continue;
+        Sample.Values[c] = (double)Data[0] * ((double)Data[1] / (double)Data[2]);
+        Sample.Valid[c] = true;
+    }
+#endif
+    return Sample;
+}
+
+void PerfCounters::close()
+{
+#ifdef HAS_PERF_EVENTS
+    for (int c = 0; c < PERF_COUNTER_COUNT; ++c)
+    {
+        if (m_Fds[c] >= 0)
+            ::close(m_Fds[c]);
+        m_Fds[c] = -1;
+    }
+#endif
+}
+
+
+PerfSample PerfPhase::total() const
+{
+    PerfSample Total;
+    for (const PerfSample& S : Threads)
+        Total.add(S);
+    return Total;
+}
+
+
+void perf_merge(std::vector<PerfPhase>& Into, const std::vector<PerfPhase>& Phases)
+{
+    for (const PerfPhase& P : Phases)
+    {
+        auto It = std::find_if(Into.begin(), Into.end(), [&](const PerfPhase& Q) { return Q.Name == P.Name; });
+        if (It == Into.end())
+        {
+            Into.push_back(P);
+            continue;
+        }
+        It->Seconds += P.Seconds;
+        It->Pixels += P.Pixels;
+        size_t NThreads = std::max(It->Threads.size(), P.Threads.size());
+        It->Threads.resize(NThreads);
+        It->ThreadSeconds.resize(NThreads);
+        It->ThreadPixels.resize(NThreads);
+        for (size_t t = 0; t < P.Threads.size(); ++t)
+        {
+            It->Threads[t].add(P.Threads[t]);
+            It->ThreadSeconds[t] += P.ThreadSeconds[t];
+            It->ThreadPixels[t] += P.ThreadPixels[t];
+        }
+    }
+}
+
+
+static void report_row(std::ostream& Stream, const std::string& Phase, const std::string& Thread,
+                       double Seconds, const PerfSample& S, long long Pixels)
+{
+    auto Field = [&](int Width, bool Valid, double Value, int Precision) {
+        if (Valid)
+            Stream << std::setw(Width) << std::setprecision(Precision) << Value;
+        else
+            Stream << std::setw(Width) << "-";
+    };
+    double Px = (double)std::max(Pixels, 1LL);
+    Stream << std::left << std::setw(10) << Phase << std::setw(8) << Thread << std::right;
+    Field(11, true, Seconds * 1e3, 2);
+    Field(10, S.Valid[PERF_CYCLES], S.Values[PERF_CYCLES] * 1e-6, 1);
+    Field(10, S.Valid[PERF_INSTRUCTIONS], S.Values[PERF_INSTRUCTIONS] * 1e-6, 1);
+    Field(7, S.Valid[PERF_CYCLES] && S.Valid[PERF_INSTRUCTIONS] && S.Values[PERF_CYCLES] > 0.0,
+          S.Values[PERF_INSTRUCTIONS] / std::max(S.Values[PERF_CYCLES], 1.0), 2);
+    Field(12, S.Valid[PERF_BRANCH_MISSES], S.Values[PERF_BRANCH_MISSES] / Px, 3);
+    Field(12, S.Valid[PERF_LLC_MISSES], S.Values[PERF_LLC_MISSES] / Px, 4);
+    Stream << std::endl;
+}
+
+
+void perf_report(std::ostream& Stream, const std::vector<PerfPhase>& Phases)
+{
+    std::ios::fmtflags Flags = Stream.flags();
+    Stream << std::fixed;
+    Stream << std::left << std::setw(10) << "Phase" << std::setw(8) << "Thread" << std::right
+           << std::setw(11) << "Time (ms)" << std::setw(10) << "Mcycles" << std::setw(10) << "Minstr"
+           << std::setw(7) << "IPC" << std::setw(12) << "Brmiss/px" << std::setw(12) << "LLCmiss/px" << std::endl;
+    for (const PerfPhase& P : Phases)
+    {
+        report_row(Stream, P.Name, "all", P.Seconds, P.total(), P.Pixels);
+        for (size_t t = 0; t < P.Threads.size(); ++t)
+            report_row(Stream, "", std::to_string(t), P.ThreadSeconds[t], P.Threads[t], P.ThreadPixels[t]);
+    }
+    Stream.flags(Flags);
+}
@@ -0,0 +1,403 @@
+/**
+ * @file        pyramid.cpp
+ *
+ * @brief       Implementation of the tile pyramid generation.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <pyramid.hpp>
+#include <compute_renderer.hpp>
+#include <tile_writer.hpp>
+#include <memory_tracker.hpp>
+#include <metrics.hpp>
+#include <stage_timer.hpp>
+#include <tracer.hpp>
+#include <stb_image_write.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+
+// Largest block rendered with a single dispatch
+const int MaxBlockSize = 2048;
+
+
+struct PyramidBuilder
+{
+    FractalType Type;
+    ParamsStruct Params;
+    PyramidOptions Options;
+    ComputeRenderer Renderer;
+
+    int Depth;          // Index of the deepest level
+    int BlockLevels;    // Number of levels below a block root produced from the same block
+    int BlockSize;      // TileSize << BlockLevels
+    int LogTileSize;
+
+    std::vector<unsigned char> Block;
+    std::vector<unsigned char> BlockReadback;
+    std::vector<unsigned char> Encoded;
+    TileWriter Writer;
+    std::set<std::pair<int, long long>> Columns;
+    long long TilesWritten;
+    long long TotalTiles;
+    std::chrono::steady_clock::time_point LastReport;
+};
+
+
+static void downsample_rows(const unsigned char* Src, long long SrcStride, int DstW,
+                            unsigned char* Dst, long long DstStride, int RowBegin, int RowEnd)
+{
+    TRACE_SCOPE("downsample_rows", RowBegin);
+    for (int i = RowBegin; i < RowEnd; ++i)
+    {
+        const unsigned char* S0 = Src + (2 * i) * SrcStride;
+        const unsigned char* S1 = S0 + SrcStride;
+        unsigned char* D = Dst + i * DstStride;
+        for (int j = 0; j < DstW * 3; j += 3)
+        {
+            for (int k = 0; k < 3; ++k)
+                D[j + k] = (unsigned char)((S0[2 * j + k] + S0[2 * j + 3 + k] +
+                                            S1[2 * j + k] + S1[2 * j + 3 + k] + 2) / 4);
+        }
+    }
+}
+
+
+/**
+ * Halves a SrcW x SrcH RGB image with a box filter. Large images are split by rows among the
+ * available hardware threads, so Src and Dst must not overlap unless the image is small.
+ */
+static void downsample_2x(const unsigned char* Src, int SrcW, int SrcH, long long SrcStride,
+                          unsigned char* Dst, long long DstStride)
+{
+    int DstW = SrcW / 2;
+    int DstH = SrcH / 2;
+    int NThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    if ((long long)SrcW * SrcH < 512 * 512 || NThreads == 1)
+    {
+        downsample_rows(Src, SrcStride, DstW, Dst, DstStride, 0, DstH);
+        return;
+    }
+    NThreads = std::min(NThreads, DstH);
+    std::vector<std::thread> Workers;
+    for (int t = 0; t < NThreads; ++t)
+    {
+        int RowBegin = (int)((long long)DstH * t / NThreads);
+        int RowEnd = (int)((long long)DstH * (t + 1) / NThreads);
+        Workers.emplace_back(downsample_rows, Src, SrcStride, DstW, Dst, DstStride, RowBegin, RowEnd);
+    }
+    for (std::thread& W : Workers)
+        W.join();
+}
+
+
+static std::string tile_path(PyramidBuilder& B, int Level, long long X, long long Y)
+{
+    std::stringstream ss;
+    if (B.Options.Layout == PyramidLayout::DEEP_ZOOM)
+        ss << B.Options.Output << "_files/" << Level << "/" << X << "_" << Y << ".png";
+    else
+    {
+        // Column directories are created lazily, since the deepest levels have a lot of them
+        std::filesystem::path Dir = std::filesystem::path(B.Options.Output) / std::to_string(Level) / std::to_string(X);
+        std::error_code Error;
+        if (B.Columns.insert(std::make_pair(Level, X)).second)
+            std::filesystem::create_directories(Dir, Error);
+        ss << Dir.string() << "/" << Y << ".png";
+    }
+    return ss.str();
+}
+
+
+static void append_bytes(void* Context, void* Data, int Size)
+{
+    std::vector<unsigned char>* Buffer = (std::vector<unsigned char>*)Context;
+    Buffer->insert(Buffer->end(), (unsigned char*)Data, (unsigned char*)Data + Size);
+}
+
+
+/**
+ * Encodes a tile in memory and queues it to the writer, which writes it in the background.
+ */
+static bool queue_png(PyramidBuilder& B, const std::string& Path, int Size, const unsigned char* RGB, long long Stride)
+{
+    B.Encoded.clear();
+    bool Encoded;
+    {
+        CPUStageScope Scope(STAGE_ENCODE);
+        TRACE_SCOPE("encode_png");
+        Encoded = stbi_write_png_to_func(append_bytes, &B.Encoded, Size, Size, 3, RGB, (int)Stride) != 0;
+    }
+    if (!Encoded || !B.Writer.write(Path, B.Encoded))
+    {
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+static bool write_tile(PyramidBuilder& B, int Level, long long X, long long Y, int Size,
+                       const unsigned char* RGB, long long Stride)
+{
+    // Deep Zoom also counts the levels smaller than a tile
+    int FileLevel = Level;
+    if (B.Options.Layout == PyramidLayout::DEEP_ZOOM)
+        FileLevel += B.LogTileSize;
+    if (!queue_png(B, tile_path(B, FileLevel, X, Y), Size, RGB, Stride))
+        return false;
+
+    ++B.TilesWritten;
+    metrics().add(METRIC_TILES);
+    std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(Now - B.LastReport).count() >= 1.0)
+    {
+        std::cout << B.TilesWritten << "/" << B.TotalTiles << " tiles written." << std::endl;
+        B.LastReport = Now;
+    }
+    return true;
+}
+
+
+/**
+ * Renders Size x Size pixels of the given level, starting at pixel (X0, Y0), into B.Block,
+ * with rows stored top-down.
+ */
+static void render_block(PyramidBuilder& B, int Level, long long X0, long long Y0, int Size)
+{
+    TRACE_SCOPE("render_block", Level);
+    long long LevelSize = (long long)B.Options.TileSize << Level;
+    compute_render(B.Renderer, tile_params(B.Params, LevelSize, LevelSize, X0, Y0, B.BlockSize));
+    compute_readback_rgb(B.Renderer, B.BlockReadback.data());
+    // Only the top-left Size x Size corner is used when the level is smaller than a block
+    size_t RowLen = (size_t)B.BlockSize * 3;
+    for (int i = 0; i < Size; ++i)
+        std::copy_n(B.BlockReadback.data() + (B.BlockSize - 1 - i) * RowLen, (size_t)Size * 3,
+                    B.Block.data() + i * RowLen);
+}
+
+
+/**
+ * Builds the subtree rooted at tile (X, Y) of the given level and stores the root tile into Out.
+ */
+static bool build_node(PyramidBuilder& B, int Level, long long X, long long Y, unsigned char* Out)
+{
+    int T = B.Options.TileSize;
+    long long RowLen = (long long)T * 3;
+
+    if (Level == B.Depth - B.BlockLevels)
+    {
+        // A single block covers the whole subtree: render its deepest level and downsample it,
+        // alternating between the two block buffers
+        render_block(B, B.Depth, X * B.BlockSize, Y * B.BlockSize, B.BlockSize);
+        unsigned char* Cur = B.Block.data();
+        unsigned char* Next = B.BlockReadback.data();
+        long long Stride = (long long)B.BlockSize * 3;
+        for (int l = B.Depth; l >= Level; --l)
+        {
+            int NTiles = 1 << (l - Level);
+            for (int i = 0; i < NTiles; ++i)
+            {
+                for (int j = 0; j < NTiles; ++j)
+                {
+                    const unsigned char* Tile = Cur + i * T * Stride + j * RowLen;
+                    if (!write_tile(B, l, X * NTiles + j, Y * NTiles + i, T, Tile, Stride))
+                        return false;
+                }
+            }
+            if (l > Level)
+            {
+                downsample_2x(Cur, T * NTiles, T * NTiles, Stride, Next, Stride);
+                std::swap(Cur, Next);
+            }
+        }
+        for (int i = 0; i < T; ++i)
+            std::copy_n(Cur + i * Stride, RowLen, Out + i * RowLen);
+        return true;
+    }
+
+    // Otherwise, build the four children and downsample each of them into a quadrant
+    std::vector<unsigned char> Child((size_t)T * T * 3);
+    for (int q = 0; q < 4; ++q)
+    {
+        int dx = q % 2;
+        int dy = q / 2;
+        if (!build_node(B, Level + 1, 2 * X + dx, 2 * Y + dy, Child.data()))
+            return false;
+        unsigned char* Quadrant = Out + (dy * T / 2) * RowLen + (dx * T / 2) * 3;
+        downsample_2x(Child.data(), T, T, RowLen, Quadrant, RowLen);
+    }
+    return write_tile(B, Level, X, Y, T, Out, RowLen);
+}
+
+
+/**
+ * Renders every level at its native resolution, in blocks of at most B.BlockSize pixels.
+ */
+static bool build_native(PyramidBuilder& B, unsigned char* Root)
+{
+    int T = B.Options.TileSize;
+    long long Stride = (long long)B.BlockSize * 3;
+    for (int Level = 0; Level <= B.Depth; ++Level)
+    {
+        long long LevelSize = (long long)T << Level;
+        int Size = (int)std::min((long long)B.BlockSize, LevelSize);
+        long long NBlocks = LevelSize / Size;
+        int NTiles = Size / T;
+        for (long long by = 0; by < NBlocks; ++by)
+        {
+            for (long long bx = 0; bx < NBlocks; ++bx)
+            {
+                render_block(B, Level, bx * Size, by * Size, Size);
+                for (int i = 0; i < NTiles; ++i)
+                {
+                    for (int j = 0; j < NTiles; ++j)
+                    {
+                        const unsigned char* Tile = B.Block.data() + i * T * Stride + j * T * 3;
+                        if (!write_tile(B, Level, bx * NTiles + j, by * NTiles + i, T, Tile, Stride))
+                            return false;
+                    }
+                }
+            }
+        }
+        if (Level == 0)
+        {
+            for (int i = 0; i < T; ++i)
+                std::copy_n(B.Block.data() + i * Stride, (size_t)T * 3, Root + (size_t)i * T * 3);
+        }
+    }
+    return true;
+}
+
+
+static bool write_dzi_descriptor(PyramidBuilder& B)
+{
+    long long Size = (long long)B.Options.TileSize << B.Depth;
+    std::ofstream Stream(B.Options.Output + ".dzi", std::ios::out);
+    if (!Stream.is_open())
+    {
+        std::cerr << "Cannot write " << B.Options.Output << ".dzi." << std::endl;
+        return false;
+    }
+    Stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+    Stream << "<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\" Format=\"png\" Overlap=\"0\" TileSize=\"" <<
+              B.Options.TileSize << "\">" << std::endl;
+    Stream << "    <Size Width=\"" << Size << "\" Height=\"" << Size << "\"/>" << std::endl;
+    Stream << "</Image>" << std::endl;
+    return true;
+}
+
+
+bool build_pyramid(FractalType Type, const ParamsStruct& Params, const PyramidOptions& Options)
+{
+    int T = Options.TileSize;
+    if (Options.Levels < 1 || Options.Levels > 31 || T < 1 || (T & (T - 1)) != 0)
+    {
+        std::cerr << "The pyramid needs at least one level and a power of two tile size." << std::endl;
+        return false;
+    }
+
+    PyramidBuilder B;
+    B.Type = Type;
+    B.Params = Params;
+    B.Options = Options;
+    B.Depth = Options.Levels - 1;
+    B.LogTileSize = 0;
+    while ((1 << B.LogTileSize) < T)
+        ++B.LogTileSize;
+
+    GLint MaxTexSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &MaxTexSize);
+    int MaxBlock = std::min(MaxBlockSize, (int)MaxTexSize);
+    if (T > MaxBlock)
+    {
+        std::cerr << "Tile size exceeds the maximum texture size." << std::endl;
+        return false;
+    }
+    B.BlockLevels = 0;
+    while (B.BlockLevels < B.Depth && (T << (B.BlockLevels + 1)) <= MaxBlock)
+        ++B.BlockLevels;
+    // Smaller blocks if the RGBA32F texture and the two RGB copies do not fit in the memory budget
+    const size_t BlockBytesPerPixel = 16 + 3 + 3;
+    while (B.BlockLevels > 0 && ((size_t)T << B.BlockLevels) * ((size_t)T << B.BlockLevels) * BlockBytesPerPixel >
+                                memory_tracker().available())
+        --B.BlockLevels;
+    B.BlockSize = T << B.BlockLevels;
+    MemoryReservation BlockBytes;
+    if (!BlockBytes.reserve(MEM_STAGING, (size_t)B.BlockSize * B.BlockSize * 6, "the pyramid blocks"))
+        return false;
+    B.Block.resize((size_t)B.BlockSize * B.BlockSize * 3);
+    B.BlockReadback.resize(B.Block.size());
+    B.TilesWritten = 0;
+    B.TotalTiles = 0;
+    for (int l = 0; l <= B.Depth; ++l)
+        B.TotalTiles += 1LL << (2 * l);
+    B.LastReport = std::chrono::steady_clock::now();
+
+    if (!create_compute_renderer(B.Renderer, Type, Params, B.BlockSize, B.BlockSize))
+        return false;
+    B.Writer.create(Options.MaxPendingWrites, Options.ThreadedWrites);
+
+    // Create the level directories
+    std::error_code Error;
+    if (Options.Layout == PyramidLayout::DEEP_ZOOM)
+    {
+        for (int l = 0; l <= B.Depth + B.LogTileSize && !Error; ++l)
+            std::filesystem::create_directories(Options.Output + "_files/" + std::to_string(l), Error);
+    }
+    else
+        std::filesystem::create_directories(Options.Output, Error);
+    if (Error)
+    {
+        std::cerr << "Cannot create the output directories: " << Error.message() << "." << std::endl;
+        destroy_compute_renderer(B.Renderer);
+        return false;
+    }
+
+    std::cout << "Building a " << Options.Levels << "-level pyramid of " << B.TotalTiles << " tiles, " <<
+                 "rendered in blocks of " << B.BlockSize << "x" << B.BlockSize << ", written with " <<
+                 B.Writer.backend() << "." << std::endl;
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+    std::vector<unsigned char> Root((size_t)T * T * 3);
+    bool Success;
+    if (Options.Downsample)
+        Success = build_node(B, 0, 0, 0, Root.data());
+    else
+        Success = build_native(B, Root.data());
+
+    // Deep Zoom goes down to a single pixel
+    if (Success && Options.Layout == PyramidLayout::DEEP_ZOOM)
+    {
+        Success = write_dzi_descriptor(B);
+        long long RowLen = (long long)T * 3;
+        // downsample_2x splits large images among threads, so it cannot work in place
+        std::vector<unsigned char> Scratch(Root.size());
+        for (int l = B.LogTileSize - 1; l >= 0 && Success; --l)
+        {
+            downsample_2x(Root.data(), 2 << l, 2 << l, RowLen, Scratch.data(), RowLen);
+            Root.swap(Scratch);
+            std::string Path = Options.Output + "_files/" + std::to_string(l) + "/0_0.png";
+            Success = queue_png(B, Path, 1 << l, Root.data(), RowLen);
+        }
+    }
+    // The tiles count as written only once they are on disk
+    Success = B.Writer.finish() && Success;
+
+    double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    if (Success)
+        std::cout << "Wrote " << B.TilesWritten << " tiles in " << Elapsed << " seconds." << std::endl;
+
+    destroy_compute_renderer(B.Renderer);
+    return Success;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file        raster_file.cpp
+ *
+ * @brief       Implementation of the random-access PPM writer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <raster_file.hpp>
+#include <metrics.hpp>
+#include <iostream>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+
+// Images larger than 2GB need 64-bit offsets
+static int seek64(FILE* Handle, long long Offset)
+{
+#ifdef _WIN32
+    return _fseeki64(Handle, Offset, SEEK_SET);
+#else
+    return fseeko(Handle, (off_t)Offset, SEEK_SET);
+#endif
+}
+
+static long long file_size(FILE* Handle)
+{
+#ifdef _WIN32
+    if (_fseeki64(Handle, 0, SEEK_END) != 0)
+        return -1;
+    return _ftelli64(Handle);
+#else
+    if (fseeko(Handle, 0, SEEK_END) != 0)
+        return -1;
+    return (long long)ftello(Handle);
+#endif
+}
+
+bool sync_file(FILE* Handle)
+{
+    // fflush only hands the data to the operating system
+    if (fflush(Handle) != 0)
+        return false;
+#ifdef _WIN32
+    return _commit(_fileno(Handle)) == 0;
+#else
+    return fsync(fileno(Handle)) == 0;
+#endif
+}
+
+
+bool raster_create(RasterFile& Raster, const std::string& Path, long long Width, long long Height)
+{
+    Raster.Handle = fopen(Path.c_str(), "wb");
+    if (Raster.Handle == NULL)
+    {
+        std::cerr << "Cannot open " << Path << " for writing." << std::endl;
+        return false;
+    }
+    Raster.Width = Width;
+    Raster.Height = Height;
+
+    int HeaderLen = fprintf(Raster.Handle, "P6\n%lld %lld\n255\n", Width, Height);
+    if (HeaderLen < 0)
+    {
+        raster_close(Raster);
+        return false;
+    }
+    Raster.DataStart = HeaderLen;
+
+    // Writing the last byte sizes the file, which most filesystems keep sparse
+    long long LastByte = Raster.DataStart + Width * Height * 3 - 1;
+    unsigned char Zero = 0;
+    if (seek64(Raster.Handle, LastByte) != 0 || fwrite(&Zero, 1, 1, Raster.Handle) != 1)
+    {
+        std::cerr << "Cannot allocate " << Path << "." << std::endl;
+        raster_close(Raster);
+        return false;
+    }
+    return true;
+}
+
+
+bool raster_open(RasterFile& Raster, const std::string& Path, long long Width, long long Height)
+{
+    Raster.Handle = fopen(Path.c_str(), "r+b");
+    if (Raster.Handle == NULL)
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        return false;
+    }
+    Raster.Width = Width;
+    Raster.Height = Height;
+
+    char Expected[64];
+    char Header[64];
+    int HeaderLen = snprintf(Expected, sizeof(Expected), "P6\n%lld %lld\n255\n", Width, Height);
+    if (fread(Header, 1, HeaderLen, Raster.Handle) != (size_t)HeaderLen || memcmp(Header, Expected, HeaderLen) != 0 ||
+        file_size(Raster.Handle) != HeaderLen + Width * Height * 3)
+    {
+        std::cerr << Path << " is not a " << Width << "x" << Height << " image." << std::endl;
+        raster_close(Raster);
+        return false;
+    }
+    Raster.DataStart = HeaderLen;
+    return true;
+}
+
+
+bool raster_write_block(RasterFile& Raster, long long X0, long long Y0, int Cols, int Rows,
+                        const unsigned char* RGB, long long Stride)
+{
+    for (int i = 0; i < Rows; ++i)
+    {
+        long long Offset = Raster.DataStart + ((Y0 + i) * Raster.Width + X0) * 3;
+        if (seek64(Raster.Handle, Offset) != 0)
+            return false;
+        if (fwrite(RGB + i * Stride, 3, Cols, Raster.Handle) != (size_t)Cols)
+            return false;
+    }
+    metrics().add(METRIC_EXPORT_BYTES, 3.0 * Cols * Rows);
+    return true;
+}
+
+
+bool raster_sync(RasterFile& Raster)
+{
+    return sync_file(Raster.Handle);
+}
+
+
+void raster_close(RasterFile& Raster)
+{
+    if (Raster.Handle != NULL)
+        fclose(Raster.Handle);
+    Raster = RasterFile();
+}
@@ -0,0 +1,104 @@
+/**
+ * @file        reference_orbit.cpp
+ *
+ * @brief       Implementation of the reference orbits.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <reference_orbit.hpp>
+#include <big_fixed.hpp>
+#include <memory_tracker.hpp>
+#include <tracer.hpp>
+#include <npy_file.hpp>
+#include <chrono>
+#include <iostream>
+#include <stdio.h>
+#include <stdint.h>
+
+
+static bool write_npy(const std::string& Path, const std::vector<double>& Orbit)
+{
+    FILE* Stream = npy_create(Path, "<f8", { (long long)Orbit.size() / 2, 2 });
+    if (Stream == NULL)
+        return false;
+    bool Success = fwrite(Orbit.data(), sizeof(double), Orbit.size(), Stream) == Orbit.size();
+    Success = fclose(Stream) == 0 && Success;
+    if (!Success)
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+    return Success;
+}
+
+
+bool reference_orbit(FractalType Type, const ParamsStruct& Params, const ReferenceOrbitOptions& Options,
+                     std::vector<double>& Orbit)
+{
+    TRACE_SCOPE("reference_orbit");
+    if (Type != FractalType::MANDELBROT && Type != FractalType::JULIA)
+    {
+        std::cerr << "Reference orbits are only available for Mandelbrot's and Julia's sets." << std::endl;
+        return false;
+    }
+
+    int Limbs = big_fixed_limbs(Options.Log10Scale);
+    BigComplex Center(Limbs);
+    if (!Center.Re.parse(Options.CenterX.c_str()) || !Center.Im.parse(Options.CenterY.c_str()))
+    {
+        std::cerr << "The center of the orbit must be given as two decimal numbers." << std::endl;
+        return false;
+    }
+    BigComplex z(Limbs);
+    BigComplex c(Limbs);
+    if (Type == FractalType::MANDELBROT)
+        c = Center;
+    else
+    {
+        double Re, Im;
+        julia_constant(Params.angle, Re, Im);
+        c.Re.set(Re);
+        c.Im.set(Im);
+        z = Center;
+    }
+
+    // The orbit has one point more than the iterations, the starting one
+    MemoryReservation OrbitBytes;
+    if (!OrbitBytes.reserve(MEM_IMAGES, (size_t)(Options.Iterations + 1) * 2 * sizeof(double), "the orbit"))
+        return false;
+    try
+    {
+        Orbit.clear();
+        Orbit.reserve((size_t)(Options.Iterations + 1) * 2);
+    }
+    catch (const std::bad_alloc&)
+    {
+        std::cerr << "Cannot allocate an orbit of " << Options.Iterations << " iterations." << std::endl;
+        return false;
+    }
+
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    BigWorkspace W;
+    Orbit.push_back(z.Re.to_double());
+    Orbit.push_back(z.Im.to_double());
+    long long i = 0;
+    for (; i < Options.Iterations && z.norm() <= 4.0; ++i)
+    {
+        z.square_add(c, W);
+        Orbit.push_back(z.Re.to_double());
+        Orbit.push_back(z.Im.to_double());
+    }
+    double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    std::cout << "Reference orbit of " << i << " iterations with " << Limbs << " limbs (" << 64 * (Limbs - 1)
+              << " fractional bits) in " << Seconds << " s, " << (Seconds > 0.0 ? i / Seconds : 0.0)
+              << " iterations/s." << std::endl;
+    if (i < Options.Iterations)
+        std::cout << "The orbit escapes after " << i << " iterations." << std::endl;
+    if (Options.Output.empty())
+        return true;
+    if (!write_npy(Options.Output, Orbit))
+        return false;
+    std::cout << "Reference orbit written to " << Options.Output << "." << std::endl;
+    return true;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file        session.cpp
+ *
+ * @brief       Implementation of the session recorder.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <session.hpp>
+#include <stage_timer.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+
+
+const char* const SessionMagic = "GPUFractalsSession";
+const int SessionVersion = 2;
+
+
+bool session_create(SessionWriter& Writer, const std::string& Path, const SessionHeader& Header)
+{
+    Writer.Path = Path;
+    Writer.Handle = fopen(Path.c_str(), "w");
+    if (Writer.Handle == NULL)
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        return false;
+    }
+    // 17 significant digits restore every double exactly, and so both halves of the center
+    const ParamsStruct& P = Header.Params;
+    const ViewModel& V = Header.View;
+    if (fprintf(Writer.Handle, "%s %d\n%d %d %d %.17g %.17g %.17g %.17g %.17g %d %d %.17g %.17g "
+                "%.17g %.17g %.17g %.17g %.17g %.17g\n", SessionMagic, SessionVersion, (int)Header.Type, P.niters,
+                P.nroots, P.angle, P.xlim[0], P.xlim[1], P.ylim[0], P.ylim[1], Header.WinWidth, Header.WinHeight,
+                Header.MouseX, Header.MouseY, V.CenterX.Hi, V.CenterX.Lo, V.CenterY.Hi, V.CenterY.Lo, V.HalfWidth,
+                V.HalfHeight) < 0)
+    {
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool session_write_frame(SessionWriter& Writer, const SessionFrame& Frame)
+{
+    const InputSample& In = Frame.Input;
+    const ParamsStruct& P = Frame.Params;
+    if (fprintf(Writer.Handle, "%.17g %.17g %.17g %d %d %d %.17g %.17g %.17g %.17g\n", In.Time, In.MouseX, In.MouseY,
+                In.Buttons, In.Keys, P.niters, P.xlim[0], P.xlim[1], P.ylim[0], P.ylim[1]) < 0)
+    {
+        std::cerr << "Cannot write " << Writer.Path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool session_close(SessionWriter& Writer)
+{
+    if (Writer.Handle == NULL)
+        return true;
+    bool Success = fclose(Writer.Handle) == 0;
+    Writer.Handle = NULL;
+    if (!Success)
+        std::cerr << "Cannot write " << Writer.Path << "." << std::endl;
+    return Success;
+}
+
+
+bool session_read(const std::string& Path, SessionHeader& Header, std::vector<SessionFrame>& Frames)
+{
+    std::ifstream Stream(Path);
+    if (!Stream.is_open())
+    {
+        std::cerr << "Cannot open " << Path << "." << std::endl;
+        return false;
+    }
+
+    std::string Line;
+    int LineNo = 0;
+    bool HasMagic = false, HasHeader = false;
+    int Version = 0;
+    while (std::getline(Stream, Line))
+    {
+        ++LineNo;
+        if (Line.empty() || Line[0] == '#' || Line == "\r")
+            continue;
+        std::stringstream ss(Line);
+        if (!HasMagic)
+        {
+            std::string Magic;
+            if (!(ss >> Magic >> Version) || Magic != SessionMagic || Version < 1 || Version > SessionVersion)
+            {
+                std::cerr << Path << " is not a session file." << std::endl;
+                return false;
+            }
+            HasMagic = true;
+        }
+        else if (!HasHeader)
+        {
+            int Type;
+            ParamsStruct& P = Header.Params;
+            if (!(ss >> Type >> P.niters >> P.nroots >> P.angle >> P.xlim[0] >> P.xlim[1] >> P.ylim[0] >> P.ylim[1] >>
+                  Header.WinWidth >> Header.WinHeight >> Header.MouseX >> Header.MouseY) ||
+                Type < 0 || Type >= FractalType::INVALID)
+            {
+                std::cerr << "Invalid session header at line " << LineNo << " of " << Path << "." << std::endl;
+                return false;
+            }
+            // Version 1 only has the limits
+            ViewModel& V = Header.View;
+            V = view_from_params(P);
+            if (Version >= 2 && !(ss >> V.CenterX.Hi >> V.CenterX.Lo >> V.CenterY.Hi >> V.CenterY.Lo >> V.HalfWidth >>
+                                  V.HalfHeight))
+            {
+                std::cerr << "Invalid session header at line " << LineNo << " of " << Path << "." << std::endl;
+                return false;
+            }
+            Header.Type = (FractalType)Type;
+            HasHeader = true;
+        }
+        else
+        {
+            SessionFrame F;
+            F.Params = Header.Params;
+            InputSample& In = F.Input;
+            ParamsStruct& P = F.Params;
+            if (!(ss >> In.Time >> In.MouseX >> In.MouseY >> In.Buttons >> In.Keys >> P.niters >> P.xlim[0] >>
+                  P.xlim[1] >> P.ylim[0] >> P.ylim[1]))
+            {
+                std::cerr << "Invalid frame at line " << LineNo << " of " << Path << "." << std::endl;
+                return false;
+            }
+            Frames.push_back(F);
+        }
+    }
+    if (!HasHeader)
+    {
+        std::cerr << Path << " is not a session file." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool session_same_view(const ParamsStruct& P1, const ParamsStruct& P2)
+{
+    return P1.niters == P2.niters && P1.xlim[0] == P2.xlim[0] && P1.xlim[1] == P2.xlim[1] &&
+           P1.ylim[0] == P2.ylim[0] && P1.ylim[1] == P2.ylim[1];
+}
+
+
+void frame_time_report(std::ostream& Stream, std::vector<double> FrameMs)
+{
+    if (FrameMs.empty())
+    {
+        Stream << "No frames." << std::endl;
+        return;
+    }
+    std::sort(FrameMs.begin(), FrameMs.end());
+    double Mean = std::accumulate(FrameMs.begin(), FrameMs.end(), 0.0) / FrameMs.size();
+    std::ios::fmtflags Flags = Stream.flags();
+    Stream << std::fixed << std::setprecision(2);
+    Stream << FrameMs.size() << " frames, mean " << Mean << " ms (" << 1000.0 / std::max(Mean, 1e-9) << " fps)" << std::endl;
+    Stream << "    p50 " << percentile(FrameMs, 50.0) << " ms, p90 " << percentile(FrameMs, 90.0)
+           << " ms, p99 " << percentile(FrameMs, 99.0) << " ms, max " << FrameMs.back() << " ms" << std::endl;
+    Stream.flags(Flags);
+}
@@ -0,0 +1,190 @@
+/**
+ * @file        stage_timer.cpp
+ *
+ * @brief       Implementation of the stage timer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <stage_timer.hpp>
+#include <metrics.hpp>
+#include <iomanip>
+#include <algorithm>
+#include <math.h>
+
+
+// Weight of the newest sample in the moving averages
+const double AverageWeight = 0.1;
+
+const char* const StageNames[STAGE_COUNT] = { "fragment", "compute", "readback", "encode" };
+
+
+const char* stage_name(StageType Stage)
+{
+    return StageNames[Stage];
+}
+
+
+double percentile(const std::vector<double>& Sorted, double P)
+{
+    if (Sorted.empty())
+        return 0.0;
+    size_t Rank = (size_t)ceil(P / 100.0 * Sorted.size());
+    return Sorted[std::min(std::max(Rank, (size_t)1), Sorted.size()) - 1];
+}
+
+
+StageTimer::StageTimer()
+    : m_Enabled(false), m_Open(-1), m_OpenIterations(0.0), m_FrameMs(0.0)
+{
+    for (int s = 0; s < STAGE_COUNT; ++s)
+        m_Next[s] = 0;
+    m_LastFrame = std::chrono::steady_clock::now();
+}
+
+
+void StageTimer::set_enabled(bool Enabled)
+{
+    m_Enabled.store(Enabled, std::memory_order_relaxed);
+}
+
+
+void StageTimer::begin_gpu(StageType Stage, double Iterations)
+{
+    if (!enabled() || m_Open != -1)
+        return;
+
+    // Reuse the older query of the stage, unless its result is still on the way
+    poll(Stage, false);
+    GPUQuery& Query = m_Queries[Stage][m_Next[Stage]];
+    if (Query.Pending)
+        return;
+    if (Query.Id == 0)
+        glGenQueries(1, &Query.Id);
+    glBeginQuery(GL_TIME_ELAPSED, Query.Id);
+    m_Open = Stage;
+    m_OpenIterations = Iterations;
+}
+
+
+void StageTimer::end_gpu(StageType Stage)
+{
+    if (m_Open != Stage)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    GPUQuery& Query = m_Queries[Stage][m_Next[Stage]];
+    Query.Pending = true;
+    Query.Iterations = m_OpenIterations;
+    m_Next[Stage] ^= 1;
+    m_Open = -1;
+}
+
+
+void StageTimer::poll(StageType Stage, bool Wait)
+{
+    // The query to be reused next is the older one
+    for (int k = 0; k < 2; ++k)
+    {
+        GPUQuery& Query = m_Queries[Stage][m_Next[Stage] ^ k];
+        if (!Query.Pending)
+            continue;
+        GLint Available = GL_TRUE;
+        if (!Wait)
+            glGetQueryObjectiv(Query.Id, GL_QUERY_RESULT_AVAILABLE, &Available);
+        if (!Available)
+            break;
+        GLuint64 Elapsed = 0;
+        glGetQueryObjectui64v(Query.Id, GL_QUERY_RESULT, &Elapsed);
+        Query.Pending = false;
+        record(Stage, Elapsed * 1e-6, Query.Iterations);
+    }
+}
+
+
+void StageTimer::record(StageType Stage, double Ms, double Iterations)
+{
+    if (!enabled())
+        return;
+    metrics().observe(Stage, Ms * 1e-3);
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    StageStats& S = m_Stats[Stage];
+    S.LastMs = Ms;
+    S.AverageMs = S.Count == 0 ? Ms : S.AverageMs + AverageWeight * (Ms - S.AverageMs);
+    S.TotalMs += Ms;
+    S.Iterations += Iterations;
+    ++S.Count;
+}
+
+
+void StageTimer::end_frame()
+{
+    std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+    double Ms = std::chrono::duration<double, std::milli>(Now - m_LastFrame).count();
+    m_LastFrame = Now;
+    m_FrameMs = m_FrameMs == 0.0 ? Ms : m_FrameMs + AverageWeight * (Ms - m_FrameMs);
+
+    if (!enabled())
+        return;
+    for (int s = 0; s < STAGE_COUNT; ++s)
+        poll((StageType)s, false);
+}
+
+
+StageStats StageTimer::stats(StageType Stage)
+{
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    return m_Stats[Stage];
+}
+
+
+void StageTimer::report(std::ostream& Stream)
+{
+    if (!enabled())
+        return;
+    for (int s = 0; s < STAGE_COUNT; ++s)
+        poll((StageType)s, true);
+
+    Stream << "Stage        Count   Mean (ms)    Total (ms)   Giter/s" << std::endl;
+    std::ios::fmtflags Flags = Stream.flags();
+    Stream << std::fixed;
+    for (int s = 0; s < STAGE_COUNT; ++s)
+    {
+        StageStats S = stats((StageType)s);
+        if (S.Count == 0)
+            continue;
+        Stream << std::left << std::setw(10) << StageNames[s] << std::right
+               << std::setw(8) << S.Count
+               << std::setw(12) << std::setprecision(3) << S.TotalMs / S.Count
+               << std::setw(14) << std::setprecision(1) << S.TotalMs;
+        if (S.Iterations > 0.0 && S.TotalMs > 0.0)
+            Stream << std::setw(10) << std::setprecision(2) << S.Iterations / (S.TotalMs * 1e6);
+        Stream << std::endl;
+    }
+    Stream.flags(Flags);
+}
+
+
+void StageTimer::destroy()
+{
+    if (m_Open != -1)
+        glEndQuery(GL_TIME_ELAPSED);
+    m_Open = -1;
+    for (int s = 0; s < STAGE_COUNT; ++s)
+    {
+        for (int k = 0; k < 2; ++k)
+        {
+            if (m_Queries[s][k].Id != 0)
+                glDeleteQueries(1, &m_Queries[s][k].Id);
+            m_Queries[s][k] = GPUQuery();
+        }
+    }
+}
+
+
+StageTimer& stage_timer()
+{
+    static StageTimer Timer;
+    return Timer;
+}
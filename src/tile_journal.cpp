@@ -0,0 +1,146 @@
+/**
+ * @file        tile_journal.cpp
+ *
+ * @brief       Implementation of the tile journal.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <tile_journal.hpp>
+#include <raster_file.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+
+
+static bool read_journal(TileJournal& Journal, const std::string& Header, bool& Resumed)
+{
+    Resumed = false;
+    std::ifstream Stream(Journal.Path);
+    if (!Stream.is_open())
+        return true;
+
+    std::string Line;
+    if (!std::getline(Stream, Line) || Stream.eof())
+        return true;    // Torn before the header was complete, nothing to resume
+    if (Line != Header)
+    {
+        std::cerr << Journal.Path << " belongs to a different render. Remove it to start over." << std::endl;
+        return false;
+    }
+
+    while (std::getline(Stream, Line))
+    {
+        // The last line is torn if the newline is missing
+        if (Stream.eof())
+            break;
+        if (Line.empty())
+            continue;
+        std::stringstream ss(Line);
+        long long Tile;
+        if (!(ss >> Tile) || Tile < 0 || Tile >= (long long)Journal.Done.size())
+            break;
+        if (!Journal.Done[Tile])
+        {
+            Journal.Done[Tile] = true;
+            ++Journal.DoneCount;
+        }
+    }
+    Resumed = true;
+    return true;
+}
+
+
+// Rewrites the journal with the tiles done so far, dropping torn lines, and reopens it to append
+static bool rewrite_journal(TileJournal& Journal, const std::string& Header)
+{
+    if (Journal.Handle != NULL)
+        fclose(Journal.Handle);
+    Journal.Handle = NULL;
+
+    std::string TmpPath = Journal.Path + ".tmp";
+    FILE* Tmp = fopen(TmpPath.c_str(), "wb");
+    bool Success = Tmp != NULL && fprintf(Tmp, "%s\n", Header.c_str()) >= 0;
+    for (long long Tile = 0; Success && Tile < (long long)Journal.Done.size(); ++Tile)
+    {
+        if (Journal.Done[Tile])
+            Success = fprintf(Tmp, "%lld\n", Tile) >= 0;
+    }
+    Success = Success && sync_file(Tmp);
+    if (Tmp != NULL)
+        fclose(Tmp);
+
+    std::error_code Error;
+    if (Success)
+        std::filesystem::rename(TmpPath, Journal.Path, Error);
+    if (Success && !Error)
+        Journal.Handle = fopen(Journal.Path.c_str(), "ab");
+    if (Journal.Handle == NULL)
+    {
+        std::cerr << "Cannot write " << Journal.Path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool journal_open(TileJournal& Journal, const std::string& Path, const std::string& Header,
+                  long long NTiles, bool& Resumed)
+{
+    Journal.Path = Path;
+    Journal.Done.assign(NTiles, false);
+    Journal.Pending.clear();
+    Journal.DoneCount = 0;
+    if (!read_journal(Journal, Header, Resumed))
+        return false;
+    return rewrite_journal(Journal, Header);
+}
+
+
+bool journal_reset(TileJournal& Journal, const std::string& Header)
+{
+    std::fill(Journal.Done.begin(), Journal.Done.end(), false);
+    Journal.Pending.clear();
+    Journal.DoneCount = 0;
+    return rewrite_journal(Journal, Header);
+}
+
+
+void journal_mark(TileJournal& Journal, long long Tile)
+{
+    Journal.Pending.push_back(Tile);
+}
+
+
+bool journal_commit(TileJournal& Journal)
+{
+    for (long long Tile : Journal.Pending)
+    {
+        if (fprintf(Journal.Handle, "%lld\n", Tile) < 0)
+            return false;
+    }
+    if (!sync_file(Journal.Handle))
+        return false;
+
+    for (long long Tile : Journal.Pending)
+    {
+        Journal.Done[Tile] = true;
+        ++Journal.DoneCount;
+    }
+    Journal.Pending.clear();
+    return true;
+}
+
+
+void journal_close(TileJournal& Journal, bool Remove)
+{
+    if (Journal.Handle != NULL)
+        fclose(Journal.Handle);
+    Journal.Handle = NULL;
+    if (Remove)
+        std::remove(Journal.Path.c_str());
+}
@@ -0,0 +1,470 @@
+/**
+ * @file        tile_writer.cpp
+ *
+ * @brief       Implementation of the asynchronous tile writer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <tile_writer.hpp>
+#include <tracer.hpp>
+#include <metrics.hpp>
+#include <iostream>
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+// io_uring is driven through its system calls, headers older than 5.7 lack the needed operations
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#ifdef IORING_FEAT_FAST_POLL
+#define HAS_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+#endif
+
+
+// Maximum number of threads of the fallback backend
+const int MaxWorkers = 8;
+
+
+#ifdef HAS_IO_URING
+
+/**
+ * Every file goes through three operations, each one submitted when the previous completes:
+ * openat, one or more writes, close. A slot holds a file from its submission to its close, so
+ * there is at most one operation per slot in the rings.
+ */
+struct IOUring
+{
+    enum SlotStage { FREE, OPEN, WRITE, CLOSE };
+
+    struct Slot
+    {
+        SlotStage Stage = FREE;
+        int Fd = -1;
+        size_t Written = 0;
+        bool Failed = false;
+        std::string Path;
+        std::vector<unsigned char> Data;
+    };
+
+    int Fd = -1;
+    void* SQRing = MAP_FAILED;
+    void* CQRing = MAP_FAILED;
+    size_t SQRingSize = 0;
+    size_t CQRingSize = 0;
+    io_uring_sqe* SQEs = (io_uring_sqe*)MAP_FAILED;
+    size_t SQEsSize = 0;
+
+    unsigned* SQTail;
+    unsigned SQMask;
+    unsigned* SQArray;
+    unsigned* CQHead;
+    unsigned* CQTail;
+    unsigned CQMask;
+    io_uring_cqe* CQEs;
+    unsigned ToSubmit = 0;
+
+    std::vector<Slot> Slots;
+    std::vector<int> FreeSlots;
+};
+
+
+static bool ring_supports(int Fd, const std::vector<int>& Ops)
+{
+    std::vector<unsigned char> Buffer(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* Probe = (io_uring_probe*)Buffer.data();
+    if (syscall(__NR_io_uring_register, Fd, IORING_REGISTER_PROBE, Probe, 256) < 0)
+        return false;
+    for (int Op : Ops)
+    {
+        if (Op > Probe->last_op || !(Probe->ops[Op].flags & IO_URING_OP_SUPPORTED))
+            return false;
+    }
+    return true;
+}
+
+
+static void ring_destroy(IOUring* R)
+{
+    if (R->SQEs != MAP_FAILED)
+        munmap(R->SQEs, R->SQEsSize);
+    if (R->CQRing != MAP_FAILED && R->CQRing != R->SQRing)
+        munmap(R->CQRing, R->CQRingSize);
+    if (R->SQRing != MAP_FAILED)
+        munmap(R->SQRing, R->SQRingSize);
+    if (R->Fd >= 0)
+        close(R->Fd);
+    delete R;
+}
+
+
+static IOUring* ring_create(unsigned Entries)
+{
+    io_uring_params Params;
+    memset(&Params, 0, sizeof(Params));
+    IOUring* R = new IOUring;
+    R->Fd = (int)syscall(__NR_io_uring_setup, Entries, &Params);
+    if (R->Fd < 0 || !(Params.features & IORING_FEAT_NODROP) ||
+        !ring_supports(R->Fd, { IORING_OP_OPENAT, IORING_OP_WRITE, IORING_OP_CLOSE }))
+    {
+        ring_destroy(R);
+        return NULL;
+    }
+
+    R->SQRingSize = Params.sq_off.array + Params.sq_entries * sizeof(unsigned);
+    R->CQRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+    if (Params.features & IORING_FEAT_SINGLE_MMAP)
+        R->SQRingSize = R->CQRingSize = std::max(R->SQRingSize, R->CQRingSize);
+    R->SQRing = mmap(NULL, R->SQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, R->Fd, IORING_OFF_SQ_RING);
+    if (R->SQRing != MAP_FAILED && (Params.features & IORING_FEAT_SINGLE_MMAP))
+        R->CQRing = R->SQRing;
+    else if (R->SQRing != MAP_FAILED)
+        R->CQRing = mmap(NULL, R->CQRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, R->Fd, IORING_OFF_CQ_RING);
+    R->SQEsSize = Params.sq_entries * sizeof(io_uring_sqe);
+    if (R->CQRing != MAP_FAILED)
+        R->SQEs = (io_uring_sqe*)mmap(NULL, R->SQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, R->Fd, IORING_OFF_SQES);
+    if (R->SQEs == MAP_FAILED)
+    {
+        ring_destroy(R);
+        return NULL;
+    }
+
+    unsigned char* SQ = (unsigned char*)R->SQRing;
+    unsigned char* CQ = (unsigned char*)R->CQRing;
+    R->SQTail = (unsigned*)(SQ + Params.sq_off.tail);
+    R->SQMask = *(unsigned*)(SQ + Params.sq_off.ring_mask);
+    R->SQArray = (unsigned*)(SQ + Params.sq_off.array);
+    R->CQHead = (unsigned*)(CQ + Params.cq_off.head);
+    R->CQTail = (unsigned*)(CQ + Params.cq_off.tail);
+    R->CQMask = *(unsigned*)(CQ + Params.cq_off.ring_mask);
+    R->CQEs = (io_uring_cqe*)(CQ + Params.cq_off.cqes);
+
+    // One operation per slot at most, so the submission queue never overflows
+    R->Slots.resize(std::min(Entries, Params.sq_entries));
+    for (int s = (int)R->Slots.size() - 1; s >= 0; --s)
+        R->FreeSlots.push_back(s);
+    return R;
+}
+
+
+static io_uring_sqe* ring_next_sqe(IOUring* R, int Slot, int Op)
+{
+    // This thread is the only producer, the kernel only reads the tail
+    unsigned Tail = *R->SQTail;
+    unsigned Index = Tail & R->SQMask;
+    io_uring_sqe* SQE = &R->SQEs[Index];
+    memset(SQE, 0, sizeof(*SQE));
+    SQE->opcode = (unsigned char)Op;
+    SQE->user_data = (unsigned long long)Slot;
+    R->SQArray[Index] = Index;
+    return SQE;
+}
+
+
+static void ring_push_sqe(IOUring* R)
+{
+    __atomic_store_n(R->SQTail, *R->SQTail + 1, __ATOMIC_RELEASE);
+    ++R->ToSubmit;
+}
+
+
+static void ring_submit_write(IOUring* R, int s)
+{
+    IOUring::Slot& Slot = R->Slots[s];
+    io_uring_sqe* SQE = ring_next_sqe(R, s, IORING_OP_WRITE);
+    SQE->fd = Slot.Fd;
+    SQE->addr = (unsigned long long)(Slot.Data.data() + Slot.Written);
+    SQE->len = (unsigned)std::min(Slot.Data.size() - Slot.Written, (size_t)1 << 30);
+    SQE->off = Slot.Written;
+    Slot.Stage = IOUring::WRITE;
+    ring_push_sqe(R);
+}
+
+
+static void ring_submit_close(IOUring* R, int s)
+{
+    IOUring::Slot& Slot = R->Slots[s];
+    io_uring_sqe* SQE = ring_next_sqe(R, s, IORING_OP_CLOSE);
+    SQE->fd = Slot.Fd;
+    Slot.Stage = IOUring::CLOSE;
+    ring_push_sqe(R);
+}
+
+
+static bool ring_enter(IOUring* R, unsigned MinComplete)
+{
+    while (R->ToSubmit > 0 || MinComplete > 0)
+    {
+        int Submitted = (int)syscall(__NR_io_uring_enter, R->Fd, R->ToSubmit, MinComplete,
+                                     MinComplete > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (Submitted < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            std::cerr << "io_uring_enter failed: " << strerror(errno) << "." << std::endl;
+            return false;
+        }
+        R->ToSubmit -= Submitted;
+        MinComplete = 0;
+    }
+    return true;
+}
+
+
+/**
+ * Moves the files whose operations completed to their next stage. Returns the number of files
+ * that failed.
+ */
+static int ring_reap(IOUring* R)
+{
+    int Failures = 0;
+    unsigned Head = *R->CQHead;
+    unsigned Tail = __atomic_load_n(R->CQTail, __ATOMIC_ACQUIRE);
+    for (; Head != Tail; ++Head)
+    {
+        const io_uring_cqe& CQE = R->CQEs[Head & R->CQMask];
+        int s = (int)CQE.user_data;
+        IOUring::Slot& Slot = R->Slots[s];
+        switch (Slot.Stage)
+        {
+        case IOUring::OPEN:
+            if (CQE.res < 0)
+            {
+                std::cerr << "Cannot open " << Slot.Path << ": " << strerror(-CQE.res) << "." << std::endl;
+                ++Failures;
+                Slot.Stage = IOUring::FREE;
+                R->FreeSlots.push_back(s);
+                break;
+            }
+            Slot.Fd = CQE.res;
+            if (Slot.Data.empty())
+                ring_submit_close(R, s);
+            else
+                ring_submit_write(R, s);
+            break;
+
+        case IOUring::WRITE:
+            if (CQE.res <= 0)
+            {
+                std::cerr << "Cannot write " << Slot.Path << ": " << strerror(CQE.res < 0 ? -CQE.res : EIO) << "." << std::endl;
+                Slot.Failed = true;
+                ring_submit_close(R, s);
+                break;
+            }
+            // Writes can be short, the rest is submitted again
+            Slot.Written += CQE.res;
+            if (Slot.Written < Slot.Data.size())
+                ring_submit_write(R, s);
+            else
+                ring_submit_close(R, s);
+            break;
+
+        case IOUring::CLOSE:
+            if (CQE.res < 0 || Slot.Failed)
+                ++Failures;
+            Slot.Stage = IOUring::FREE;
+            R->FreeSlots.push_back(s);
+            break;
+
+        default:
+            break;
+        }
+    }
+    __atomic_store_n(R->CQHead, Head, __ATOMIC_RELEASE);
+    metrics().set(METRIC_TILE_QUEUE, (double)(R->Slots.size() - R->FreeSlots.size()));
+    return Failures;
+}
+
+#else
+
+// Never instantiated without io_uring
+struct IOUring { };
+
+static void ring_destroy(IOUring* R)
+{
+    delete R;
+}
+
+#endif
+
+
+
+TileWriter::TileWriter()
+    : m_MaxInFlight(0), m_Failed(false), m_Ring(NULL), m_InFlight(0), m_Stop(false)
+{ }
+
+TileWriter::~TileWriter()
+{
+    finish();
+}
+
+
+bool TileWriter::create(int MaxInFlight, bool ForceThreads)
+{
+    m_MaxInFlight = std::max(MaxInFlight, 1);
+    m_Failed = false;
+    m_InFlight = 0;
+    m_Stop = false;
+
+#ifdef HAS_IO_URING
+    if (!ForceThreads)
+    {
+        m_Ring = ring_create((unsigned)m_MaxInFlight);
+        if (m_Ring != NULL)
+            return true;
+    }
+#endif
+
+    int NWorkers = std::min(m_MaxInFlight, MaxWorkers);
+    for (int t = 0; t < NWorkers; ++t)
+        m_Workers.emplace_back(&TileWriter::worker_loop, this);
+    return true;
+}
+
+
+const char* TileWriter::backend() const
+{
+    return m_Ring != NULL ? "io_uring" : "threads";
+}
+
+
+void TileWriter::recycle(std::vector<unsigned char>& Data)
+{
+    Data.clear();
+    if (!m_Spare.empty())
+    {
+        Data.swap(m_Spare.back());
+        m_Spare.pop_back();
+    }
+}
+
+
+bool TileWriter::write(const std::string& Path, std::vector<unsigned char>& Data)
+{
+    TRACE_SCOPE("queue_write");
+    metrics().add(METRIC_EXPORT_BYTES, (double)Data.size());
+#ifdef HAS_IO_URING
+    if (m_Ring != NULL)
+    {
+        // Wait for a slot, moving the other files forward meanwhile
+        m_Failed |= ring_reap(m_Ring) > 0;
+        while (m_Ring->FreeSlots.empty())
+        {
+            if (!ring_enter(m_Ring, 1))
+                return false;
+            m_Failed |= ring_reap(m_Ring) > 0;
+        }
+
+        int s = m_Ring->FreeSlots.back();
+        m_Ring->FreeSlots.pop_back();
+        IOUring::Slot& Slot = m_Ring->Slots[s];
+        Slot.Path = Path;
+        Slot.Data.swap(Data);
+        Data.clear();
+        Slot.Written = 0;
+        Slot.Failed = false;
+        Slot.Fd = -1;
+
+        io_uring_sqe* SQE = ring_next_sqe(m_Ring, s, IORING_OP_OPENAT);
+        SQE->fd = AT_FDCWD;
+        SQE->addr = (unsigned long long)Slot.Path.c_str();
+        SQE->open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        SQE->len = 0644;
+        Slot.Stage = IOUring::OPEN;
+        ring_push_sqe(m_Ring);
+        return ring_enter(m_Ring, 0) && !m_Failed;
+    }
+#endif
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    m_Signal.wait(Lock, [this] { return m_InFlight < m_MaxInFlight; });
+    if (m_Failed)
+        return false;
+    ++m_InFlight;
+    m_Queue.push_back(Job());
+    m_Queue.back().Path = Path;
+    m_Queue.back().Data.swap(Data);
+    recycle(Data);
+    metrics().set(METRIC_TILE_QUEUE, m_InFlight);
+    m_Signal.notify_all();
+    return true;
+}
+
+
+void TileWriter::worker_loop()
+{
+    trace_thread_name("tile_writer");
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    while (true)
+    {
+        m_Signal.wait(Lock, [this] { return m_Stop || !m_Queue.empty(); });
+        if (m_Queue.empty())
+            return;
+        Job Current = std::move(m_Queue.front());
+        m_Queue.pop_front();
+        Lock.unlock();
+
+        bool Success;
+        {
+            TRACE_SCOPE("write_file");
+            FILE* Stream = fopen(Current.Path.c_str(), "wb");
+            Success = Stream != NULL && fwrite(Current.Data.data(), 1, Current.Data.size(), Stream) == Current.Data.size();
+            if (Stream != NULL)
+                Success = fclose(Stream) == 0 && Success;
+        }
+        if (!Success)
+            std::cerr << "Cannot write " << Current.Path << "." << std::endl;
+
+        Lock.lock();
+        m_Failed |= !Success;
+        Current.Data.clear();
+        m_Spare.push_back(std::move(Current.Data));
+        --m_InFlight;
+        metrics().set(METRIC_TILE_QUEUE, m_InFlight);
+        m_Signal.notify_all();
+    }
+}
+
+
+bool TileWriter::finish()
+{
+#ifdef HAS_IO_URING
+    if (m_Ring != NULL)
+    {
+        while (m_Ring->FreeSlots.size() < m_Ring->Slots.size())
+        {
+            if (!ring_enter(m_Ring, 1))
+            {
+                m_Failed = true;
+                break;
+            }
+            m_Failed |= ring_reap(m_Ring) > 0;
+        }
+    }
+#endif
+    if (m_Ring != NULL)
+        ring_destroy(m_Ring);
+    m_Ring = NULL;
+
+    if (!m_Workers.empty())
+    {
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            m_Stop = true;
+        }
+        m_Signal.notify_all();
+        for (std::thread& Worker : m_Workers)
+            Worker.join();
+        m_Workers.clear();
+    }
+    m_Spare.clear();
+    return !m_Failed;
+}
@@ -0,0 +1,273 @@
+/**
+ * @file        tiled_export.cpp
+ *
+ * @brief       Implementation of the tiled export.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <tiled_export.hpp>
+#include <compute_renderer.hpp>
+#include <raster_file.hpp>
+#include <tile_journal.hpp>
+#include <field_archive.hpp>
+#include <memory_tracker.hpp>
+#include <metrics.hpp>
+#include <stage_timer.hpp>
+#include <tracer.hpp>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <stdlib.h>
+#include <vector>
+
+
+// Size of the tiles of the field archives
+const int FieldTileSize = 256;
+
+
+// Identifies the render, so that a journal is never applied to a different one
+static std::string journal_header(FractalType Type, const ParamsStruct& Params, const TiledExportOptions& Options,
+                                  int TileSize)
+{
+    std::stringstream ss;
+    ss << std::setprecision(17) << "GPUFractals tiled export " << Type << " " << Params.niters << " " <<
+          Params.nroots << " " << Params.angle << " " << Params.xlim[0] << " " << Params.xlim[1] << " " <<
+          Params.ylim[0] << " " << Params.ylim[1] << " " << Options.Width << "x" << Options.Height << " " << TileSize;
+    return ss.str();
+}
+
+
+bool tiled_export(FractalType Type, const ParamsStruct& Params, const TiledExportOptions& Options)
+{
+    if (Options.Width < 1 || Options.Height < 1)
+    {
+        std::cerr << "Invalid export size." << std::endl;
+        return false;
+    }
+
+    GLint MaxTexSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &MaxTexSize);
+    int TileSize = std::min(Options.TileSize, (int)MaxTexSize);
+    if (TileSize < 1)
+    {
+        std::cerr << "Invalid tile size." << std::endl;
+        return false;
+    }
+    // The RGBA32F texture and the RGB tile buffer
+    TileSize = fit_tile_size(TileSize, 16 + 3);
+    if (TileSize == 0)
+    {
+        std::cerr << "Not even the smallest tile fits in the memory budget." << std::endl;
+        return false;
+    }
+
+    ComputeRenderer Renderer;
+    if (!create_compute_renderer(Renderer, Type, Params, TileSize, TileSize))
+        return false;
+
+    MemoryReservation TileBytes;
+    unsigned char* TileImage = NULL;
+    if (TileBytes.reserve(MEM_STAGING, (size_t)TileSize * TileSize * 3, "the tile buffer"))
+        TileImage = (unsigned char*)malloc((size_t)TileSize * TileSize * 3);
+    if (TileImage == NULL)
+    {
+        std::cerr << "Cannot allocate the tile buffer." << std::endl;
+        destroy_compute_renderer(Renderer);
+        return false;
+    }
+
+    long long NTilesX = (Options.Width + TileSize - 1) / TileSize;
+    long long NTilesY = (Options.Height + TileSize - 1) / TileSize;
+    std::string Header = journal_header(Type, Params, Options, TileSize);
+    TileJournal Journal;
+    bool Resumed;
+    if (!journal_open(Journal, Options.OutputFile + ".journal", Header, NTilesX * NTilesY, Resumed))
+    {
+        journal_close(Journal, false);
+        free(TileImage);
+        destroy_compute_renderer(Renderer);
+        return false;
+    }
+
+    // Resuming needs the image written so far, otherwise the export starts over
+    RasterFile Raster;
+    bool Opened = false;
+    if (Resumed)
+    {
+        Opened = raster_open(Raster, Options.OutputFile, Options.Width, Options.Height);
+        if (!Opened)
+            Resumed = false;
+    }
+    if (!Opened && (!journal_reset(Journal, Header) ||
+                    !raster_create(Raster, Options.OutputFile, Options.Width, Options.Height)))
+    {
+        journal_close(Journal, false);
+        free(TileImage);
+        destroy_compute_renderer(Renderer);
+        return false;
+    }
+
+    std::cout << "Exporting " << Options.Width << "x" << Options.Height << " image in " <<
+                 NTilesX * NTilesY << " tiles of " << TileSize << "x" << TileSize << "." << std::endl;
+    if (Resumed)
+    {
+        std::cout << "Resuming from " << Journal.DoneCount << " completed tiles." << std::endl;
+        metrics().add(METRIC_TILES_RESUMED, (double)Journal.DoneCount);
+    }
+
+    bool Success = true;
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point LastCheckpoint = Start;
+    for (long long ty = 0; ty < NTilesY && Success; ++ty)
+    {
+        long long Y0 = ty * TileSize;
+        int Rows = (int)std::min((long long)TileSize, Options.Height - Y0);
+        for (long long tx = 0; tx < NTilesX && Success; ++tx)
+        {
+            long long Tile = ty * NTilesX + tx;
+            if (Journal.Done[Tile])
+                continue;
+            long long X0 = tx * TileSize;
+            int Cols = (int)std::min((long long)TileSize, Options.Width - X0);
+            TRACE_SCOPE("tile", Tile);
+
+            compute_render(Renderer, tile_params(Params, Options.Width, Options.Height, X0, Y0, TileSize));
+            compute_readback_rgb(Renderer, TileImage);
+
+            // The texture is bottom-up, so the top row of the tile is the last one
+            const unsigned char* TopRow = TileImage + (size_t)(TileSize - 1) * TileSize * 3;
+            Success = raster_write_block(Raster, X0, Y0, Cols, Rows, TopRow, -3LL * TileSize);
+            if (!Success)
+                break;
+            journal_mark(Journal, Tile);
+            metrics().add(METRIC_TILES);
+
+            // The tiles are recorded only after their pixels are safely on disk
+            std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+            if (std::chrono::duration<double>(Now - LastCheckpoint).count() >= Options.CheckpointInterval)
+            {
+                TRACE_SCOPE("checkpoint");
+                Success = raster_sync(Raster) && journal_commit(Journal);
+                LastCheckpoint = Now;
+            }
+        }
+        std::cout << "Row " << ty + 1 << "/" << NTilesY << " done." << std::endl;
+    }
+    if (Success)
+        Success = raster_sync(Raster) && journal_commit(Journal);
+    double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    if (Success)
+        std::cout << "Exported " << Options.OutputFile << " in " << Elapsed << " seconds." << std::endl;
+    else
+        std::cerr << "Cannot write " << Options.OutputFile << "." << std::endl;
+
+    raster_close(Raster);
+    journal_close(Journal, Success);
+    free(TileImage);
+    destroy_compute_renderer(Renderer);
+    return Success;
+}
+
+
+bool tiled_field_export(FractalType Type, const ParamsStruct& Params, const TiledExportOptions& Options)
+{
+    if (Options.Width < 1 || Options.Height < 1)
+    {
+        std::cerr << "Invalid export size." << std::endl;
+        return false;
+    }
+
+    // Every rendered tile is split into whole tiles of the archive
+    GLint MaxTexSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &MaxTexSize);
+    int TileSize = std::min(Options.TileSize, (int)MaxTexSize) / FieldTileSize * FieldTileSize;
+    TileSize = std::max(TileSize, FieldTileSize);
+    // The R32UI texture and the readback buffer
+    TileSize = fit_tile_size(TileSize, 4 + 4, FieldTileSize) / FieldTileSize * FieldTileSize;
+    if (TileSize == 0)
+    {
+        std::cerr << "Not even the smallest tile fits in the memory budget." << std::endl;
+        return false;
+    }
+    int SubTiles = TileSize / FieldTileSize;
+
+    ComputeRenderer Renderer;
+    if (!create_field_renderer(Renderer, Type, Params, TileSize, TileSize))
+        return false;
+    MemoryReservation FieldBytes;
+    if (!FieldBytes.reserve(MEM_STAGING, (size_t)TileSize * TileSize * sizeof(uint32_t), "the tile buffer"))
+    {
+        destroy_compute_renderer(Renderer);
+        return false;
+    }
+    std::vector<uint32_t> Field((size_t)TileSize * TileSize);
+
+    FieldArchiveHeader Header;
+    Header.TileSize = FieldTileSize;
+    Header.Width = Options.Width;
+    Header.Height = Options.Height;
+    Header.Type = Type;
+    Header.Params = Params;
+    FieldArchiveWriter Writer;
+    if (!field_archive_create(Writer, Options.OutputFile, Header))
+    {
+        destroy_compute_renderer(Renderer);
+        return false;
+    }
+
+    long long NTilesX = (Options.Width + TileSize - 1) / TileSize;
+    long long NTilesY = (Options.Height + TileSize - 1) / TileSize;
+    std::cout << "Exporting the " << Options.Width << "x" << Options.Height << " iteration field in " <<
+                 NTilesX * NTilesY << " tiles of " << TileSize << "x" << TileSize << "." << std::endl;
+
+    bool Success = true;
+    std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    for (long long ty = 0; ty < NTilesY && Success; ++ty)
+    {
+        for (long long tx = 0; tx < NTilesX && Success; ++tx)
+        {
+            TRACE_SCOPE("tile", ty * NTilesX + tx);
+            compute_render(Renderer, tile_params(Params, Options.Width, Options.Height, tx * TileSize, ty * TileSize, TileSize));
+            metrics().add(METRIC_TILES);
+            compute_readback_field(Renderer, Field.data());
+
+            // The texture is bottom-up, so the archive tiles are walked with a negative stride
+            for (int i = 0; i < SubTiles && Success; ++i)
+            {
+                uint64_t ATY = ty * SubTiles + i;
+                if (ATY * FieldTileSize >= (uint64_t)Options.Height)
+                    break;
+                for (int j = 0; j < SubTiles && Success; ++j)
+                {
+                    uint64_t ATX = tx * SubTiles + j;
+                    if (ATX * FieldTileSize >= (uint64_t)Options.Width)
+                        break;
+                    const uint32_t* TopRow = Field.data() + (size_t)(TileSize - 1 - i * FieldTileSize) * TileSize +
+                                             j * FieldTileSize;
+                    CPUStageScope Scope(STAGE_ENCODE);
+                    TRACE_SCOPE("encode_field", (long long)(ATY * Writer.NTilesX + ATX));
+                    Success = field_archive_write_tile(Writer, ATX, ATY, TopRow, -(long long)TileSize);
+                }
+            }
+        }
+        std::cout << "Row " << ty + 1 << "/" << NTilesY << " done." << std::endl;
+    }
+
+    uint64_t RawBytes = Writer.RawBytes;
+    Success = field_archive_close(Writer) && Success;
+    double Elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    if (Success)
+    {
+        double Ratio = (double)RawBytes / (double)Writer.Offset;
+        std::cout << "Exported " << Options.OutputFile << " in " << Elapsed << " seconds, " <<
+                     Writer.Offset / 1024 << " KB (" << Ratio << "x smaller than the raw field)." << std::endl;
+    }
+    destroy_compute_renderer(Renderer);
+    return Success;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file        tracer.cpp
+ *
+ * @brief       Implementation of the tracer.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <tracer.hpp>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
+
+
+std::atomic<bool> TraceEnabled(false);
+
+
+namespace
+{
+
+struct TraceRecord
+{
+    const char* Name;
+    long long Arg;
+    long long Start;
+    long long End;
+};
+
+
+struct TraceBuffer
+{
+    int Tid = 0;
+    std::string ThreadName;
+    std::vector<TraceRecord> Records;
+};
+
+
+std::chrono::steady_clock::time_point TraceOrigin = std::chrono::steady_clock::now();
+std::mutex RegistryMutex;
+std::vector<std::unique_ptr<TraceBuffer>> Buffers;
+
+
+/**
+ * @brief       The buffer of the calling thread, created on first use. Buffers outlive their
+ *              threads, so the events of short-lived workers are kept.
+ */
+TraceBuffer& thread_buffer()
+{
+    thread_local TraceBuffer* Buffer = NULL;
+    if (Buffer == NULL)
+    {
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+        Buffers.emplace_back(new TraceBuffer());
+        Buffer = Buffers.back().get();
+        Buffer->Tid = (int)Buffers.size();
+    }
+    return *Buffer;
+}
+
+}
+
+
+void trace_start()
+{
+    TraceOrigin = std::chrono::steady_clock::now();
+    thread_buffer().ThreadName = "main";
+    TraceEnabled.store(true, std::memory_order_relaxed);
+}
+
+
+long long trace_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - TraceOrigin).count();
+}
+
+
+void trace_thread_name(const char* Name)
+{
+    if (trace_enabled())
+        thread_buffer().ThreadName = Name;
+}
+
+
+void trace_event(const char* Name, long long Arg, long long Start, long long End)
+{
+    thread_buffer().Records.push_back({ Name, Arg, Start, End });
+}
+
+
+bool trace_write(const std::string& Path)
+{
+    TraceEnabled.store(false, std::memory_order_relaxed);
+    std::ofstream Stream(Path);
+    if (!Stream.is_open())
+    {
+        std::cerr << "Cannot open " << Path << " for writing." << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> Lock(RegistryMutex);
+    Stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+    Stream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"GPUFractals\"}}";
+    Stream << std::fixed << std::setprecision(3);
+    for (const std::unique_ptr<TraceBuffer>& Buffer : Buffers)
+    {
+        std::string Name = Buffer->ThreadName.empty() ? "thread " + std::to_string(Buffer->Tid) : Buffer->ThreadName;
+        Stream << "," << std::endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << Buffer->Tid
+               << ",\"args\":{\"name\":\"" << Name << "\"}}";
+        // Timestamps are in microseconds
+        for (const TraceRecord& R : Buffer->Records)
+        {
+            Stream << "," << std::endl << "{\"name\":\"" << R.Name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << Buffer->Tid
+                   << ",\"ts\":" << R.Start * 1e-3 << ",\"dur\":" << (R.End - R.Start) * 1e-3;
+            if (R.Arg >= 0)
+                Stream << ",\"args\":{\"index\":" << R.Arg << "}";
+            Stream << "}";
+        }
+        Buffer->Records.clear();
+    }
+    Stream << std::endl << "]}" << std::endl;
+
+    if (!Stream.good())
+    {
+        std::cerr << "Cannot write " << Path << "." << std::endl;
+        return false;
+    }
+    return true;
+}
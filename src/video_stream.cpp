@@ -0,0 +1,265 @@
+/**
+ * @file        video_stream.cpp
+ *
+ * @brief       Implementation of the raw video streams.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <video_stream.hpp>
+#include <tracer.hpp>
+#include <metrics.hpp>
+#include <iostream>
+#include <string.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace
+{
+
+// BT.601 limited range coefficients, in 8-bit fixed point
+inline unsigned char luma(int R, int G, int B)
+{
+    return (unsigned char)(((66 * R + 129 * G + 25 * B + 128) >> 8) + 16);
+}
+
+inline unsigned char chroma_u(int R, int G, int B)
+{
+    return (unsigned char)(((-38 * R - 74 * G + 112 * B + 128) >> 8) + 128);
+}
+
+inline unsigned char chroma_v(int R, int G, int B)
+{
+    return (unsigned char)(((112 * R - 94 * G - 18 * B + 128) >> 8) + 128);
+}
+
+
+/**
+ * @brief       Converts the pixels of two rows from column From onwards. From must be even. If the
+ *              image has an odd number of rows, the last one is passed as both rows, with Y1 NULL.
+ */
+void convert_row_pair_scalar(const unsigned char* Row0, const unsigned char* Row1, int From, int Width,
+                             unsigned char* Y0, unsigned char* Y1, unsigned char* U, unsigned char* V)
+{
+    for (int j = From; j < Width; j += 2)
+    {
+        // The last column is repeated if the width is odd
+        int j1 = j + 1 < Width ? j + 1 : j;
+        const unsigned char* P[4] = { Row0 + 4 * j, Row0 + 4 * j1, Row1 + 4 * j, Row1 + 4 * j1 };
+
+        Y0[j] = luma(P[0][0], P[0][1], P[0][2]);
+        Y0[j1] = luma(P[1][0], P[1][1], P[1][2]);
+        if (Y1 != NULL)
+        {
+            Y1[j] = luma(P[2][0], P[2][1], P[2][2]);
+            Y1[j1] = luma(P[3][0], P[3][1], P[3][2]);
+        }
+
+        int R = (P[0][0] + P[1][0] + P[2][0] + P[3][0] + 2) >> 2;
+        int G = (P[0][1] + P[1][1] + P[2][1] + P[3][1] + 2) >> 2;
+        int B = (P[0][2] + P[1][2] + P[2][2] + P[3][2] + 2) >> 2;
+        U[j / 2] = chroma_u(R, G, B);
+        V[j / 2] = chroma_v(R, G, B);
+    }
+}
+
+
+#ifdef HAS_SSE2
+
+// Splits 8 RGBA pixels into three vectors of 16-bit channels
+inline void load_channels(const unsigned char* Pixels, __m128i& R, __m128i& G, __m128i& B)
+{
+    const __m128i Mask = _mm_set1_epi32(0xFF);
+    __m128i Lo = _mm_loadu_si128((const __m128i*)Pixels);
+    __m128i Hi = _mm_loadu_si128((const __m128i*)(Pixels + 16));
+    R = _mm_packs_epi32(_mm_and_si128(Lo, Mask), _mm_and_si128(Hi, Mask));
+    G = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(Lo, 8), Mask), _mm_and_si128(_mm_srli_epi32(Hi, 8), Mask));
+    B = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(Lo, 16), Mask), _mm_and_si128(_mm_srli_epi32(Hi, 16), Mask));
+}
+
+// The weighted sum is at most 56228, so it is computed modulo 2^16 and shifted as unsigned
+inline __m128i luma_8(__m128i R, __m128i G, __m128i B)
+{
+    __m128i Y = _mm_add_epi16(_mm_mullo_epi16(R, _mm_set1_epi16(66)), _mm_mullo_epi16(G, _mm_set1_epi16(129)));
+    Y = _mm_add_epi16(Y, _mm_mullo_epi16(B, _mm_set1_epi16(25)));
+    Y = _mm_srli_epi16(_mm_add_epi16(Y, _mm_set1_epi16(128)), 8);
+    return _mm_add_epi16(Y, _mm_set1_epi16(16));
+}
+
+// The weighted sums of chroma are within +-28688, so they fit signed 16-bit lanes
+inline __m128i chroma_8(__m128i R, __m128i G, __m128i B, short CR, short CG, short CB)
+{
+    __m128i C = _mm_add_epi16(_mm_mullo_epi16(R, _mm_set1_epi16(CR)), _mm_mullo_epi16(G, _mm_set1_epi16(CG)));
+    C = _mm_add_epi16(C, _mm_mullo_epi16(B, _mm_set1_epi16(CB)));
+    C = _mm_srai_epi16(_mm_add_epi16(C, _mm_set1_epi16(128)), 8);
+    return _mm_add_epi16(C, _mm_set1_epi16(128));
+}
+
+// Averages the 2x2 blocks of 16 columns of two rows, given as two halves of 8 lanes per row
+inline __m128i average_2x2(__m128i Top0, __m128i Top1, __m128i Bottom0, __m128i Bottom1)
+{
+    const __m128i Ones = _mm_set1_epi16(1);
+    __m128i Sum0 = _mm_madd_epi16(_mm_add_epi16(Top0, Bottom0), Ones);
+    __m128i Sum1 = _mm_madd_epi16(_mm_add_epi16(Top1, Bottom1), Ones);
+    __m128i Sum = _mm_packs_epi32(Sum0, Sum1);
+    return _mm_srli_epi16(_mm_add_epi16(Sum, _mm_set1_epi16(2)), 2);
+}
+
+/**
+ * @brief       Converts blocks of 16 columns of two rows. Returns the first column left to convert.
+ */
+int convert_row_pair_sse2(const unsigned char* Row0, const unsigned char* Row1, int Width,
+                          unsigned char* Y0, unsigned char* Y1, unsigned char* U, unsigned char* V)
+{
+    int j = 0;
+    for (; j + 16 <= Width; j += 16)
+    {
+        __m128i R[2][2], G[2][2], B[2][2];
+        load_channels(Row0 + 4 * j, R[0][0], G[0][0], B[0][0]);
+        load_channels(Row0 + 4 * j + 32, R[0][1], G[0][1], B[0][1]);
+        load_channels(Row1 + 4 * j, R[1][0], G[1][0], B[1][0]);
+        load_channels(Row1 + 4 * j + 32, R[1][1], G[1][1], B[1][1]);
+
+        _mm_storeu_si128((__m128i*)(Y0 + j), _mm_packus_epi16(luma_8(R[0][0], G[0][0], B[0][0]),
+                                                              luma_8(R[0][1], G[0][1], B[0][1])));
+        if (Y1 != NULL)
+            _mm_storeu_si128((__m128i*)(Y1 + j), _mm_packus_epi16(luma_8(R[1][0], G[1][0], B[1][0]),
+                                                                  luma_8(R[1][1], G[1][1], B[1][1])));
+
+        __m128i AvgR = average_2x2(R[0][0], R[0][1], R[1][0], R[1][1]);
+        __m128i AvgG = average_2x2(G[0][0], G[0][1], G[1][0], G[1][1]);
+        __m128i AvgB = average_2x2(B[0][0], B[0][1], B[1][0], B[1][1]);
+        __m128i Zero = _mm_setzero_si128();
+        _mm_storel_epi64((__m128i*)(U + j / 2), _mm_packus_epi16(chroma_8(AvgR, AvgG, AvgB, -38, -74, 112), Zero));
+        _mm_storel_epi64((__m128i*)(V + j / 2), _mm_packus_epi16(chroma_8(AvgR, AvgG, AvgB, 112, -94, -18), Zero));
+    }
+    return j;
+}
+
+#endif
+
+}
+
+
+void rgba_to_yuv420(const unsigned char* RGBA, int Width, int Height,
+                    unsigned char* Y, unsigned char* U, unsigned char* V)
+{
+    int ChromaWidth = (Width + 1) / 2;
+    for (int i = 0; i < Height; i += 2)
+    {
+        // Image rows are bottom-up, planes are top-down
+        const unsigned char* Row0 = RGBA + (size_t)(Height - 1 - i) * Width * 4;
+        const unsigned char* Row1 = i + 1 < Height ? Row0 - (size_t)Width * 4 : Row0;
+        unsigned char* Y0 = Y + (size_t)i * Width;
+        unsigned char* Y1 = i + 1 < Height ? Y0 + Width : NULL;
+        unsigned char* URow = U + (size_t)(i / 2) * ChromaWidth;
+        unsigned char* VRow = V + (size_t)(i / 2) * ChromaWidth;
+
+        int From = 0;
+#ifdef HAS_SSE2
+        From = convert_row_pair_sse2(Row0, Row1, Width, Y0, Y1, URow, VRow);
+#endif
+        convert_row_pair_scalar(Row0, Row1, From, Width, Y0, Y1, URow, VRow);
+    }
+}
+
+
+
+VideoStreamSink::VideoStreamSink(const std::string& Path, VideoStreamFormat Format, int FPS)
+    : m_Path(Path), m_Format(Format), m_FPS(FPS), m_Width(0), m_Height(0), m_Stream(NULL)
+{ }
+
+bool VideoStreamSink::open(int Width, int Height)
+{
+    m_Width = Width;
+    m_Height = Height;
+
+    if (m_Path == "-")
+    {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        m_Stream = stdout;
+    }
+    else
+        m_Stream = fopen(m_Path.c_str(), "wb");
+    if (m_Stream == NULL)
+    {
+        std::cerr << "Cannot open " << m_Path << " for writing." << std::endl;
+        return false;
+    }
+
+    // Every Y4M frame starts with its own header, stored in front of the planes
+    size_t PixelCount = (size_t)Width * Height;
+    if (m_Format == VideoStreamFormat::Y4M)
+    {
+        size_t ChromaCount = (size_t)((Width + 1) / 2) * ((Height + 1) / 2);
+        m_Frame.resize(6 + PixelCount + 2 * ChromaCount);
+        memcpy(m_Frame.data(), "FRAME\n", 6);
+        // The chroma is averaged over 2x2 blocks, so it is sited as in JPEG
+        if (fprintf(m_Stream, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", Width, Height, m_FPS) < 0)
+        {
+            std::cerr << "Cannot write to " << m_Path << "." << std::endl;
+            return false;
+        }
+    }
+    else
+        m_Frame.resize(PixelCount * 4);
+    return true;
+}
+
+bool VideoStreamSink::write_frame(const unsigned char* RGBA, long long Index)
+{
+    if (m_Format == VideoStreamFormat::Y4M)
+    {
+        size_t ChromaCount = (size_t)((m_Width + 1) / 2) * ((m_Height + 1) / 2);
+        unsigned char* Y = m_Frame.data() + 6;
+        unsigned char* U = Y + (size_t)m_Width * m_Height;
+        unsigned char* V = U + ChromaCount;
+        TRACE_SCOPE("rgba_to_yuv420", Index);
+        rgba_to_yuv420(RGBA, m_Width, m_Height, Y, U, V);
+    }
+    else
+    {
+        // Flip the rows
+        TRACE_SCOPE("flip_rows", Index);
+        size_t RowSize = (size_t)m_Width * 4;
+        for (int i = 0; i < m_Height; ++i)
+            memcpy(m_Frame.data() + i * RowSize, RGBA + (m_Height - 1 - i) * RowSize, RowSize);
+    }
+
+    TRACE_SCOPE("write_stream", Index);
+    if (fwrite(m_Frame.data(), 1, m_Frame.size(), m_Stream) != m_Frame.size())
+    {
+        std::cerr << "Cannot write frame " << Index << " to " << m_Path << "." << std::endl;
+        return false;
+    }
+    metrics().add(METRIC_EXPORT_BYTES, (double)m_Frame.size());
+    return true;
+}
+
+bool VideoStreamSink::close()
+{
+    bool Success = true;
+    if (m_Stream != NULL)
+    {
+        Success = m_Stream == stdout ? fflush(m_Stream) == 0 : fclose(m_Stream) == 0;
+        m_Stream = NULL;
+    }
+    m_Frame.clear();
+    m_Frame.shrink_to_fit();
+    if (!Success)
+        std::cerr << "Cannot finish writing " << m_Path << "." << std::endl;
+    return Success;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file        view_model.cpp
+ *
+ * @brief       Implementation of the view model.
+ *
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * @date        2026-10-16
+ */
+#include <view_model.hpp>
+#include <algorithm>
+#include <stdlib.h>
+
+
+const char* const ViewPrecisionNames[] = { "fp32", "fp64", "dd", "auto" };
+
+// A pixel must span at least this many units in the last place of the coordinates, so that the
+// rounding of the starting points stays well below a pixel once amplified by the iterations
+const double PrecisionMargin = 256.0;
+
+// Units in the last place relative to the value, for float, double and double-double
+const double PrecisionEpsilon[] = { 0x1p-24, 0x1p-53, 0x1p-104 };
+
+
+const char* view_precision_name(ViewPrecision Precision)
+{
+    return ViewPrecisionNames[Precision];
+}
+
+
+ViewModel view_from_params(const ParamsStruct& Params)
+{
+    ViewModel View;
+    // The sum of two doubles is exact in double-double, the halving too
+    DoubleDouble SumX = two_sum(Params.xlim[0], Params.xlim[1]);
+    DoubleDouble SumY = two_sum(Params.ylim[0], Params.ylim[1]);
+    View.CenterX = DoubleDouble(0.5 * SumX.Hi, 0.5 * SumX.Lo);
+    View.CenterY = DoubleDouble(0.5 * SumY.Hi, 0.5 * SumY.Lo);
+    View.HalfWidth = 0.5 * (Params.xlim[1] - Params.xlim[0]);
+    View.HalfHeight = 0.5 * (Params.ylim[1] - Params.ylim[0]);
+    return View;
+}
+
+
+bool parse_view_coordinate(const char* Str, DoubleDouble& Value)
+{
+    const char* c = Str;
+    bool Negative = *c == '-';
+    if (*c == '-' || *c == '+')
+        ++c;
+
+    // The digits are accumulated as an integer, exactly as long as it fits a double-double
+    DoubleDouble Digits;
+    int Exponent = 0;
+    int NDigits = 0;
+    bool Point = false;
+    for (; (*c >= '0' && *c <= '9') || (*c == '.' && !Point); ++c)
+    {
+        if (*c == '.')
+        {
+            Point = true;
+            continue;
+        }
+        Digits = Digits * DoubleDouble(10.0) + DoubleDouble((double)(*c - '0'));
+        Exponent -= Point ? 1 : 0;
+        ++NDigits;
+    }
+    if (NDigits == 0)
+        return false;
+    if (*c == 'e' || *c == 'E')
+    {
+        char* End;
+        long E = strtol(c + 1, &End, 10);
+        if (End == c + 1 || E < -1000 || E > 1000)
+            return false;
+        Exponent += (int)E;
+        c = End;
+    }
+    if (*c != '\0')
+        return false;
+
+    DoubleDouble Scale(1.0);
+    for (int e = 0; e < abs(Exponent); ++e)
+        Scale = Scale * DoubleDouble(10.0);
+    Value = Exponent >= 0 ? Digits * Scale : Digits / Scale;
+    if (Negative)
+        Value = -Value;
+    return true;
+}
+
+
+void view_to_params(const ViewModel& View, ParamsStruct& Params)
+{
+    Params.xlim[0] = (double)(View.CenterX - DoubleDouble(View.HalfWidth));
+    Params.xlim[1] = (double)(View.CenterX + DoubleDouble(View.HalfWidth));
+    Params.ylim[0] = (double)(View.CenterY - DoubleDouble(View.HalfHeight));
+    Params.ylim[1] = (double)(View.CenterY + DoubleDouble(View.HalfHeight));
+}
+
+
+void view_fit_aspect(ViewModel& View, long long Width, long long Height)
+{
+    double Aspect = (double)Width / (double)Height;
+    if (View.HalfWidth < View.HalfHeight * Aspect)
+        View.HalfWidth = View.HalfHeight * Aspect;
+    else
+        View.HalfHeight = View.HalfWidth / Aspect;
+}
+
+
+bool view_resolves(const ViewModel& View, int Width, int Height, double Epsilon)
+{
+    double Spacing = std::min(fabs(View.HalfWidth) * 2.0 / std::max(Width, 1),
+                              fabs(View.HalfHeight) * 2.0 / std::max(Height, 1));
+    double Extent = std::max(fabs(View.CenterX.Hi) + fabs(View.HalfWidth), fabs(View.CenterY.Hi) + fabs(View.HalfHeight));
+    return Spacing >= Extent * Epsilon * PrecisionMargin;
+}
+
+
+ViewPrecision select_view_precision(FractalType Type, const ViewModel& View, int Width, int Height)
+{
+    ViewPrecision Last = Type == FractalType::NEWTON ? VIEW_FP64 : VIEW_DOUBLE_DOUBLE;
+    for (int p = VIEW_FP32; p < Last; ++p)
+    {
+        if (view_resolves(View, Width, Height, PrecisionEpsilon[p]))
+            return (ViewPrecision)p;
+    }
+    return Last;
+}